@@ -4,7 +4,6 @@ import android.app.Activity;
 import android.content.Context;
 import android.content.res.AssetManager;
 import android.os.Bundle;
-import android.os.Handler;
 import android.support.v4.view.accessibility.AccessibilityNodeInfoCompat;
 import android.support.v4.widget.ExploreByTouchHelper;
 import android.view.MotionEvent;
@@ -41,22 +40,6 @@ public class Controller extends ExploreByTouchHelper {
     nativeDestroy();
   }
 
-  public void postUiTask(long task, long delay) {
-    class NativeUiTask implements Runnable {
-      private NativeUiTask(long task) {
-        mTask = task;
-      }
-
-      public void run() {
-        nativeRunUiTask(mTask);
-      }
-
-      private long mTask;
-    }
-    Handler main_handler = new Handler(mActivity.getMainLooper());
-    main_handler.postDelayed(new NativeUiTask(task), delay);
-  }
-
   // Delegated from View
   boolean onKeyDown(int keyCode) {
     return nativeOnKeyDown(keyCode);
@@ -138,6 +121,12 @@ public class Controller extends ExploreByTouchHelper {
     return nativeOnPerformAction(virtualViewId, action, arguments);
   }
 
+  void invalidateVirtualViews(int[] virtualViewIds) {
+    for (int id : virtualViewIds) {
+      invalidateVirtualView(id);
+    }
+  }
+
   void sendAccessibilityEvent(int type, CharSequence text) {
     if (mAccessibilityManager.isEnabled()) {
       AccessibilityEvent event = AccessibilityEvent.obtain();
@@ -165,8 +154,6 @@ public class Controller extends ExploreByTouchHelper {
 
   private static native void nativeDestroy();
 
-  private static native void nativeRunUiTask(long task);
-
   // View
   private static native boolean nativeOnKeyDown(int keyCode);
 
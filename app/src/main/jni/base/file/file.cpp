@@ -16,6 +16,10 @@ int File::GetFileDescriptor(off_t* start) {
   return -1;
 }
 
+const void* File::GetContents() {
+  return nullptr;
+}
+
 size_t File::Write(const void* buffer, size_t bytes) {
   return -1;
 }
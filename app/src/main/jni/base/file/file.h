@@ -27,6 +27,11 @@ class File {
   // TODO: Perhaps this should be android only.
   virtual int GetFileDescriptor(off_t* start);
 
+  // Return the whole file in memory, without copying it where the platform
+  // can map it instead, or null if it can't be.  Stays valid until the file
+  // is closed.
+  virtual const void* GetContents();
+
   // Read |bytes| bytes into |buffer|.  Returns number of bytes actually read.
   virtual size_t Read(void* buffer, size_t bytes) = 0;
 
@@ -39,6 +39,13 @@ class FileAndroidAsset : public File {
     return AAsset_openFileDescriptor(asset_, start, &length);
   }
 
+  // Uncompressed assets are mapped straight from the package.
+  const void* GetContents() override {
+    if (!asset_)
+      return nullptr;
+    return AAsset_getBuffer(asset_);
+  }
+
   size_t Read(void* buffer, size_t bytes) override {
     return AAsset_read(asset_, buffer, bytes);
   }
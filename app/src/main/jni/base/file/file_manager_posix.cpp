@@ -0,0 +1,54 @@
+////
+// file_manager_posix.cpp
+////
+
+#include "base/file/file_manager_posix.h"
+
+#include "base/file/file_posix.h"
+
+#include <memory>
+
+namespace {
+std::unique_ptr<File> OpenFile(const std::string& path,
+                               FilePosix::FileMode mode) {
+  std::unique_ptr<FilePosix> file(new FilePosix());
+  if (file->Open(path, mode)) {
+    return file;
+  } else {
+    return nullptr;
+  }
+}
+}
+
+FileManagerPosix::FileManagerPosix(const std::string& data_root,
+                                   const std::string& asset_root)
+    : data_root_(data_root), asset_root_(asset_root) {}
+
+FileManagerPosix::~FileManagerPosix() {}
+
+// private:
+// FileManager:
+void FileManagerPosix::Delete(const std::string& path, bool recursive) {
+  FilePosix::Delete(data_root_ + path, recursive);
+}
+
+bool FileManagerPosix::Rename(const std::string& old_filename,
+                              const std::string& new_filename) {
+  return FilePosix::Rename(data_root_ + old_filename,
+                           data_root_ + new_filename);
+}
+
+std::unique_ptr<File> FileManagerPosix::ReadFile(const std::string& filename) {
+  return OpenFile(data_root_ + filename, FilePosix::kModeRead);
+}
+
+std::unique_ptr<File> FileManagerPosix::WriteFile(const std::string& filename,
+                                                  bool append) {
+  return OpenFile(data_root_ + filename,
+                  append ? FilePosix::kModeAppend : FilePosix::kModeWrite);
+}
+
+std::unique_ptr<File> FileManagerPosix::OpenBundledAsset(
+    const char* filename) {
+  return OpenFile(asset_root_ + filename, FilePosix::kModeRead);
+}
@@ -0,0 +1,32 @@
+////
+// file_manager_posix.h
+////
+
+#pragma once
+
+#include "base/file/file_manager.h"
+
+#include <string>
+
+// Opens plain files, for the command line tools.  Data files live under
+// |data_root| and assets under |asset_root|, each ending in a slash.
+class FileManagerPosix : public FileManager {
+ public:
+  FileManagerPosix(const std::string& data_root,
+                   const std::string& asset_root);
+  ~FileManagerPosix() override;
+  DISALLOW_COPY_AND_ASSIGN(FileManagerPosix);
+
+ private:
+  // FileManager:
+  void Delete(const std::string& path, bool recursive) override;
+  bool Rename(const std::string& old_filename,
+              const std::string& new_filename) override;
+  std::unique_ptr<File> ReadFile(const std::string& filename) override;
+  std::unique_ptr<File> WriteFile(const std::string& filename,
+                                  bool append) override;
+  std::unique_ptr<File> OpenBundledAsset(const char* filename) override;
+
+  std::string data_root_;
+  std::string asset_root_;
+};
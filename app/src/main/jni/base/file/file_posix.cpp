@@ -10,6 +10,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -73,7 +75,8 @@ bool FilePosix::Rename(const std::string& old_filename,
   return result == 0;
 }
 
-FilePosix::FilePosix() : mode_(kModeNone), fd_(-1) {}
+FilePosix::FilePosix()
+    : mode_(kModeNone), fd_(-1), mapping_(nullptr), mapping_size_(0) {}
 
 FilePosix::~FilePosix() {
   Close();
@@ -140,6 +143,25 @@ int FilePosix::GetFileDescriptor(off_t* start) {
   return fd_;
 }
 
+const void* FilePosix::GetContents() {
+  if (mapping_)
+    return mapping_;
+  if (mode_ != kModeRead)
+    return nullptr;
+
+  const size_t length = Length();
+  if (!length)
+    return nullptr;
+  void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (mapping == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map file: " << strerror(errno);
+    return nullptr;
+  }
+  mapping_ = mapping;
+  mapping_size_ = length;
+  return mapping_;
+}
+
 size_t FilePosix::Read(void* buffer, size_t bytes) {
   if (mode_ != kModeRead)
     return -1;
@@ -174,6 +196,11 @@ long FilePosix::Tell() {
 }
 
 void FilePosix::Close() {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
   if (fd_ >= 0) {
     close(fd_);
     fd_ = -1;
@@ -21,6 +21,7 @@ class FilePosix : public File {
   size_t Length() override;
   size_t RemainingLength() override;
   int GetFileDescriptor(off_t* start) override;
+  const void* GetContents() override;
   size_t Read(void* buffer, size_t bytes) override;
   size_t Write(const void* buffer, size_t bytes) override;
   bool Seek(long offset, SeekWhence whence) override;
@@ -30,4 +31,7 @@ class FilePosix : public File {
  private:
   FileMode mode_;
   int fd_;
+  // The file mapped by GetContents(), if it's been called.
+  void* mapping_;
+  size_t mapping_size_;
 };
@@ -33,6 +33,10 @@ size_t MemoryFile::RemainingLength() {
   return buffer_.size() - head_;
 }
 
+const void* MemoryFile::GetContents() {
+  return buffer_.data();
+}
+
 size_t MemoryFile::Read(void* buffer, size_t bytes) {
   size_t to_read = std::min(buffer_.size() - head_, bytes);
   memcpy(buffer, &buffer_[head_], to_read);
@@ -21,6 +21,7 @@ class MemoryFile : public File {
 
   size_t Length() override;
   size_t RemainingLength() override;
+  const void* GetContents() override;
   size_t Read(void* buffer, size_t bytes) override;
   size_t Write(const void* buffer, size_t bytes) override;
   bool Seek(long offset, SeekWhence whence) override;
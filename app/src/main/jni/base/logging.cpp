@@ -6,6 +6,7 @@
 
 #include "base/platform.h"
 
+#include <string.h>
 #include <exception>
 #include <memory>
 
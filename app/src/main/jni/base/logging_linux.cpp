@@ -0,0 +1,42 @@
+////
+// logging_linux.cpp
+////
+
+#include "base/platform.h"
+
+#if OS_LINUX
+
+#include <stdarg.h>
+#include <stdio.h>
+
+namespace logging {
+
+void Info(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+void Warn(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  fputs("WARNING: ", stderr);
+  vfprintf(stderr, format, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+void Err(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  fputs("ERROR: ", stderr);
+  vfprintf(stderr, format, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+}  // logging
+
+#endif  // OS_LINUX
@@ -6,6 +6,8 @@
 
 #include "base/logging.h"
 
+#include <atomic>
+
 namespace base {
 
 template <typename T>
@@ -27,6 +29,27 @@ class RefCounted {
   int ref_count_;
 };
 
+// Like RefCounted, but AddRef() and Release() may be called from any thread.
+template <typename T>
+class RefCountedThreadSafe {
+ public:
+  RefCountedThreadSafe() : ref_count_(0) {}
+  ~RefCountedThreadSafe() {}
+
+  void AddRef() { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  void Release() {
+    int previous = ref_count_.fetch_sub(1, std::memory_order_acq_rel);
+    DCHECK_GT(previous, 0);
+    if (previous == 1) {
+      delete static_cast<T*>(this);
+    }
+  }
+
+ private:
+  std::atomic<int> ref_count_;
+};
+
 }  // namespace base
 
 template <typename T>
@@ -38,13 +61,30 @@ class scoped_refptr {
       ptr_->AddRef();
   }
 
+  scoped_refptr(const scoped_refptr<T>& other) : scoped_refptr(other.ptr_) {}
+
   ~scoped_refptr() {
     if (ptr_)
       ptr_->Release();
   }
 
+  scoped_refptr<T>& operator=(const scoped_refptr<T>& other) {
+    reset(other.ptr_);
+    return *this;
+  }
+
   T* get() const { return ptr_; }
 
+  void reset(T* ptr = nullptr) {
+    // AddRef first, in case |ptr| is already held.
+    if (ptr)
+      ptr->AddRef();
+    T* old_ptr = ptr_;
+    ptr_ = ptr;
+    if (old_ptr)
+      old_ptr->Release();
+  }
+
   T& operator*() const {
     DCHECK(ptr_);
     return *ptr_;
@@ -0,0 +1,76 @@
+////
+// condition_variable.cpp
+////
+
+#include "base/thread/condition_variable.h"
+
+#include "base/logging.h"
+#include "base/thread/mutex.h"
+#include "base/time.h"
+
+#if OS_POSIX
+#include <time.h>
+#endif
+
+ConditionVariable::ConditionVariable(Mutex* mutex) : mutex_(mutex) {
+#if OS_POSIX
+  int error = pthread_cond_init(&condition_, nullptr);
+  if (error)
+    LOG(FATAL) << "pthread_cond_init failed: " << error;
+#elif OS_WIN
+  ::InitializeConditionVariable(&condition_);
+#endif
+}
+
+ConditionVariable::~ConditionVariable() {
+#if OS_POSIX
+  int error = pthread_cond_destroy(&condition_);
+  DCHECK(!error);
+#endif
+}
+
+void ConditionVariable::Wait() {
+  mutex_->WillWait();
+#if OS_POSIX
+  int error = pthread_cond_wait(&condition_, &mutex_->mutex_);
+  DCHECK(!error);
+#elif OS_WIN
+  ::SleepConditionVariableCS(&condition_, &mutex_->mutex_, INFINITE);
+#endif
+  mutex_->DidWait();
+}
+
+void ConditionVariable::TimedWait(const TimeInterval& timeout) {
+  mutex_->WillWait();
+#if OS_POSIX
+  // Older Android versions can't wait on the monotonic clock, so use the
+  // wall clock.
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  const int64_t nanoseconds =
+      deadline.tv_nsec + static_cast<int64_t>(timeout.Nanoseconds());
+  deadline.tv_sec += nanoseconds / 1000000000;
+  deadline.tv_nsec = nanoseconds % 1000000000;
+  pthread_cond_timedwait(&condition_, &mutex_->mutex_, &deadline);
+#elif OS_WIN
+  ::SleepConditionVariableCS(&condition_, &mutex_->mutex_,
+                             static_cast<DWORD>(timeout.Milliseconds()));
+#endif
+  mutex_->DidWait();
+}
+
+void ConditionVariable::Signal() {
+#if OS_POSIX
+  pthread_cond_signal(&condition_);
+#elif OS_WIN
+  ::WakeConditionVariable(&condition_);
+#endif
+}
+
+void ConditionVariable::Broadcast() {
+#if OS_POSIX
+  pthread_cond_broadcast(&condition_);
+#elif OS_WIN
+  ::WakeAllConditionVariable(&condition_);
+#endif
+}
@@ -0,0 +1,48 @@
+////
+// condition_variable.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/platform.h"
+
+#if OS_POSIX
+#include <pthread.h>
+#endif
+
+class Mutex;
+class TimeInterval;
+
+// Lets threads sleep until another thread signals them.  Always used with
+// the Mutex that guards the condition being waited on.
+class ConditionVariable {
+ public:
+  explicit ConditionVariable(Mutex* mutex);
+  ~ConditionVariable();
+
+  // Wait to be signaled.  The mutex must be held, and is released while
+  // waiting.  Wake ups may be spurious, so recheck the condition.
+  void Wait();
+
+  // Like Wait(), but give up after |timeout|.
+  void TimedWait(const TimeInterval& timeout);
+
+  // Wake one waiting thread.
+  void Signal();
+
+  // Wake all waiting threads.
+  void Broadcast();
+
+ private:
+#if OS_POSIX
+  typedef pthread_cond_t ConditionHandle;
+#elif OS_WIN
+  typedef CONDITION_VARIABLE ConditionHandle;
+#endif
+
+  Mutex* mutex_;
+  ConditionHandle condition_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConditionVariable);
+};
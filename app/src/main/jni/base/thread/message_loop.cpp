@@ -0,0 +1,219 @@
+////
+// message_loop.cpp
+////
+
+#include "base/thread/message_loop.h"
+
+#include "base/logging.h"
+#include "base/thread/task.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Posts past this many between runs of the loop take a lock.
+const int kIncomingCapacity = 4096;
+
+// The timer can't be armed for zero, which disarms it.
+const long kMinTimerNanoseconds = 1;
+
+const long kNanosecondsPerSecond = 1000000000;
+
+// Drain a nonblocking eventfd or timerfd, so it stops being readable.
+// Return false if there was nothing to read.
+bool ReadCounter(int fd) {
+  uint64_t count;
+  ssize_t result;
+  while ((result = read(fd, &count, sizeof(count))) < 0 && errno == EINTR) {
+  }
+  return result == sizeof(count);
+}
+
+void WriteCounter(int fd) {
+  const uint64_t one = 1;
+  while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+}
+
+void AddToEpoll(int epoll_fd, int fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event))
+    LOG(FATAL) << "Failed to add fd to epoll: " << strerror(errno);
+}
+}
+
+////
+// MessageLoop
+////
+MessageLoop::MessageLoop()
+    : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+      wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      timer_fd_(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+      incoming_tasks_(kIncomingCapacity),
+      overflowing_(false),
+      wake_pending_(false),
+      quit_(false),
+      next_sequence_(0),
+      timer_armed_(false) {
+  CHECK_GE(epoll_fd_, 0);
+  CHECK_GE(wake_fd_, 0);
+  CHECK_GE(timer_fd_, 0);
+  AddToEpoll(epoll_fd_, wake_fd_);
+  AddToEpoll(epoll_fd_, timer_fd_);
+}
+
+MessageLoop::~MessageLoop() {
+  close(timer_fd_);
+  close(wake_fd_);
+  close(epoll_fd_);
+}
+
+void MessageLoop::PostTask(std::unique_ptr<Task> task) {
+  if (overflowing_.load(std::memory_order_acquire) ||
+      !incoming_tasks_.Push(&task)) {
+    AutoLock lock(&lock_);
+    overflow_tasks_.push_back(std::move(task));
+    overflowing_.store(true, std::memory_order_relaxed);
+  }
+  Wake();
+}
+
+void MessageLoop::PostDelayedTask(std::unique_ptr<Task> task,
+                                  const TimeInterval& delay) {
+  if (delay <= TimeInterval()) {
+    PostTask(std::move(task));
+    return;
+  }
+  // The loop's thread moves it into the heap when it takes it from the
+  // queue.
+  task->delayed_run_time_ = Timestamp::Now() + delay;
+  PostTask(std::move(task));
+}
+
+void MessageLoop::Run() {
+  while (!quit_.load(std::memory_order_acquire)) {
+    epoll_event events[2];
+    if (epoll_wait(epoll_fd_, events, arraysize(events), -1) < 0 &&
+        errno != EINTR) {
+      LOG(FATAL) << "epoll_wait failed: " << strerror(errno);
+    }
+    RunPendingTasks();
+  }
+  quit_.store(false, std::memory_order_relaxed);
+}
+
+void MessageLoop::Quit() {
+  quit_.store(true, std::memory_order_release);
+  Wake();
+}
+
+void MessageLoop::RunPendingTasks() {
+  // Clear the wakeup before looking, so a post that comes after the look
+  // wakes the loop again.
+  ReadCounter(wake_fd_);
+  if (ReadCounter(timer_fd_))
+    timer_armed_ = false;
+  wake_pending_.exchange(false, std::memory_order_acq_rel);
+  TakeIncomingTasks();
+
+  // Move the delayed tasks that have come due behind the ready ones.
+  const Timestamp now = Timestamp::Now();
+  while (!delayed_tasks_.empty() && delayed_tasks_.front().run_time <= now) {
+    std::pop_heap(delayed_tasks_.begin(), delayed_tasks_.end(), &RunsLater);
+    ready_tasks_.push_back(std::move(delayed_tasks_.back().task));
+    delayed_tasks_.pop_back();
+  }
+
+  // Run only what's ready now.  What these tasks post wakes the loop again.
+  std::deque<std::unique_ptr<Task>> tasks;
+  tasks.swap(ready_tasks_);
+  for (auto& task : tasks) {
+    task->Execute();
+    task.reset();
+  }
+
+  UpdateTimer();
+}
+
+// private:
+// static
+bool MessageLoop::RunsLater(const DelayedTask& a, const DelayedTask& b) {
+  if (a.run_time != b.run_time)
+    return a.run_time > b.run_time;
+  return a.sequence > b.sequence;
+}
+
+void MessageLoop::Wake() {
+  // Only the first wakeup since the loop last looked needs to write the fd.
+  // The exchange pairs with the loop's, so either the loop sees what was
+  // pushed before it or this sees the flag cleared.
+  if (!wake_pending_.exchange(true, std::memory_order_acq_rel))
+    WriteCounter(wake_fd_);
+}
+
+void MessageLoop::TakeIncomingTasks() {
+  while (std::unique_ptr<Task> task = incoming_tasks_.Pop())
+    AddIncomingTask(std::move(task));
+
+  if (!overflowing_.load(std::memory_order_acquire))
+    return;
+
+  // The overflow was posted after everything in the queue, which a half done
+  // push can hold up.  That push wakes the loop again once it's done.
+  if (!incoming_tasks_.Empty())
+    return;
+  std::deque<std::unique_ptr<Task>> tasks;
+  {
+    AutoLock lock(&lock_);
+    tasks.swap(overflow_tasks_);
+    overflowing_.store(false, std::memory_order_release);
+  }
+  for (auto& task : tasks)
+    AddIncomingTask(std::move(task));
+}
+
+void MessageLoop::AddIncomingTask(std::unique_ptr<Task> task) {
+  if (task->delayed_run_time_ == Timestamp()) {
+    ready_tasks_.push_back(std::move(task));
+    return;
+  }
+  const Timestamp run_time = task->delayed_run_time_;
+  delayed_tasks_.push_back(
+      DelayedTask{run_time, next_sequence_++, std::move(task)});
+  std::push_heap(delayed_tasks_.begin(), delayed_tasks_.end(), &RunsLater);
+}
+
+void MessageLoop::UpdateTimer() {
+  if (delayed_tasks_.empty()) {
+    if (timer_armed_) {
+      const itimerspec disarm = {};
+      timerfd_settime(timer_fd_, 0, &disarm, nullptr);
+      timer_armed_ = false;
+    }
+    return;
+  }
+
+  const Timestamp run_time = delayed_tasks_.front().run_time;
+  if (timer_armed_ && run_time == timer_time_)
+    return;
+
+  // Round up, so the timer doesn't fire before the task is due.
+  const double nanoseconds = (run_time - Timestamp::Now()).Nanoseconds();
+  const int64_t delay = std::max<int64_t>(
+      kMinTimerNanoseconds, static_cast<int64_t>(std::ceil(nanoseconds)));
+  itimerspec spec = {};
+  spec.it_value.tv_sec = delay / kNanosecondsPerSecond;
+  spec.it_value.tv_nsec = delay % kNanosecondsPerSecond;
+  if (timerfd_settime(timer_fd_, 0, &spec, nullptr))
+    LOG(FATAL) << "Failed to arm timer: " << strerror(errno);
+  timer_time_ = run_time;
+  timer_armed_ = true;
+}
@@ -0,0 +1,105 @@
+////
+// message_loop.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/thread/mutex.h"
+#include "base/thread/task_queue.h"
+#include "base/time.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Runs tasks on the thread that owns it, posted from any thread to run now
+// or after a delay.
+//
+// Posting, with or without a delay, pushes the task onto a lock-free
+// TaskQueue without allocating, and writes an eventfd only if the loop
+// hasn't been woken since it last looked.  Only when the queue is full do
+// posts take a lock, until the loop catches up.  The loop's thread sorts
+// delayed tasks into a min-heap keyed on when they're due, with a timerfd
+// armed for the earliest.  Both fds sit in one epoll set, whose fd is
+// readable whenever there's work.  The loop can run on its own with Run(),
+// or be driven by another event loop, such as Android's looper, waiting on
+// fd() and calling RunPendingTasks().
+class MessageLoop {
+ public:
+  // Created on the thread that will run the tasks.
+  MessageLoop();
+  // Tasks that haven't run are deleted without running.
+  ~MessageLoop();
+  DISALLOW_COPY_AND_ASSIGN(MessageLoop);
+
+  // Queue |task| to run on the loop's thread.  Called on any thread.
+  void PostTask(std::unique_ptr<Task> task);
+
+  // Queue |task| to run on the loop's thread once |delay| has passed.
+  // Called on any thread.
+  void PostDelayedTask(std::unique_ptr<Task> task, const TimeInterval& delay);
+
+  // Run tasks as they come due until Quit() is called.
+  void Run();
+
+  // Make Run() return once the tasks that are due have run.  Called on any
+  // thread.
+  void Quit();
+
+  // An fd that's readable whenever RunPendingTasks() has work, for another
+  // event loop to wait on.
+  int fd() const { return epoll_fd_; }
+
+  // Run the tasks that are due without waiting.  Tasks they post run on the
+  // next call, so a task that keeps posting can't starve the caller.
+  void RunPendingTasks();
+
+ private:
+  struct DelayedTask {
+    Timestamp run_time;
+    // Orders tasks due at the same time by when they were posted.
+    uint64_t sequence;
+    std::unique_ptr<Task> task;
+  };
+
+  // Orders the heap with the earliest task on top.
+  static bool RunsLater(const DelayedTask& a, const DelayedTask& b);
+
+  // Make fd() readable, unless it's been made readable since the loop last
+  // looked.
+  void Wake();
+
+  // Sort the posted tasks into |ready_tasks_| and |delayed_tasks_|.
+  void TakeIncomingTasks();
+  void AddIncomingTask(std::unique_ptr<Task> task);
+  // Arm the timer for the earliest delayed task, or disarm it.
+  void UpdateTimer();
+
+  const int epoll_fd_;
+  const int wake_fd_;
+  const int timer_fd_;
+
+  TaskQueue incoming_tasks_;
+
+  // Tasks that found |incoming_tasks_| full, and every task after them
+  // until the loop takes them, so each thread's tasks stay in order.
+  Mutex lock_;
+  std::deque<std::unique_ptr<Task>> overflow_tasks_;
+  // Set while |overflow_tasks_| has tasks.
+  std::atomic<bool> overflowing_;
+
+  // Set when |wake_fd_| has been written since the loop last looked.
+  std::atomic<bool> wake_pending_;
+  std::atomic<bool> quit_;
+
+  // Only used on the loop's thread.
+  std::deque<std::unique_ptr<Task>> ready_tasks_;
+  std::vector<DelayedTask> delayed_tasks_;
+  uint64_t next_sequence_;
+  // When the timer is set to fire, if it's armed and hasn't fired.
+  Timestamp timer_time_;
+  bool timer_armed_;
+};
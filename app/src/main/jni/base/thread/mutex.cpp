@@ -188,6 +188,26 @@ bool Mutex::IsLocked() {
 }
 #endif
 
+// private:
+void Mutex::WillWait() {
+  DCHECK(IsLocked());
+#ifndef NDEBUG
+  locking_thread_ = 0;
+#endif
+#if (DEBUG_MUTEX)
+  PopLock(lock_id_);
+#endif
+}
+
+void Mutex::DidWait() {
+#if (DEBUG_MUTEX)
+  PushLock(lock_id_);
+#endif
+#ifndef NDEBUG
+  locking_thread_ = GetMutexThreadId();
+#endif
+}
+
 ////
 // AutoLock
 ////
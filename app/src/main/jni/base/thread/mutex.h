@@ -27,6 +27,13 @@ class Mutex {
 #endif
 
  private:
+  friend class ConditionVariable;
+
+  // Called around a condition variable wait, which releases and reacquires
+  // the mutex without going through Lock() and Unlock().
+  void WillWait();
+  void DidWait();
+
 #if OS_POSIX
   typedef pthread_mutex_t MutexHandle;
 #elif OS_WIN
@@ -4,7 +4,7 @@
 
 #include "base/thread/task.h"
 
-Task::Task() {}
+Task::Task() : next_in_queue_(nullptr) {}
 
 Task::~Task() {}
 
@@ -5,7 +5,9 @@
 #pragma once
 
 #include "base/macros.h"
+#include "base/time.h"
 
+#include <atomic>
 #include <memory>
 
 // A task to be run by the message queue.
@@ -17,6 +19,14 @@ class Task {
   virtual void Execute() = 0;
 
  private:
+  friend class MessageLoop;
+  friend class TaskQueue;
+
+  // Links the task into a TaskQueue, so queueing it doesn't allocate.
+  std::atomic<Task*> next_in_queue_;
+  // When a MessageLoop is to run the task, if it was posted with a delay.
+  Timestamp delayed_run_time_;
+
   DISALLOW_COPY_AND_ASSIGN(Task);
 };
 
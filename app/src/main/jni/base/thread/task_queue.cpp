@@ -0,0 +1,71 @@
+////
+// task_queue.cpp
+////
+
+#include "base/thread/task_queue.h"
+
+#include "base/logging.h"
+
+////
+// TaskQueue::StubTask
+////
+void TaskQueue::StubTask::Execute() {
+  NOTREACHED();
+}
+
+////
+// TaskQueue
+////
+TaskQueue::TaskQueue(int capacity)
+    : capacity_(capacity), size_(0), head_(&stub_), tail_(&stub_) {
+  DCHECK_GT(capacity_, 0);
+}
+
+TaskQueue::~TaskQueue() {
+  while (Pop()) {
+  }
+}
+
+bool TaskQueue::Push(std::unique_ptr<Task>* task) {
+  if (size_.fetch_add(1, std::memory_order_relaxed) >= capacity_) {
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+  Link(task->release());
+  return true;
+}
+
+std::unique_ptr<Task> TaskQueue::Pop() {
+  Task* tail = tail_;
+  Task* next = tail->next_in_queue_.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (!next)
+      return nullptr;
+    tail_ = next;
+    tail = next;
+    next = next->next_in_queue_.load(std::memory_order_acquire);
+  }
+  if (!next) {
+    // |tail| is the last task linked.  If another is being pushed after it,
+    // wait for its push to finish.
+    if (tail != head_.load(std::memory_order_acquire))
+      return nullptr;
+
+    // Put the stub back behind |tail|, so |tail| can be taken.
+    Link(&stub_);
+    next = tail->next_in_queue_.load(std::memory_order_acquire);
+    if (!next)
+      return nullptr;
+  }
+
+  tail_ = next;
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  return std::unique_ptr<Task>(tail);
+}
+
+// private:
+void TaskQueue::Link(Task* task) {
+  task->next_in_queue_.store(nullptr, std::memory_order_relaxed);
+  Task* prev = head_.exchange(task, std::memory_order_acq_rel);
+  prev->next_in_queue_.store(task, std::memory_order_release);
+}
@@ -0,0 +1,60 @@
+////
+// task_queue.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/thread/task.h"
+
+#include <atomic>
+#include <memory>
+
+// A bounded queue of tasks that any number of threads push onto without
+// locking, and one thread pops from.  Tasks are linked through a field of
+// Task itself, so pushing never allocates: a push reserves a slot in the
+// count, then swaps itself in as the head with one atomic exchange.
+class TaskQueue {
+ public:
+  // Hold up to |capacity| tasks.
+  explicit TaskQueue(int capacity);
+  // Tasks left in the queue are deleted without running.
+  ~TaskQueue();
+  DISALLOW_COPY_AND_ASSIGN(TaskQueue);
+
+  // Push |task|, or return false if the queue is full and leave |task|
+  // alone.  Called on any thread.
+  bool Push(std::unique_ptr<Task>* task);
+
+  // Take the oldest task, or return null if there's none.  Also returns null
+  // while the push of the next task is half done, so a consumer that sleeps
+  // needs the pushing thread to wake it after Push() returns.  Only called
+  // by the consumer.
+  std::unique_ptr<Task> Pop();
+
+  // Whether the queue looked empty.  Only a hint, since other threads may be
+  // pushing.
+  bool Empty() const { return !size_.load(std::memory_order_relaxed); }
+
+ private:
+  // Keeps the queue from ever being empty, so producers only touch |head_|.
+  class StubTask : public Task {
+   public:
+    StubTask() {}
+    ~StubTask() override {}
+    DISALLOW_COPY_AND_ASSIGN(StubTask);
+
+    // Task:
+    void Execute() override;
+  };
+
+  void Link(Task* task);
+
+  const int capacity_;
+  std::atomic<int> size_;
+  // Producers swap in the newest task at |head_|.  The consumer follows the
+  // links from the oldest at |tail_|.
+  std::atomic<Task*> head_;
+  Task* tail_;
+  StubTask stub_;
+};
@@ -0,0 +1,76 @@
+////
+// thread.cpp
+////
+
+#include "base/thread/thread.h"
+
+#include "base/logging.h"
+#include "base/thread/task.h"
+
+Thread::Thread()
+    : thread_id_(thread::Unknown), owns_thread_id_(false), started_(false) {}
+
+Thread::~Thread() {
+  DCHECK(!started_);
+}
+
+void Thread::Start(std::unique_ptr<Task> task) {
+  DCHECK(!started_);
+  thread_id_ = thread::AllocThreadId();
+  owns_thread_id_ = true;
+  StartInternal(std::move(task));
+}
+
+void Thread::StartNamed(thread::ID thread_id, std::unique_ptr<Task> task) {
+  DCHECK(!started_);
+  DCHECK_LT(thread_id, thread::kNumNamedThreads);
+  thread_id_ = thread_id;
+  owns_thread_id_ = false;
+  StartInternal(std::move(task));
+}
+
+void Thread::Join() {
+  DCHECK(started_);
+
+#if OS_POSIX
+  int error = pthread_join(handle_, nullptr);
+  DCHECK(!error);
+#elif OS_WIN
+  ::WaitForSingleObject(handle_, INFINITE);
+  ::CloseHandle(handle_);
+#endif
+
+  if (owns_thread_id_)
+    thread::ReleaseThreadId(thread_id_);
+  thread_id_ = thread::Unknown;
+  task_.reset();
+  started_ = false;
+}
+
+// private:
+void Thread::StartInternal(std::unique_ptr<Task> task) {
+  task_ = std::move(task);
+  started_ = true;
+
+#if OS_POSIX
+  int error = pthread_create(&handle_, nullptr, &Thread::ThreadMain, this);
+  if (error)
+    LOG(FATAL) << "pthread_create failed: " << error;
+#elif OS_WIN
+  handle_ = ::CreateThread(nullptr, 0, &Thread::ThreadMain, this, 0, nullptr);
+  if (!handle_)
+    LOG(FATAL) << "CreateThread failed: " << ::GetLastError();
+#endif
+}
+
+// static
+#if OS_POSIX
+void* Thread::ThreadMain(void* arg) {
+#elif OS_WIN
+DWORD WINAPI Thread::ThreadMain(void* arg) {
+#endif
+  Thread* thread = static_cast<Thread*>(arg);
+  thread::InitThread(static_cast<thread::ID>(thread->thread_id_));
+  thread->task_->Execute();
+  return 0;
+}
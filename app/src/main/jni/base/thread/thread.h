@@ -0,0 +1,57 @@
+////
+// thread.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/platform.h"
+#include "base/thread/thread_util.h"
+
+#include <memory>
+
+#if OS_POSIX
+#include <pthread.h>
+#endif
+
+class Task;
+
+// A platform thread that runs a single task.  The thread is registered with
+// a thread id from thread::AllocThreadId(), so CHECK_THREAD works on it.
+class Thread {
+ public:
+  Thread();
+  ~Thread();
+  DISALLOW_COPY_AND_ASSIGN(Thread);
+
+  // Start a new thread running |task|.
+  void Start(std::unique_ptr<Task> task);
+
+  // Start a new thread running |task| as one of the named threads.
+  void StartNamed(thread::ID thread_id, std::unique_ptr<Task> task);
+
+  // Wait for the task to finish.
+  void Join();
+
+  bool started() const { return started_; }
+
+  // The thread's id.  Only valid once started.
+  int thread_id() const { return thread_id_; }
+
+ private:
+#if OS_POSIX
+  typedef pthread_t ThreadHandle;
+  static void* ThreadMain(void* arg);
+#elif OS_WIN
+  typedef HANDLE ThreadHandle;
+  static DWORD WINAPI ThreadMain(void* arg);
+#endif
+
+  void StartInternal(std::unique_ptr<Task> task);
+
+  ThreadHandle handle_;
+  std::unique_ptr<Task> task_;
+  int thread_id_;
+  bool owns_thread_id_;
+  bool started_;
+};
@@ -2,6 +2,8 @@
 // thread_local.h
 ////
 
+#pragma once
+
 #include "base/macros.h"
 #include "base/platform.h"
 
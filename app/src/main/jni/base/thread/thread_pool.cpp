@@ -0,0 +1,279 @@
+////
+// thread_pool.cpp
+////
+
+#include "base/thread/thread_pool.h"
+
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/thread/work_stealing_deque.h"
+
+#include <algorithm>
+
+namespace {
+// 1024 tasks per worker before it spills into the shared queue.
+const int kDequeCapacityBits = 10;
+}
+
+struct ThreadPool::Worker {
+  Worker() : index(0), steal_seed(0), deque(kDequeCapacityBits) {}
+
+  int index;
+  // Picks the first worker to steal from, so thieves spread out.
+  uint32_t steal_seed;
+  WorkStealingDeque deque;
+  Thread thread;
+};
+
+class ThreadPool::WorkerTask : public Task {
+ public:
+  WorkerTask(ThreadPool* pool, Worker* worker) : pool_(pool), worker_(worker) {}
+  ~WorkerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerTask);
+
+  // Task:
+  void Execute() override { pool_->RunWorker(worker_); }
+
+ private:
+  ThreadPool* pool_;
+  Worker* worker_;
+};
+
+// The ranges of one ParallelFor(), claimed in turn by the calling thread and
+// any workers that join in.  Ref counted, since a worker may only get to its
+// task after the call has returned, to find nothing left.
+class ThreadPool::ParallelForState
+    : public base::RefCountedThreadSafe<ParallelForState> {
+ public:
+  ParallelForState(int begin, int end, int grain_size, Body* body)
+      : begin_(begin),
+        end_(end),
+        grain_size_(grain_size),
+        num_ranges_((end - begin + grain_size - 1) / grain_size),
+        body_(body),
+        next_range_(0),
+        num_done_(0),
+        finished_(&lock_),
+        done_(false) {}
+  ~ParallelForState() {}
+  DISALLOW_COPY_AND_ASSIGN(ParallelForState);
+
+  int num_ranges() const { return num_ranges_; }
+
+  // Run ranges until none are left to claim.
+  void RunRanges() {
+    int range;
+    while ((range = next_range_.fetch_add(1, std::memory_order_relaxed)) <
+           num_ranges_) {
+      const int begin = begin_ + range * grain_size_;
+      body_->Run(begin, std::min(begin + grain_size_, end_));
+      if (num_done_.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+          num_ranges_) {
+        AutoLock lock(&lock_);
+        done_ = true;
+        finished_.Signal();
+      }
+    }
+  }
+
+  // Wait for the ranges others claimed to finish.
+  void Wait() {
+    AutoLock lock(&lock_);
+    while (!done_)
+      finished_.Wait();
+  }
+
+ private:
+  const int begin_;
+  const int end_;
+  const int grain_size_;
+  const int num_ranges_;
+  Body* body_;
+  std::atomic<int> next_range_;
+  std::atomic<int> num_done_;
+
+  Mutex lock_;
+  ConditionVariable finished_;
+  bool done_;
+};
+
+class ThreadPool::ParallelForTask : public Task {
+ public:
+  explicit ParallelForTask(ParallelForState* state) : state_(state) {}
+  ~ParallelForTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(ParallelForTask);
+
+  // Task:
+  void Execute() override { state_->RunRanges(); }
+
+ private:
+  scoped_refptr<ParallelForState> state_;
+};
+
+ThreadPool::ThreadPool(int num_workers)
+    : num_workers_(num_workers),
+      workers_(new Worker[num_workers]),
+      started_(false),
+      wake_(&lock_),
+      num_shared_tasks_(0),
+      num_sleeping_(0),
+      stopping_(false) {
+  DCHECK_GT(num_workers_, 0);
+  DCHECK_LE(num_workers_, thread::kMaxThreads - thread::kNumNamedThreads);
+  for (int i = 0; i < num_workers_; ++i) {
+    workers_[i].index = i;
+    workers_[i].steal_seed = i + 1;
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  Stop();
+}
+
+void ThreadPool::Start() {
+  DCHECK(!started_);
+  started_ = true;
+  stopping_ = false;
+  for (int i = 0; i < num_workers_; ++i) {
+    workers_[i].thread.Start(
+        std::make_unique<WorkerTask>(this, &workers_[i]));
+  }
+}
+
+void ThreadPool::Stop() {
+  if (!started_)
+    return;
+
+  {
+    AutoLock lock(&lock_);
+    stopping_ = true;
+    wake_.Broadcast();
+  }
+  for (int i = 0; i < num_workers_; ++i)
+    workers_[i].thread.Join();
+  started_ = false;
+
+  // Delete anything posted from outside once the workers had finished.
+  std::deque<std::unique_ptr<Task>> tasks;
+  {
+    AutoLock lock(&lock_);
+    tasks.swap(shared_tasks_);
+    num_shared_tasks_.store(0, std::memory_order_relaxed);
+  }
+}
+
+void ThreadPool::PostTask(std::unique_ptr<Task> task) {
+  Worker* worker = current_worker_.Get();
+  if (worker && worker->deque.Push(&task)) {
+    WakeWorker();
+    return;
+  }
+
+  AutoLock lock(&lock_);
+  shared_tasks_.push_back(std::move(task));
+  num_shared_tasks_.fetch_add(1, std::memory_order_relaxed);
+  if (num_sleeping_.load(std::memory_order_relaxed))
+    wake_.Signal();
+}
+
+void ThreadPool::ParallelFor(int begin, int end, int grain_size, Body* body) {
+  DCHECK_GT(grain_size, 0);
+  if (begin >= end)
+    return;
+  if (!started_ || end - begin <= grain_size) {
+    body->Run(begin, end);
+    return;
+  }
+
+  scoped_refptr<ParallelForState> state(
+      new ParallelForState(begin, end, grain_size, body));
+  // The calling thread takes ranges too, so it needs one less helper.
+  const int num_helpers = std::min(num_workers_, state->num_ranges() - 1);
+  for (int i = 0; i < num_helpers; ++i)
+    PostTask(std::make_unique<ParallelForTask>(state.get()));
+  state->RunRanges();
+  state->Wait();
+}
+
+bool ThreadPool::RunsTasksOnCurrentThread() {
+  return current_worker_.Get() != nullptr;
+}
+
+// private:
+void ThreadPool::RunWorker(Worker* worker) {
+  current_worker_.Set(worker);
+  while (true) {
+    std::unique_ptr<Task> task = FindTask(worker);
+    if (task) {
+      task->Execute();
+      continue;
+    }
+
+    // Count this worker as sleeping before the last look, so a task pushed
+    // onto a deque after the look sees it and wakes it.
+    AutoLock lock(&lock_);
+    num_sleeping_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!HasTasks() && !stopping_)
+      wake_.Wait();
+    num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+    if (!HasTasks())
+      break;
+  }
+  current_worker_.Set(nullptr);
+}
+
+std::unique_ptr<Task> ThreadPool::FindTask(Worker* worker) {
+  std::unique_ptr<Task> task = worker->deque.Pop();
+  if (task)
+    return task;
+
+  if (num_shared_tasks_.load(std::memory_order_relaxed)) {
+    AutoLock lock(&lock_);
+    if (!shared_tasks_.empty()) {
+      task = std::move(shared_tasks_.front());
+      shared_tasks_.pop_front();
+      num_shared_tasks_.fetch_sub(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+
+  // Steal from the other workers, starting at a random one.
+  uint32_t& seed = worker->steal_seed;
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  const int first = seed % num_workers_;
+  for (int i = 0; i < num_workers_; ++i) {
+    Worker& victim = workers_[(first + i) % num_workers_];
+    if (&victim == worker)
+      continue;
+    task = victim.deque.Steal();
+    if (task)
+      return task;
+  }
+  return nullptr;
+}
+
+bool ThreadPool::HasTasks() const {
+  if (!shared_tasks_.empty())
+    return true;
+  for (int i = 0; i < num_workers_; ++i) {
+    if (!workers_[i].deque.Empty())
+      return true;
+  }
+  return false;
+}
+
+void ThreadPool::WakeWorker() {
+  // Pairs with the fence in RunWorker(): either this sees the sleeper, or
+  // the sleeper sees the task.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!num_sleeping_.load(std::memory_order_relaxed))
+    return;
+  AutoLock lock(&lock_);
+  wake_.Signal();
+}
@@ -0,0 +1,93 @@
+////
+// thread_pool.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/thread/condition_variable.h"
+#include "base/thread/mutex.h"
+#include "base/thread/thread_local.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+class Task;
+
+// Runs tasks in parallel on a pool of worker threads.  A task posted by a
+// worker goes into that worker's own work-stealing deque, where it runs
+// newest first without any locking; tasks from other threads go into a
+// shared queue.  A worker that runs out takes from the shared queue, then
+// steals the oldest task of another worker, and sleeps once there's nothing
+// left anywhere.
+class ThreadPool {
+ public:
+  // The work of a ParallelFor(), in ranges of indexes.
+  class Body {
+   public:
+    virtual ~Body() {}
+    // Do the work for the indexes in [begin, end).  Called on any thread,
+    // at the same time as other ranges.
+    virtual void Run(int begin, int end) = 0;
+  };
+
+  explicit ThreadPool(int num_workers);
+  // Stops the workers if they're running.
+  ~ThreadPool();
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+
+  int num_workers() const { return num_workers_; }
+
+  // Start the workers.  Each takes a thread id from thread::AllocThreadId(),
+  // so CHECK_THREAD works on it.
+  void Start();
+
+  // Finish the tasks already posted, then stop the workers.
+  void Stop();
+
+  // Queue |task| to run on one of the workers.  Called on any thread.
+  void PostTask(std::unique_ptr<Task> task);
+
+  // Run |body| over the indexes in [begin, end), in ranges of at most
+  // |grain_size|, on the workers and the calling thread together.  Returns
+  // once every range has run.  Called on any thread, including the workers.
+  void ParallelFor(int begin, int end, int grain_size, Body* body);
+
+  // Whether the current thread is one of the workers.
+  bool RunsTasksOnCurrentThread();
+
+ private:
+  class WorkerTask;
+  class ParallelForState;
+  class ParallelForTask;
+  struct Worker;
+
+  // Run tasks until the pool stops and there's nothing left to run.
+  void RunWorker(Worker* worker);
+
+  // Take a task from |worker|'s deque, the shared queue, or another worker,
+  // or return null if none was found.
+  std::unique_ptr<Task> FindTask(Worker* worker);
+
+  // Whether any task is waiting.  Called with |lock_| held.
+  bool HasTasks() const;
+
+  // Wake a sleeping worker, if there is one, for a task just pushed onto a
+  // deque.
+  void WakeWorker();
+
+  const int num_workers_;
+  std::unique_ptr<Worker[]> workers_;
+  ThreadLocalPtr<Worker> current_worker_;
+  bool started_;
+
+  Mutex lock_;
+  ConditionVariable wake_;
+  // Tasks posted from outside the pool, or by a worker whose deque is full.
+  std::deque<std::unique_ptr<Task>> shared_tasks_;
+  // The size of |shared_tasks_|, read without the lock.
+  std::atomic<int> num_shared_tasks_;
+  std::atomic<int> num_sleeping_;
+  bool stopping_;
+};
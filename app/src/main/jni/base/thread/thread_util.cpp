@@ -6,6 +6,12 @@
 
 #include "base/thread/mutex.h"
 
+#include <string.h>
+
+#if OS_POSIX
+#include <unistd.h>
+#endif
+
 namespace thread {
 
 namespace {
@@ -46,7 +52,10 @@ int AllocThreadId() {
       break;
     }
   }
-  CHECK_LT(thread_id, kMaxThreads);
+  if (thread_id == Unknown) {
+    LOG(FATAL) << "Out of thread ids: all " << kMaxThreads - kNumNamedThreads
+               << " are in use";
+  }
   return thread_id;
 }
 
@@ -76,4 +85,15 @@ bool CurrentlyOn(int thread_id) {
 #endif
 }
 
+int GetProcessorCount() {
+#if OS_POSIX
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? static_cast<int>(count) : 1;
+#elif OS_WIN
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwNumberOfProcessors;
+#endif
+}
+
 }  // namespace thread
@@ -46,4 +46,7 @@ void ReleaseThreadId(int thread_id);
 int CurrentThread();
 bool CurrentlyOn(int thread_id);
 
+// The number of processors currently online.
+int GetProcessorCount();
+
 }  // namespace thread
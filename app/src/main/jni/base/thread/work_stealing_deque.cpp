@@ -0,0 +1,85 @@
+////
+// work_stealing_deque.cpp
+////
+
+#include "base/thread/work_stealing_deque.h"
+
+#include "base/logging.h"
+#include "base/thread/task.h"
+
+// The fences follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and
+// Efficient Work-Stealing for Weak Memory Models".
+
+WorkStealingDeque::WorkStealingDeque(int capacity_bits)
+    : mask_((int64_t(1) << capacity_bits) - 1),
+      buffer_(new std::atomic<Task*>[mask_ + 1]),
+      top_(0),
+      bottom_(0) {
+  DCHECK_GT(capacity_bits, 0);
+  DCHECK_LT(capacity_bits, 31);
+}
+
+WorkStealingDeque::~WorkStealingDeque() {
+  while (Pop()) {
+  }
+}
+
+bool WorkStealingDeque::Push(std::unique_ptr<Task>* task) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const int64_t top = top_.load(std::memory_order_acquire);
+  if (bottom - top > mask_)
+    return false;
+
+  buffer_[bottom & mask_].store(task->release(), std::memory_order_relaxed);
+  // Publish the task along with the new bottom.
+  bottom_.store(bottom + 1, std::memory_order_release);
+  return true;
+}
+
+std::unique_ptr<Task> WorkStealingDeque::Pop() {
+  // Claim the bottom task before looking at the top, so a thief either sees
+  // the claim or loses the race for the last task below.
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // Empty.
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Task* task = buffer_[bottom & mask_].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // The last task, which a thief may be after too.
+    if (!top_.compare_exchange_strong(top, top + 1,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      task = nullptr;
+    }
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return std::unique_ptr<Task>(task);
+}
+
+std::unique_ptr<Task> WorkStealingDeque::Steal() {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr;
+
+  Task* task = buffer_[top & mask_].load(std::memory_order_relaxed);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return std::unique_ptr<Task>(task);
+}
+
+bool WorkStealingDeque::Empty() const {
+  const int64_t top = top_.load(std::memory_order_relaxed);
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  return bottom <= top;
+}
@@ -0,0 +1,50 @@
+////
+// work_stealing_deque.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+
+#include <atomic>
+#include <memory>
+
+class Task;
+
+// A Chase-Lev deque of tasks.  The thread that owns it pushes and pops at
+// the bottom without locking, newest first, while any other thread may steal
+// from the top, oldest first.  The buffer has a fixed size, so it never has
+// to be freed while a thief might still be reading it.
+class WorkStealingDeque {
+ public:
+  // Hold up to 2^|capacity_bits| tasks.
+  explicit WorkStealingDeque(int capacity_bits);
+  // Tasks left in the deque are deleted without running.
+  ~WorkStealingDeque();
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+
+  // Push |task| at the bottom, or return false if the deque is full and
+  // leave |task| alone.  Only called by the owner.
+  bool Push(std::unique_ptr<Task>* task);
+
+  // Take the newest task, or return null if there's none.  Only called by
+  // the owner.
+  std::unique_ptr<Task> Pop();
+
+  // Take the oldest task, or return null if there's none or another thread
+  // took it first.  Called on any thread.
+  std::unique_ptr<Task> Steal();
+
+  // Whether the deque looked empty.  Only a hint, since other threads may be
+  // pushing or stealing.
+  bool Empty() const;
+
+ private:
+  const int64_t mask_;
+  std::unique_ptr<std::atomic<Task*>[]> buffer_;
+  // Thieves take from |top_| and the owner pushes at |bottom_|.  Neither
+  // wraps, so the buffer index is the value masked.
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+};
@@ -0,0 +1,75 @@
+////
+// worker_thread.cpp
+////
+
+#include "base/thread/worker_thread.h"
+
+#include "base/logging.h"
+#include "base/thread/task.h"
+
+class WorkerThread::RunLoopTask : public Task {
+ public:
+  RunLoopTask(WorkerThread* worker) : worker_(worker) {}
+  ~RunLoopTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(RunLoopTask);
+
+  // Task:
+  void Execute() override { worker_->RunLoop(); }
+
+ private:
+  WorkerThread* worker_;
+};
+
+WorkerThread::WorkerThread() : wake_(&lock_), stopping_(false) {}
+
+WorkerThread::~WorkerThread() {
+  Stop();
+}
+
+void WorkerThread::Start(thread::ID thread_id) {
+  DCHECK(!thread_.started());
+  stopping_ = false;
+  thread_.StartNamed(thread_id, std::make_unique<RunLoopTask>(this));
+}
+
+void WorkerThread::Stop() {
+  if (!thread_.started())
+    return;
+
+  {
+    AutoLock lock(&lock_);
+    stopping_ = true;
+    wake_.Signal();
+  }
+  thread_.Join();
+
+  // Delete anything left over outside the lock.
+  std::deque<std::unique_ptr<Task>> tasks;
+  {
+    AutoLock lock(&lock_);
+    tasks.swap(tasks_);
+  }
+}
+
+void WorkerThread::PostTask(std::unique_ptr<Task> task) {
+  AutoLock lock(&lock_);
+  tasks_.push_back(std::move(task));
+  wake_.Signal();
+}
+
+// private:
+void WorkerThread::RunLoop() {
+  while (true) {
+    std::unique_ptr<Task> task;
+    {
+      AutoLock lock(&lock_);
+      while (!stopping_ && tasks_.empty())
+        wake_.Wait();
+      if (stopping_)
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task->Execute();
+  }
+}
@@ -0,0 +1,45 @@
+////
+// worker_thread.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/thread/condition_variable.h"
+#include "base/thread/mutex.h"
+#include "base/thread/thread.h"
+
+#include <deque>
+#include <memory>
+
+class Task;
+
+// A thread that runs posted tasks one at a time, in order.
+class WorkerThread {
+ public:
+  WorkerThread();
+  ~WorkerThread();
+  DISALLOW_COPY_AND_ASSIGN(WorkerThread);
+
+  // Start the thread as one of the named threads.
+  void Start(thread::ID thread_id);
+
+  // Wait for the running task to finish, then stop the thread.  Tasks that
+  // haven't started are deleted without running.
+  void Stop();
+
+  // Queue |task| to run on the thread.  Called on any thread.
+  void PostTask(std::unique_ptr<Task> task);
+
+ private:
+  class RunLoopTask;
+
+  void RunLoop();
+
+  Thread thread_;
+
+  Mutex lock_;
+  ConditionVariable wake_;
+  std::deque<std::unique_ptr<Task>> tasks_;
+  bool stopping_;
+};
@@ -0,0 +1,42 @@
+////
+// bits.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+
+namespace bits {
+
+// Return the number of set bits in |value|.
+constexpr int CountSetBits(uint32_t value) {
+  return __builtin_popcount(value);
+}
+
+constexpr int CountSetBits64(uint64_t value) {
+  return __builtin_popcountll(value);
+}
+
+// Return the index of the lowest set bit in |value|.  |value| must not be 0.
+inline int FindFirstSet(uint32_t value) {
+  return __builtin_ctz(value);
+}
+
+inline int FindFirstSet64(uint64_t value) {
+  return __builtin_ctzll(value);
+}
+
+// Return the index of the |n|th lowest set bit in |value|.
+inline int FindNthSet(uint32_t value, int n) {
+  while (n--)
+    value &= value - 1;
+  return FindFirstSet(value);
+}
+
+inline int FindNthSet64(uint64_t value, int n) {
+  while (n--)
+    value &= value - 1;
+  return FindFirstSet64(value);
+}
+
+}  // namespace bits
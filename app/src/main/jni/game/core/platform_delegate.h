@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 class Task;
 
@@ -19,8 +20,8 @@ class PlatformDelegate {
   // Top level view hierachry has changed.
   virtual void InvalidateRootView() {}
 
-  // View's layout has changed.
-  virtual void InvalidateView(int id) {}
+  // The layout of each view in |ids| has changed.
+  virtual void InvalidateViews(const std::vector<int>& ids) {}
 
   // Top level view has changed.
   virtual void HandleViewChanged(int id) {}
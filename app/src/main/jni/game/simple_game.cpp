@@ -18,19 +18,22 @@
 #include "game/ui/render_state.h"
 #include "game/ui/view.h"
 
+#include <vector>
+
 namespace {
-class InvalidateViewTask : public Task {
+class InvalidateViewsTask : public Task {
  public:
-  InvalidateViewTask(PlatformDelegate* platform_delegate, int id)
-      : platform_delegate_(platform_delegate), id_(id) {}
-  ~InvalidateViewTask() override {}
+  InvalidateViewsTask(PlatformDelegate* platform_delegate,
+                      std::vector<int> ids)
+      : platform_delegate_(platform_delegate), ids_(std::move(ids)) {}
+  ~InvalidateViewsTask() override {}
 
  private:
   // Task:
-  void Execute() override { platform_delegate_->InvalidateView(id_); }
+  void Execute() override { platform_delegate_->InvalidateViews(ids_); }
 
   PlatformDelegate* platform_delegate_;
-  int id_;
+  std::vector<int> ids_;
 };
 }
 
@@ -42,10 +45,19 @@ SimpleGame::SimpleGame(PlatformDelegate* platform_delegate)
       ui_shader_(new BasicTextureShader),
       focus_render_delegate_(new DefaultFocusRenderDelegate) {
   CHECK_THREAD(thread::Ui);
+  background_thread_.Start(thread::Background);
 }
 
 SimpleGame::~SimpleGame() {
   CHECK_THREAD(thread::Ui);
+  // Destroy the views first, which cancels any search they have running on
+  // the background thread, so stopping it doesn't wait the search out.
+  {
+    AutoLock lock(&view_lock_);
+    SetFocus(nullptr);
+    view_.reset();
+  }
+  background_thread_.Stop();
 }
 
 void SimpleGame::MoveFocusRight() {
@@ -209,6 +221,16 @@ void SimpleGame::OnRender() {
       focus_render_delegate_->Render(&render_state, focused_view_);
     }
   }
+
+  // Send the frame's layout changes to the UI thread all at once.
+  if (!laid_out_view_ids_.empty()) {
+    platform_delegate_->PostNativeUiTask(
+        std::make_unique<InvalidateViewsTask>(
+            platform_delegate_, std::vector<int>(laid_out_view_ids_.begin(),
+                                                 laid_out_view_ids_.end())),
+        TimeInterval());
+    laid_out_view_ids_.clear();
+  }
 }
 
 // protected:
@@ -339,16 +361,18 @@ void SimpleGame::SetFocus(ui::View* view) {
 
 // ui::RootView:
 void SimpleGame::PostUiTask(std::unique_ptr<Task> task) {
-  CHECK_THREAD(thread::Ui);
   platform_delegate_->PostNativeUiTask(std::move(task), TimeInterval());
 }
 
 void SimpleGame::PostUiTaskDelayed(std::unique_ptr<Task> task,
                                    const TimeInterval& delay) {
-  CHECK_THREAD(thread::Ui);
   platform_delegate_->PostNativeUiTask(std::move(task), delay);
 }
 
+void SimpleGame::PostBackgroundTask(std::unique_ptr<Task> task) {
+  background_thread_.PostTask(std::move(task));
+}
+
 bool SimpleGame::CaptureMouse(InputListener* listener) {
   // No mouse.
   return false;
@@ -368,9 +392,8 @@ void SimpleGame::OnRemoveView(ui::View* view) {
 
 void SimpleGame::OnLayoutView(ui::View* view) {
   CHECK_THREAD(thread::Render);
-  platform_delegate_->PostNativeUiTask(
-      std::make_unique<InvalidateViewTask>(platform_delegate_, view->id()),
-      TimeInterval());
+  // Sent at the end of the frame by OnRender().
+  laid_out_view_ids_.insert(view->id());
 }
 
 void SimpleGame::OnTextChanged(ui::View* view) {
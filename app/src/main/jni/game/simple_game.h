@@ -7,11 +7,13 @@
 #include "base/macros.h"
 #include "base/math/matrix.h"
 #include "base/thread/mutex.h"
+#include "base/thread/worker_thread.h"
 #include "base/time.h"
 #include "game/ui/root_view.h"
 
 #include <map>
 #include <memory>
+#include <set>
 
 class BasicTextureShader;
 class KeyEvent;
@@ -88,6 +90,7 @@ class SimpleGame : ui::RootView {
   void PostUiTask(std::unique_ptr<Task> task) override;
   void PostUiTaskDelayed(std::unique_ptr<Task> task,
                          const TimeInterval& delay) override;
+  void PostBackgroundTask(std::unique_ptr<Task> task) override;
   bool CaptureMouse(InputListener* listener) override;
   void ReleaseMouse(InputListener* listener) override;
   void OnRemoveView(ui::View* view) override;
@@ -110,4 +113,10 @@ class SimpleGame : ui::RootView {
   Matrix ui_projection_matrix_;
 
   std::map<long, std::unique_ptr<TouchEvent>> touches_;
+
+  // The views laid out during the frame being rendered.  Only used on the
+  // Render thread.
+  std::set<int> laid_out_view_ids_;
+
+  WorkerThread background_thread_;
 };
@@ -18,10 +18,13 @@ class View;
 class RootView {
  public:
   virtual ~RootView() {}
-  // Called on UI thread.
+  // Called on any thread.
   virtual void PostUiTask(std::unique_ptr<Task> task) = 0;
   virtual void PostUiTaskDelayed(std::unique_ptr<Task> task,
                                  const TimeInterval& delay) = 0;
+  virtual void PostBackgroundTask(std::unique_ptr<Task> task) = 0;
+
+  // Called on UI thread.
   virtual bool CaptureMouse(InputListener* listener) = 0;
   virtual void ReleaseMouse(InputListener* listener) = 0;
 
@@ -2,7 +2,6 @@
 // bindings.cpp
 ////
 
-#include "base/thread/task.h"
 #include "base/thread/thread_util.h"
 #include "game/input/keycodes.h"
 #include "game/ui/accessibility_action.h"
@@ -50,13 +49,6 @@ void JNI_FUNC(nativeDestroy)(JNIEnv* env, jclass) {
   g_platform_delegate.reset();
 }
 
-void JNI_FUNC(nativeRunUiTask)(JNIEnv* env, jclass, jlong task_ptr) {
-  CHECK_THREAD(thread::Ui);
-  Task* task = reinterpret_cast<Task*>(task_ptr);
-  task->Execute();
-  delete task;
-}
-
 // View
 jboolean JNI_FUNC(nativeOnKeyDown)(JNIEnv* env, jclass, jint key_code) {
   return g_platform_delegate->game()->OnKeyDown(key_code);
@@ -5,6 +5,7 @@
 #include "platform/android/platform_delegate_android.h"
 
 #include "base/file/file_manager_android.h"
+#include "base/thread/message_loop.h"
 #include "base/thread/thread_util.h"
 #include "game/ui/view.h"
 #include "platform/android/android.h"
@@ -20,6 +21,22 @@ PlatformDelegateAndroid::PlatformDelegateAndroid(jobject controller,
   // Keep a reference to the Java Controller.
   controller_ = env->NewGlobalRef(controller);
 
+  // Look up the methods called every frame once.
+  jclass controller_class = env->GetObjectClass(controller_);
+  invalidate_virtual_views_method_ = env->GetMethodID(
+      controller_class, "invalidateVirtualViews", "([I)V");
+  env->DeleteLocalRef(controller_class);
+
+  // Run the native UI tasks from the UI thread's looper, which polls the
+  // loop's fd along with its own.
+  ui_loop_ = std::make_unique<MessageLoop>();
+  looper_ = ALooper_forThread();
+  CHECK(looper_);
+  ALooper_acquire(looper_);
+  ALooper_addFd(looper_, ui_loop_->fd(), ALOOPER_POLL_CALLBACK,
+                ALOOPER_EVENT_INPUT, &PlatformDelegateAndroid::OnUiLoopReady,
+                ui_loop_.get());
+
   // Create the file manager.
   const char* data_dir_str = env->GetStringUTFChars(data_dir, NULL);
   file_manager_ =
@@ -31,6 +48,9 @@ PlatformDelegateAndroid::PlatformDelegateAndroid(jobject controller,
 }
 
 PlatformDelegateAndroid::~PlatformDelegateAndroid() {
+  ALooper_removeFd(looper_, ui_loop_->fd());
+  ALooper_release(looper_);
+
   JNIEnv* env = android::GetJNIEnv();
   // Release the reference to the Java Controller.
   env->DeleteGlobalRef(controller_);
@@ -46,13 +66,14 @@ void PlatformDelegateAndroid::InvalidateRootView() {
                                        "invalidateRoot", "()V"));
 }
 
-void PlatformDelegateAndroid::InvalidateView(int id) {
+void PlatformDelegateAndroid::InvalidateViews(const std::vector<int>& ids) {
   CHECK_THREAD(thread::Ui);
   JNIEnv* env = android::GetJNIEnv();
-  env->CallVoidMethod(controller_,
-                      env->GetMethodID(env->GetObjectClass(controller_),
-                                       "invalidateVirtualView", "(I)V"),
-                      id);
+  jintArray id_array = env->NewIntArray(ids.size());
+  env->SetIntArrayRegion(id_array, 0, ids.size(),
+                         reinterpret_cast<const jint*>(ids.data()));
+  env->CallVoidMethod(controller_, invalidate_virtual_views_method_, id_array);
+  env->DeleteLocalRef(id_array);
 }
 
 void PlatformDelegateAndroid::HandleViewChanged(int id) {
@@ -95,12 +116,13 @@ void PlatformDelegateAndroid::AccessibilityAnnounce(const std::string& text) {
 
 void PlatformDelegateAndroid::PostNativeUiTask(std::unique_ptr<Task> task,
                                                const TimeInterval& delay) {
-  JNIEnv* env = android::GetJNIEnv();
-
-  jclass controller_class = env->GetObjectClass(controller_);
-  jmethodID post_ui_task_method =
-      env->GetMethodID(controller_class, "postUiTask", "(JJ)V");
+  ui_loop_->PostDelayedTask(std::move(task), delay);
+}
 
-  env->CallVoidMethod(controller_, post_ui_task_method, (jlong)task.release(),
-                      (jlong)delay.Milliseconds());
+// static
+int PlatformDelegateAndroid::OnUiLoopReady(int fd, int events, void* data) {
+  CHECK_THREAD(thread::Ui);
+  static_cast<MessageLoop*>(data)->RunPendingTasks();
+  // Keep the callback registered.
+  return 1;
 }
@@ -7,9 +7,11 @@
 #include "game/core/platform_delegate.h"
 #include "game/simple_game.h"
 
+#include <android/looper.h>
 #include <jni.h>
 
 class FileManager;
+class MessageLoop;
 class SimpleGame;
 
 class PlatformDelegateAndroid : public PlatformDelegate {
@@ -25,14 +27,21 @@ class PlatformDelegateAndroid : public PlatformDelegate {
  private:
   // PlatformDelegate:
   void InvalidateRootView() override;
-  void InvalidateView(int id) override;
+  void InvalidateViews(const std::vector<int>& ids) override;
   void HandleViewChanged(int id) override;
   void HandleTextChanged(int view_id) override;
   void AccessibilityAnnounce(const std::string& text) override;
   void PostNativeUiTask(std::unique_ptr<Task> task,
                         const TimeInterval& delay) override;
 
+  // Called by the UI thread's looper when |ui_loop_| has tasks to run.
+  static int OnUiLoopReady(int fd, int events, void* data);
+
   jobject controller_;
+  jmethodID invalidate_virtual_views_method_;
+  // Runs the native UI tasks, woken through the UI thread's looper.
+  std::unique_ptr<MessageLoop> ui_loop_;
+  ALooper* looper_;
   std::unique_ptr<FileManager> file_manager_;
   std::unique_ptr<SimpleGame> game_;
 };
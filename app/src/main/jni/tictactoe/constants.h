@@ -11,7 +11,26 @@ extern const char kButtonImage[];
 enum Difficulty {
   kDifficultyEasy,
   kDifficultyHard,
+  kDifficultyExpert,
+  kDifficultyMonteCarlo,
   kDifficultyImpossible,
+  // Looks for a forced win by threats before searching.  Only gomoku has a
+  // threat search, so elsewhere it plays like Impossible.
+  kDifficultyThreatSpace,
+};
+
+// The rules of the game.  Each one is a ruleset from game_rules.h, apart
+// from 5x5, which is too large for GameState and plays on an MnkState, and
+// Qubic and gomoku, which have their own engines.
+enum Variant {
+  kVariantClassic,
+  kVariantMisere,
+  kVariantFourByFour,
+  kVariantWrap,
+  kVariantFiveByFive,
+  kVariantQubic,
+  kVariantGomoku,
+  kNumVariants,
 };
 
 enum Player {
@@ -0,0 +1,244 @@
+////
+// ai_service.cpp
+////
+
+#include "tictactoe/core/ai_service.h"
+
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "tictactoe/core/computer_player.h"
+#include "tictactoe/core/game_status.h"
+#include "tictactoe/core/symmetry.h"
+
+#include <algorithm>
+
+namespace Tictactoe {
+
+const int AiService::kMaxBatchSize;
+
+namespace {
+const int kNumDifficulties = kDifficultyThreatSpace + 1;
+
+// Every 3x3 position and difficulty fits many times over.
+const int kCacheTableBits = 16;
+}
+
+// The computer players of one worker thread, created as each difficulty is
+// first asked for.
+struct AiService::Worker {
+  Worker() : seed(0) {}
+
+  uint32_t seed;
+  scoped_refptr<ComputerPlayer> players[kNumDifficulties];
+};
+
+class AiService::WorkerTask : public Task {
+ public:
+  WorkerTask(AiService* service, Worker* worker)
+      : service_(service), worker_(worker) {}
+  ~WorkerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerTask);
+
+  // Task:
+  void Execute() override { service_->RunWorker(worker_); }
+
+ private:
+  AiService* service_;
+  Worker* worker_;
+};
+
+////
+// AiService::Counters
+////
+AiService::Counters::Counters() : requests(0), batches(0), cache_hits(0) {}
+
+////
+// AiService
+////
+AiService::AiService(int num_workers, uint32_t seed)
+    : num_workers_(num_workers),
+      seed_(seed),
+      workers_(new Worker[num_workers]),
+      threads_(new Thread[num_workers]),
+      started_(false),
+      wake_(&lock_),
+      stopping_(false),
+      cache_(kCacheTableBits),
+      num_requests_(0),
+      num_batches_(0),
+      num_cache_hits_(0) {
+  DCHECK_GT(num_workers_, 0);
+}
+
+AiService::~AiService() {
+  Stop();
+}
+
+void AiService::Start() {
+  DCHECK(!started_);
+  started_ = true;
+  stopping_ = false;
+  for (int i = 0; i < num_workers_; ++i) {
+    workers_[i].seed = seed_ + i;
+    threads_[i].Start(std::make_unique<WorkerTask>(this, &workers_[i]));
+  }
+}
+
+void AiService::Stop() {
+  if (!started_)
+    return;
+
+  {
+    AutoLock lock(&lock_);
+    stopping_ = true;
+    wake_.Broadcast();
+  }
+  for (int i = 0; i < num_workers_; ++i)
+    threads_[i].Join();
+  started_ = false;
+}
+
+void AiService::RequestMove(const TictactoeState& state,
+                            Difficulty difficulty,
+                            Listener* listener,
+                            int tag) {
+  Request request = {state, difficulty, listener, tag};
+  AutoLock lock(&lock_);
+  // Otherwise a listener that keeps asking would keep Stop() from returning.
+  if (stopping_)
+    return;
+  requests_.push_back(request);
+  wake_.Signal();
+}
+
+AiService::Counters AiService::counters() const {
+  Counters counters;
+  counters.requests = num_requests_.load(std::memory_order_relaxed);
+  counters.batches = num_batches_.load(std::memory_order_relaxed);
+  counters.cache_hits = num_cache_hits_.load(std::memory_order_relaxed);
+  return counters;
+}
+
+// private:
+void AiService::RunWorker(Worker* worker) {
+  std::vector<Request> batch;
+  std::vector<int> moves;
+  batch.reserve(kMaxBatchSize);
+  while (true) {
+    batch.clear();
+    {
+      AutoLock lock(&lock_);
+      while (!stopping_ && requests_.empty())
+        wake_.Wait();
+      if (requests_.empty())
+        return;
+
+      // Take a fair share of the queue, so one worker doesn't take a whole
+      // burst while the others sleep.
+      const int count = std::min<int>(
+          kMaxBatchSize,
+          (requests_.size() + num_workers_ - 1) / num_workers_);
+      batch.assign(requests_.begin(), requests_.begin() + count);
+      requests_.erase(requests_.begin(), requests_.begin() + count);
+      // Wake another worker for what's left.
+      if (!requests_.empty())
+        wake_.Signal();
+    }
+
+    ChooseMoves(worker, batch, &moves);
+    num_requests_.fetch_add(batch.size(), std::memory_order_relaxed);
+    num_batches_.fetch_add(1, std::memory_order_relaxed);
+
+    // Answer outside the lock, since listeners may make new requests.
+    for (size_t i = 0; i < batch.size(); ++i)
+      batch[i].listener->OnMoveChosen(batch[i].tag, moves[i]);
+  }
+}
+
+void AiService::ChooseMoves(Worker* worker,
+                            const std::vector<Request>& batch,
+                            std::vector<int>* moves) {
+  const int count = batch.size();
+  DCHECK_LE(count, kMaxBatchSize);
+  uint16_t x_masks[kMaxBatchSize] = {};
+  uint16_t o_masks[kMaxBatchSize] = {};
+  GameStatus statuses[kMaxBatchSize];
+  for (int i = 0; i < count; ++i) {
+    x_masks[i] = batch[i].state.mask(kPlayerX);
+    o_masks[i] = batch[i].state.mask(kPlayerO);
+  }
+  GetGameStatuses(x_masks, o_masks, count, statuses);
+
+  TranspositionTable::Counters table_counters;
+  int64_t cache_hits = 0;
+  moves->assign(count, -1);
+  for (int i = 0; i < count; ++i) {
+    if (statuses[i] != kGameOngoing)
+      continue;
+
+    const Request& request = batch[i];
+    const bool cacheable = IsCacheable(request.difficulty);
+    int symmetry = 0;
+    const uint64_t key =
+        CacheKey(request.state, request.difficulty, &symmetry);
+    TranspositionTable::Entry entry;
+    if (cacheable && cache_.Probe(key, &entry, &table_counters) &&
+        entry.move >= 0) {
+      // The cached move is for the canonical position.
+      const int move = TictactoeSymmetry::TransformSpace(
+          entry.move, InverseSymmetry(symmetry));
+      if (request.state.IsEmpty(move)) {
+        (*moves)[i] = move;
+        cache_hits++;
+        continue;
+      }
+    }
+
+    scoped_refptr<ComputerPlayer>& player =
+        worker->players[request.difficulty];
+    if (!player)
+      player = new ComputerPlayer(request.difficulty, worker->seed);
+    (*moves)[i] = player->ChooseMove(request.state, nullptr);
+
+    if (cacheable) {
+      entry.move = TictactoeSymmetry::TransformSpace((*moves)[i], symmetry);
+      entry.score = 0;
+      entry.depth = 0;
+      entry.bound = TranspositionTable::kBoundExact;
+      cache_.Store(key, entry, &table_counters);
+    }
+  }
+  cache_.AddCounters(table_counters);
+  num_cache_hits_.fetch_add(cache_hits, std::memory_order_relaxed);
+}
+
+// static
+bool AiService::IsCacheable(Difficulty difficulty) {
+  switch (difficulty) {
+    case kDifficultyExpert:
+    case kDifficultyImpossible:
+    case kDifficultyThreatSpace:
+      return true;
+    case kDifficultyEasy:
+    case kDifficultyHard:
+    case kDifficultyMonteCarlo:
+      break;
+  }
+  return false;
+}
+
+// static
+uint64_t AiService::CacheKey(const TictactoeState& state,
+                             Difficulty difficulty,
+                             int* symmetry) {
+  // Each class of symmetric positions has its own canonical index, so a cheap
+  // mix of it and the difficulty makes a key.
+  const int index = TictactoeSymmetry::CanonicalIndex(
+      state.mask(kPlayerX), state.mask(kPlayerO), symmetry);
+  return (static_cast<uint64_t>(index) * kNumDifficulties + difficulty + 1) *
+         0x9e3779b97f4a7c15ull;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,125 @@
+////
+// ai_service.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/thread/condition_variable.h"
+#include "base/thread/mutex.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/tictactoe_state.h"
+#include "tictactoe/core/transposition_table.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class Thread;
+
+namespace Tictactoe {
+
+// Chooses the computer's moves for many classic games at once.  Requests
+// from any number of sessions go into one queue, which a pool of worker
+// threads drains in batches: each batch takes the lock once, checks every
+// position for a finished game in one batch win check, and looks up the
+// moves of the deterministic difficulties in a cache that all the workers
+// share.  Each worker has its own computer players, so none of them is
+// ever used by two threads at once.
+class AiService {
+ public:
+  class Listener {
+   public:
+    virtual ~Listener() {}
+    // Called on one of the service's threads with the move for the request
+    // tagged |tag|, or -1 if its game was already over.  The service may be
+    // given another request from here, which is dropped if the service is
+    // stopping.
+    virtual void OnMoveChosen(int tag, int move) = 0;
+  };
+
+  struct Counters {
+    Counters();
+
+    int64_t requests;
+    int64_t batches;
+    // Moves found in the shared cache.
+    int64_t cache_hits;
+  };
+
+  // The most requests a worker takes from the queue at once.
+  static const int kMaxBatchSize = 64;
+
+  // Seed the random moves of worker |i| from |seed| + |i|.
+  AiService(int num_workers, uint32_t seed);
+  ~AiService();
+  DISALLOW_COPY_AND_ASSIGN(AiService);
+
+  int num_workers() const { return num_workers_; }
+
+  void Start();
+
+  // Answer the requests already queued, then stop the workers.  Requests
+  // made once Stop() has been called are dropped without an answer.
+  void Stop();
+
+  // Queue a request for the computer's move in |state|.  Called on any
+  // thread.  |listener| must stay alive until it's answered, unless the
+  // service is stopping, when the request is dropped.
+  void RequestMove(const TictactoeState& state,
+                   Difficulty difficulty,
+                   Listener* listener,
+                   int tag);
+
+  Counters counters() const;
+
+ private:
+  class WorkerTask;
+  friend class WorkerTask;
+  struct Worker;
+
+  struct Request {
+    TictactoeState state;
+    Difficulty difficulty;
+    Listener* listener;
+    int tag;
+  };
+
+  // Answer requests until the service stops and the queue is empty.
+  void RunWorker(Worker* worker);
+
+  // Fill |moves| with the move for each request in |batch|.
+  void ChooseMoves(Worker* worker,
+                   const std::vector<Request>& batch,
+                   std::vector<int>* moves);
+
+  // Random difficulties aren't cached, so repeated positions still vary.
+  static bool IsCacheable(Difficulty difficulty);
+  // Symmetric positions share a key.  Sets |symmetry| to the one that turns
+  // |state| into the position the cache stores moves for.
+  static uint64_t CacheKey(const TictactoeState& state,
+                           Difficulty difficulty,
+                           int* symmetry);
+
+  const int num_workers_;
+  const uint32_t seed_;
+  std::unique_ptr<Worker[]> workers_;
+  std::unique_ptr<Thread[]> threads_;
+  bool started_;
+
+  Mutex lock_;
+  ConditionVariable wake_;
+  std::deque<Request> requests_;
+  bool stopping_;
+
+  // The moves of the deterministic difficulties, by position.
+  TranspositionTable cache_;
+
+  std::atomic<int64_t> num_requests_;
+  std::atomic<int64_t> num_batches_;
+  std::atomic<int64_t> num_cache_hits_;
+};
+
+}  // namespace Tictactoe
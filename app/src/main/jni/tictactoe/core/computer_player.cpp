@@ -0,0 +1,175 @@
+////
+// computer_player.cpp
+////
+
+#include "tictactoe/core/computer_player.h"
+
+#include "base/logging.h"
+#include "base/thread/thread_util.h"
+#include "base/util/bits.h"
+#include "tictactoe/core/mcts_search.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/mnk_search.h"
+#include "tictactoe/core/move_analysis.h"
+#include "tictactoe/core/perfect_play.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include <stdlib.h>
+
+namespace Tictactoe {
+
+namespace {
+// Search limits for the expert computer player.
+const int kSearchTableBits = 16;
+const int64_t kSearchMaxNodes = 1000000;
+
+// Tree size for the Monte Carlo computer player.
+const int kMonteCarloMaxNodes = 1 << 18;
+
+const double kDefaultMaxSearchSeconds = 0.25;
+}
+
+ComputerPlayer::ComputerPlayer(Difficulty difficulty)
+    : ComputerPlayer(difficulty, Random::get()->Next()) {
+  num_search_threads_ = thread::GetProcessorCount();
+}
+
+ComputerPlayer::ComputerPlayer(Difficulty difficulty, uint32_t seed)
+    : difficulty_(difficulty),
+      max_search_time_(TimeInterval::FromSeconds(kDefaultMaxSearchSeconds)),
+      num_search_threads_(1),
+      random_(seed) {
+  if (difficulty_ == kDifficultyExpert)
+    search_ = std::make_unique<MnkSearch>(kSearchTableBits);
+  if (difficulty_ == kDifficultyMonteCarlo)
+    monte_carlo_search_ = std::make_unique<MctsSearch>(kMonteCarloMaxNodes);
+}
+
+ComputerPlayer::~ComputerPlayer() {}
+
+int ComputerPlayer::ChooseMove(const TictactoeState& state,
+                               const std::atomic<bool>* cancel) {
+  DCHECK(!state.game_over());
+
+  switch (difficulty_) {
+    // The solved game needs no threat search.
+    case kDifficultyThreatSpace:
+    case kDifficultyImpossible:
+      // Play the solved best move.
+      return LookupPerfectPlay(state).move;
+
+    case kDifficultyExpert:
+      return FindSearchMove(state, cancel);
+
+    case kDifficultyMonteCarlo:
+      return FindMonteCarloMove(state, cancel);
+
+    case kDifficultyHard: {
+      const Player player = state.turn();
+      const Player opponent = player == kPlayerX ? kPlayerO : kPlayerX;
+
+      // Check if there is a winning move.
+      int space = state.FindWinningMove(player);
+      if (space != -1)
+        return space;
+
+      // Block any winning move.
+      space = state.FindWinningMove(opponent);
+      if (space != -1)
+        return space;
+
+      return FindRandomMove(state);
+    }
+
+    case kDifficultyEasy:
+      break;
+  }
+  return FindRandomMove(state);
+}
+
+bool ComputerPlayer::AnalyzeMoves(const TictactoeState& state,
+                                  const std::atomic<bool>* cancel,
+                                  MoveAnalysis* analysis) {
+  analysis->Reset(TictactoeState::kNumSpaces);
+  if (state.game_over())
+    return true;
+
+  // A position's score is the number of spaces left when the game ends, plus
+  // one, so the game's length falls out of it.
+  const int max_moves = TictactoeState::kNumSpaces + 1;
+  TictactoeState child = state;
+  for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+    if (cancel && cancel->load(std::memory_order_relaxed))
+      return false;
+    if (!state.IsEmpty(space))
+      continue;
+    child.PlaceMark(space);
+    const int score = -LookupPerfectPlay(child).score;
+    child.RemoveLastMark();
+    analysis->nodes++;
+
+    MoveScore& move_score = analysis->scores[space];
+    if (!score) {
+      move_score = MoveScore(MoveScore::kResultDraw, state.EmptyCount());
+    } else {
+      move_score =
+          MoveScore(score > 0 ? MoveScore::kResultWin : MoveScore::kResultLoss,
+                    max_moves - abs(score) - state.num_moves());
+    }
+  }
+  analysis->complete = true;
+  return true;
+}
+
+// private:
+int ComputerPlayer::FindSearchMove(const TictactoeState& state,
+                                   const std::atomic<bool>* cancel) {
+  MnkBoard board = CreateSearchBoard(state);
+  MnkSearchLimits limits;
+  limits.max_nodes = kSearchMaxNodes;
+  limits.max_time = max_search_time_;
+  limits.num_threads = num_search_threads_;
+  limits.cancel = cancel;
+  MnkSearchResult result = search_->Search(&board, limits);
+  DLOG(INFO) << "Search depth " << result.depth << ", " << result.nodes
+             << " nodes, " << result.NodesPerSecond() << " nodes/sec, "
+             << result.table_counters.HitRate() * 100 << "% table hits";
+  return result.move;
+}
+
+int ComputerPlayer::FindMonteCarloMove(const TictactoeState& state,
+                                       const std::atomic<bool>* cancel) {
+  MctsSearchLimits limits;
+  limits.max_time = max_search_time_;
+  limits.num_threads = num_search_threads_;
+  limits.cancel = cancel;
+  MctsSearchResult result =
+      monte_carlo_search_->Search(CreateSearchBoard(state), limits);
+  DLOG(INFO) << "Monte Carlo " << result.rollouts << " rollouts, "
+             << result.RolloutsPerSecond() << " rollouts/sec";
+  return result.move;
+}
+
+int ComputerPlayer::FindRandomMove(const TictactoeState& state) {
+  // Chose a random space from the ones available.
+  int space_offset = random_.NextDouble() * state.EmptyCount();
+  DCHECK_LT(space_offset, 9);
+  return bits::FindNthSet(state.empty_mask(), space_offset);
+}
+
+// static
+MnkBoard ComputerPlayer::CreateSearchBoard(const TictactoeState& state) {
+  // Replay the position onto a search board.  Move order doesn't matter, so
+  // alternate through each player's marks.
+  MnkBoard board(3, 3, 3);
+  uint16_t x_mask = state.mask(kPlayerX);
+  uint16_t o_mask = state.mask(kPlayerO);
+  while (x_mask || o_mask) {
+    uint16_t* marks = board.turn() == kPlayerX ? &x_mask : &o_mask;
+    board.PlaceMark(bits::FindFirstSet(*marks));
+    *marks &= *marks - 1;
+  }
+  return board;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,76 @@
+////
+// computer_player.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+class MctsSearch;
+class MnkBoard;
+class MnkSearch;
+struct MoveAnalysis;
+
+// Picks the computer's moves for one difficulty.  ChooseMove() may run on any
+// one thread at a time.
+class ComputerPlayer : public base::RefCountedThreadSafe<ComputerPlayer> {
+ public:
+  // Seed the random moves from the global generator, and search on every
+  // processor.  Must be created on the UI thread.
+  explicit ComputerPlayer(Difficulty difficulty);
+  // Seed the random moves from |seed|, and search on one thread.
+  ComputerPlayer(Difficulty difficulty, uint32_t seed);
+  ~ComputerPlayer();
+  DISALLOW_COPY_AND_ASSIGN(ComputerPlayer);
+
+  // Search limits.  The time limit applies to each move.
+  void set_max_search_time(const TimeInterval& max_search_time) {
+    max_search_time_ = max_search_time;
+  }
+  void set_num_search_threads(int num_search_threads) {
+    num_search_threads_ = num_search_threads;
+  }
+
+  // Choose a move for the player to move in |state|.  The searches stop early
+  // once |cancel| is set, in which case the move may be weaker.
+  int ChooseMove(const TictactoeState& state,
+                 const std::atomic<bool>* cancel);
+
+  // Score every empty space of |state| from the solved table, whatever the
+  // difficulty.  The table is exact, so this returns true unless |cancel| is
+  // set first.
+  bool AnalyzeMoves(const TictactoeState& state,
+                    const std::atomic<bool>* cancel,
+                    MoveAnalysis* analysis);
+
+ private:
+  int FindSearchMove(const TictactoeState& state,
+                     const std::atomic<bool>* cancel);
+  int FindMonteCarloMove(const TictactoeState& state,
+                         const std::atomic<bool>* cancel);
+  int FindRandomMove(const TictactoeState& state);
+
+  static MnkBoard CreateSearchBoard(const TictactoeState& state);
+
+  const Difficulty difficulty_;
+  TimeInterval max_search_time_;
+  int num_search_threads_;
+
+  std::unique_ptr<MnkSearch> search_;
+  std::unique_ptr<MctsSearch> monte_carlo_search_;
+
+  // The global generator belongs to the UI thread.
+  Random random_;
+};
+
+}  // namespace Tictactoe
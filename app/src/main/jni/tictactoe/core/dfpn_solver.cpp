@@ -0,0 +1,457 @@
+////
+// dfpn_solver.cpp
+////
+
+#include "tictactoe/core/dfpn_solver.h"
+
+#include "base/file/file.h"
+#include "base/file/file_manager.h"
+#include "base/logging.h"
+#include "tictactoe/core/mnk_board.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace Tictactoe {
+
+namespace {
+// How often to check the clock, in nodes.
+const int64_t kTimeCheckInterval = 1024;
+
+// The 1 + epsilon trick: a child is searched until it's this much worse
+// than its next best sibling, rather than just worse, as a fraction.
+const uint64_t kEpsilonDivisor = 4;
+
+const uint32_t kCheckpointMagic = 0x4e504644;  // "DFPN"
+const uint32_t kCheckpointVersion = 1;
+const char kCheckpointTempSuffix[] = ".tmp";
+
+// Entries are written and read this many at a time.
+const size_t kCheckpointChunkEntries = 4096;
+
+struct CheckpointHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t k;
+  uint32_t attacker;
+  uint64_t root_key;
+  uint64_t nodes;
+  uint64_t num_entries;
+  double elapsed_seconds;
+};
+
+Player Opponent(Player player) {
+  return player == kPlayerX ? kPlayerO : kPlayerX;
+}
+}
+
+////
+// DfpnLimits
+////
+DfpnLimits::DfpnLimits()
+    : max_nodes(0),
+      cancel(nullptr),
+      progress_interval(0),
+      checkpoint_interval(0) {}
+
+////
+// DfpnProgress
+////
+DfpnProgress::DfpnProgress()
+    : result(kResultUnknown),
+      proof_number(1),
+      disproof_number(1),
+      move(-1),
+      nodes(0) {}
+
+double DfpnProgress::NodesPerSecond() const {
+  if (elapsed.Seconds() <= 0)
+    return 0;
+  return nodes / elapsed.Seconds();
+}
+
+////
+// DfpnSolver
+////
+const uint32_t DfpnSolver::kInfinity = 0xffffffff;
+const int DfpnSolver::kBucketSize;
+
+DfpnSolver::DfpnSolver(int table_bits)
+    : table_(size_t(1) << table_bits),
+      root_key_(0),
+      root_width_(0),
+      root_height_(0),
+      root_k_(0),
+      attacker_(kPlayerNone),
+      listener_(nullptr),
+      previous_nodes_(0),
+      nodes_(0),
+      next_progress_(0),
+      next_checkpoint_(0),
+      stopped_(false),
+      root_phi_(1),
+      root_delta_(1),
+      root_move_(-1),
+      root_turn_(kPlayerNone) {
+  DCHECK_GE(table_bits, 2);
+  Clear();
+}
+
+DfpnSolver::~DfpnSolver() {}
+
+DfpnProgress DfpnSolver::Solve(MnkBoard* board,
+                               Player attacker,
+                               const DfpnLimits& limits) {
+  DCHECK(!board->game_over());
+  DCHECK_NE(attacker, kPlayerNone);
+
+  int symmetry = 0;
+  const uint64_t key = board->CanonicalHash(&symmetry);
+  if (key != root_key_ || board->width() != root_width_ ||
+      board->height() != root_height_ || board->k() != root_k_ ||
+      attacker != attacker_) {
+    Clear();
+    root_key_ = key;
+    root_width_ = board->width();
+    root_height_ = board->height();
+    root_k_ = board->k();
+    attacker_ = attacker;
+  }
+
+  limits_ = limits;
+  start_ = Timestamp::Now() - previous_elapsed_;
+  deadline_ = Timestamp::Now() + limits.max_time;
+  nodes_ = 0;
+  next_progress_ = limits.progress_interval;
+  next_checkpoint_ = limits.checkpoint_interval;
+  stopped_ = false;
+
+  root_turn_ = board->turn();
+  root_move_ = -1;
+  if (!Lookup(key, &root_phi_, &root_delta_))
+    root_phi_ = root_delta_ = 1;
+  children_.resize(board->num_spaces() + 1);
+
+  Search(board, key, kInfinity, kInfinity, 0);
+
+  if (!checkpoint_file_.empty() && limits_.checkpoint_interval)
+    SaveCheckpoint();
+
+  const DfpnProgress progress = GetProgress();
+  previous_nodes_ = progress.nodes;
+  previous_elapsed_ = progress.elapsed;
+  nodes_ = 0;
+  return progress;
+}
+
+bool DfpnSolver::SaveCheckpoint() {
+  DCHECK(!checkpoint_file_.empty());
+
+  const std::string temp_file = checkpoint_file_ + kCheckpointTempSuffix;
+  std::unique_ptr<File> file = FileManager::Get()->WriteFile(temp_file, false);
+  if (!file) {
+    LOG(ERROR) << "Cannot write checkpoint " << temp_file;
+    return false;
+  }
+
+  const DfpnProgress progress = GetProgress();
+  CheckpointHeader header = {};
+  header.magic = kCheckpointMagic;
+  header.version = kCheckpointVersion;
+  header.width = root_width_;
+  header.height = root_height_;
+  header.k = root_k_;
+  header.attacker = attacker_;
+  header.root_key = root_key_;
+  header.nodes = progress.nodes;
+  header.elapsed_seconds = progress.elapsed.Seconds();
+  for (const Entry& entry : table_)
+    header.num_entries += entry.work != 0;
+  bool ok = file->Write(&header, sizeof(header)) == sizeof(header);
+
+  // Only the used entries are written, in chunks.
+  std::vector<Entry> chunk;
+  chunk.reserve(kCheckpointChunkEntries);
+  for (size_t i = 0; ok && i <= table_.size(); ++i) {
+    if (i < table_.size() && table_[i].work)
+      chunk.push_back(table_[i]);
+    if (chunk.size() == kCheckpointChunkEntries ||
+        (i == table_.size() && !chunk.empty())) {
+      const size_t bytes = chunk.size() * sizeof(Entry);
+      ok = file->Write(chunk.data(), bytes) == bytes;
+      chunk.clear();
+    }
+  }
+  file->Close();
+
+  if (!ok || !FileManager::Get()->Rename(temp_file, checkpoint_file_)) {
+    LOG(ERROR) << "Failed to save checkpoint " << checkpoint_file_;
+    return false;
+  }
+  return true;
+}
+
+bool DfpnSolver::LoadCheckpoint() {
+  DCHECK(!checkpoint_file_.empty());
+  Clear();
+
+  std::unique_ptr<File> file = FileManager::Get()->ReadFile(checkpoint_file_);
+  if (!file)
+    return false;
+
+  CheckpointHeader header;
+  if (file->Read(&header, sizeof(header)) != sizeof(header) ||
+      header.magic != kCheckpointMagic ||
+      header.version != kCheckpointVersion) {
+    LOG(ERROR) << "Bad checkpoint header in " << checkpoint_file_;
+    return false;
+  }
+
+  // The entries go back in through Store(), so the table may be a
+  // different size from the one that saved them.
+  std::vector<Entry> chunk(kCheckpointChunkEntries);
+  uint64_t remaining = header.num_entries;
+  while (remaining) {
+    const size_t count =
+        std::min<uint64_t>(remaining, kCheckpointChunkEntries);
+    const size_t bytes = count * sizeof(Entry);
+    if (file->Read(chunk.data(), bytes) != bytes) {
+      LOG(ERROR) << "Truncated checkpoint " << checkpoint_file_;
+      Clear();
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+      Store(chunk[i].key, chunk[i].phi, chunk[i].delta, chunk[i].work);
+    remaining -= count;
+  }
+
+  root_key_ = header.root_key;
+  root_width_ = header.width;
+  root_height_ = header.height;
+  root_k_ = header.k;
+  attacker_ = static_cast<Player>(header.attacker);
+  previous_nodes_ = header.nodes;
+  previous_elapsed_ = TimeInterval::FromSeconds(header.elapsed_seconds);
+  return true;
+}
+
+void DfpnSolver::Clear() {
+  std::fill(table_.begin(), table_.end(), Entry());
+  root_key_ = 0;
+  root_width_ = root_height_ = root_k_ = 0;
+  attacker_ = kPlayerNone;
+  previous_nodes_ = 0;
+  previous_elapsed_ = TimeInterval();
+}
+
+// private:
+void DfpnSolver::Search(MnkBoard* board,
+                        uint64_t key,
+                        uint32_t phi_threshold,
+                        uint32_t delta_threshold,
+                        int ply) {
+  if (CountNode())
+    return;
+  const int64_t start_nodes = nodes_;
+
+  std::vector<Child>& children = children_[ply];
+  GenerateChildren(board, &children);
+  DCHECK(!children.empty());
+
+  uint32_t phi = 0;
+  uint32_t delta = 0;
+  for (;;) {
+    // The player to move needs just one child to fail for its opponent,
+    // and fails only if every child succeeds.
+    phi = kInfinity;
+    uint64_t delta_sum = 0;
+    bool delta_infinite = false;
+    size_t best = 0;
+    uint32_t second_delta = kInfinity;
+    for (size_t i = 0; i < children.size(); ++i) {
+      Child& child = children[i];
+      if (!child.terminal && !Lookup(child.key, &child.phi, &child.delta))
+        child.phi = child.delta = 1;
+
+      if (child.delta < phi) {
+        second_delta = phi;
+        phi = child.delta;
+        best = i;
+      } else if (child.delta < second_delta) {
+        second_delta = child.delta;
+      }
+      delta_sum += child.phi;
+      if (child.phi == kInfinity)
+        delta_infinite = true;
+    }
+    // A large sum isn't a disproof, so it stops short of infinity.
+    delta = delta_infinite ? kInfinity
+                           : std::min<uint64_t>(delta_sum, kInfinity - 1);
+
+    if (!ply) {
+      root_phi_ = phi;
+      root_delta_ = delta;
+      root_move_ = children[best].space;
+    }
+    if (phi >= phi_threshold || delta >= delta_threshold || stopped_)
+      break;
+
+    // Search the best child until it's no longer best, or until it pushes
+    // this node past a threshold.
+    const Child& child = children[best];
+    const uint32_t child_phi_threshold = std::min<uint64_t>(
+        uint64_t(delta_threshold) - delta + child.phi, kInfinity);
+    const uint64_t second_limit =
+        second_delta + std::max<uint64_t>(1, second_delta / kEpsilonDivisor);
+    const uint32_t child_delta_threshold =
+        std::min<uint64_t>(phi_threshold, second_limit);
+
+    board->PlaceMark(child.space);
+    Search(board, child.key, child_phi_threshold, child_delta_threshold,
+           ply + 1);
+    board->RemoveMark(child.space);
+  }
+
+  Store(key, phi, delta, nodes_ - start_nodes + 1);
+}
+
+void DfpnSolver::GenerateChildren(MnkBoard* board,
+                                  std::vector<Child>* children) {
+  children->clear();
+  const Player mover = board->turn();
+  const Player next = Opponent(mover);
+
+  // A player who can complete a line only needs that move, and one who
+  // can't must block the opponent's.  Blocking one of two still loses, so
+  // one block is enough either way.
+  int forced_move = -1;
+  for (int space = 0; space < board->num_spaces(); ++space) {
+    if (!board->IsEmpty(space))
+      continue;
+    if (board->CompletesLine(mover, space)) {
+      forced_move = space;
+      break;
+    }
+    if (forced_move == -1 && board->CompletesLine(next, space))
+      forced_move = space;
+  }
+
+  for (int space = 0; space < board->num_spaces(); ++space) {
+    if (!board->IsEmpty(space))
+      continue;
+    if (forced_move != -1 && space != forced_move)
+      continue;
+
+    Child child;
+    child.space = space;
+    board->PlaceMark(space);
+    int symmetry = 0;
+    child.key = board->CanonicalHash(&symmetry);
+    // Once the attacker has no line left to fill, the game is as good as a
+    // draw.
+    child.terminal = board->game_over() || !board->CanStillWin(attacker_);
+    child.phi = child.delta = 1;
+    if (child.terminal) {
+      // The next player has lost if the mover won.  A draw is a success for
+      // whoever is defending.
+      const bool next_succeeds =
+          board->winner() == kPlayerNone && next != attacker_;
+      child.phi = next_succeeds ? 0 : kInfinity;
+      child.delta = next_succeeds ? kInfinity : 0;
+    }
+    board->RemoveMark(space);
+
+    // Moves that are symmetric to an earlier one lead to the same position.
+    bool duplicate = false;
+    for (const Child& other : *children) {
+      if (other.key == child.key) {
+        duplicate = true;
+        break;
+      }
+    }
+    if (!duplicate)
+      children->push_back(child);
+  }
+}
+
+bool DfpnSolver::Lookup(uint64_t key, uint32_t* phi, uint32_t* delta) const {
+  const size_t index = key & (table_.size() - 1) & ~size_t(kBucketSize - 1);
+  for (int i = 0; i < kBucketSize; ++i) {
+    const Entry& entry = table_[index + i];
+    if (entry.work && entry.key == key) {
+      *phi = entry.phi;
+      *delta = entry.delta;
+      return true;
+    }
+  }
+  return false;
+}
+
+void DfpnSolver::Store(uint64_t key,
+                       uint32_t phi,
+                       uint32_t delta,
+                       uint64_t work) {
+  const size_t index = key & (table_.size() - 1) & ~size_t(kBucketSize - 1);
+  Entry* replace = &table_[index];
+  for (int i = 0; i < kBucketSize; ++i) {
+    Entry* entry = &table_[index + i];
+    if (entry->work && entry->key == key) {
+      entry->phi = phi;
+      entry->delta = delta;
+      entry->work += work;
+      return;
+    }
+
+    // Replace the entry with the least work under it.  Empty entries have
+    // none.
+    if (entry->work < replace->work)
+      replace = entry;
+  }
+  replace->key = key;
+  replace->phi = phi;
+  replace->delta = delta;
+  replace->work = work;
+}
+
+bool DfpnSolver::CountNode() {
+  nodes_++;
+  if (limits_.max_nodes && nodes_ >= limits_.max_nodes)
+    stopped_ = true;
+  if (nodes_ % kTimeCheckInterval == 0) {
+    if (limits_.max_time > TimeInterval() && Timestamp::Now() >= deadline_)
+      stopped_ = true;
+    if (limits_.cancel && limits_.cancel->load(std::memory_order_relaxed))
+      stopped_ = true;
+  }
+
+  if (limits_.progress_interval && nodes_ >= next_progress_) {
+    if (listener_)
+      listener_->OnProgress(GetProgress());
+    next_progress_ += limits_.progress_interval;
+  }
+  if (limits_.checkpoint_interval && nodes_ >= next_checkpoint_) {
+    if (!checkpoint_file_.empty())
+      SaveCheckpoint();
+    next_checkpoint_ += limits_.checkpoint_interval;
+  }
+  return stopped_;
+}
+
+DfpnProgress DfpnSolver::GetProgress() const {
+  DfpnProgress progress;
+  const bool attacking = root_turn_ == attacker_;
+  progress.proof_number = attacking ? root_phi_ : root_delta_;
+  progress.disproof_number = attacking ? root_delta_ : root_phi_;
+  if (!progress.proof_number)
+    progress.result = DfpnProgress::kResultProven;
+  else if (!progress.disproof_number)
+    progress.result = DfpnProgress::kResultDisproven;
+  progress.move = root_move_;
+  progress.nodes = previous_nodes_ + nodes_;
+  progress.elapsed = Timestamp::Now() - start_;
+  return progress;
+}
+
+}  // namespace Tictactoe
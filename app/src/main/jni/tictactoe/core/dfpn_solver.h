@@ -0,0 +1,198 @@
+////
+// dfpn_solver.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "tictactoe/constants.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Tictactoe {
+
+class MnkBoard;
+
+// Limits for a single solve.  The solve stops at whichever is hit first.
+struct DfpnLimits {
+  DfpnLimits();
+
+  // No node limit if zero.
+  int64_t max_nodes;
+  // No time limit if zero.
+  TimeInterval max_time;
+  // Stop early once this is set, if not null.  Set from any thread.
+  const std::atomic<bool>* cancel;
+
+  // Report progress to the listener every this many nodes.  Never if zero.
+  int64_t progress_interval;
+  // Save a checkpoint every this many nodes, and when the solve stops.
+  // Never if zero or there's no checkpoint file.
+  int64_t checkpoint_interval;
+};
+
+// Where a solve stands.  Nodes and time include any solve resumed from a
+// checkpoint.
+struct DfpnProgress {
+  enum Result {
+    kResultUnknown,
+    // The attacker can force a win.
+    kResultProven,
+    // The defender can always draw or win.
+    kResultDisproven,
+  };
+
+  DfpnProgress();
+
+  double NodesPerSecond() const;
+
+  Result result;
+  // The root's proof and disproof numbers: the least number of positions
+  // that must still be solved to prove or disprove it.
+  uint32_t proof_number;
+  uint32_t disproof_number;
+  // The root's most promising move for the player to move.  Once solved,
+  // the move that gets the result, if it's the one the player to move
+  // wants.
+  int move;
+  int64_t nodes;
+  TimeInterval elapsed;
+};
+
+// Depth-first proof-number search, which solves whether the attacker can
+// force a win from a position on any m,n,k board.  Draws count as
+// disproofs, so solving a position exactly takes one solve with each player
+// attacking.
+//
+// Proof and disproof numbers live in a transposition table of fixed size
+// keyed by canonical hash, so symmetric positions share an entry and a full
+// table replaces the entries with the least work under them.  The solve
+// uses the 1 + epsilon trick to cut down on switching between siblings.
+//
+// The table is the solve's only state, so saving it to a checkpoint through
+// FileManager and loading it again resumes a long solve where it stopped.
+class DfpnSolver {
+ public:
+  class Listener {
+   public:
+    virtual void OnProgress(const DfpnProgress& progress) = 0;
+
+   protected:
+    virtual ~Listener() {}
+  };
+
+  static const uint32_t kInfinity;
+
+  // The table holds 2^|table_bits| entries.
+  explicit DfpnSolver(int table_bits);
+  ~DfpnSolver();
+  DISALLOW_COPY_AND_ASSIGN(DfpnSolver);
+
+  // Reported to from Solve().  May be null.
+  void set_listener(Listener* listener) { listener_ = listener; }
+
+  // The file in the FileManager data directory that Solve() checkpoints to.
+  void set_checkpoint_file(const std::string& checkpoint_file) {
+    checkpoint_file_ = checkpoint_file;
+  }
+
+  // Solve whether |attacker| can force a win from |board|, within |limits|.
+  // Carries on from the table left by the last solve or checkpoint if it
+  // was for the same position and attacker, and starts over otherwise.
+  // |board| is modified during the solve but restored before returning.
+  DfpnProgress Solve(MnkBoard* board,
+                     Player attacker,
+                     const DfpnLimits& limits);
+
+  // Write the table to the checkpoint file.  The file is written under a
+  // temporary name and renamed, so an interrupted save keeps the last one.
+  bool SaveCheckpoint();
+
+  // Load the table from the checkpoint file.  Returns false if there isn't
+  // one or it's unreadable, leaving the table empty.
+  bool LoadCheckpoint();
+
+  // Empty the table and forget the position.
+  void Clear();
+
+ private:
+  struct Entry {
+    uint64_t key;
+    // From the point of view of the player to move: phi is the proof number
+    // of their goal, and delta the disproof number.  The attacker's goal is
+    // to win and the defender's to not lose.
+    uint32_t phi;
+    uint32_t delta;
+    // Nodes searched under the position, to choose what to replace.
+    uint64_t work;
+  };
+
+  // A move from the node being searched.
+  struct Child {
+    int space;
+    uint64_t key;
+    // Set for moves that end the game, whose values never change.
+    bool terminal;
+    uint32_t phi;
+    uint32_t delta;
+  };
+
+  static const int kBucketSize = 4;
+
+  // Search |board| until its phi or delta reaches its threshold.
+  void Search(MnkBoard* board,
+              uint64_t key,
+              uint32_t phi_threshold,
+              uint32_t delta_threshold,
+              int ply);
+
+  // Fill |children| with the distinct moves from |board|, up to symmetry.
+  void GenerateChildren(MnkBoard* board, std::vector<Child>* children);
+
+  bool Lookup(uint64_t key, uint32_t* phi, uint32_t* delta) const;
+  void Store(uint64_t key, uint32_t phi, uint32_t delta, uint64_t work);
+
+  // Count a node, report progress and checkpoint as they come due, and
+  // return true if the solve should stop.
+  bool CountNode();
+
+  DfpnProgress GetProgress() const;
+
+  std::vector<Entry> table_;
+
+  // The position and attacker the table belongs to.
+  uint64_t root_key_;
+  int root_width_;
+  int root_height_;
+  int root_k_;
+  Player attacker_;
+
+  // Children of each node on the current path, kept to save reallocating.
+  std::vector<std::vector<Child>> children_;
+
+  Listener* listener_;
+  std::string checkpoint_file_;
+
+  DfpnLimits limits_;
+  Timestamp start_;
+  Timestamp deadline_;
+  // Nodes and time from earlier solves of the same position.
+  int64_t previous_nodes_;
+  TimeInterval previous_elapsed_;
+  int64_t nodes_;
+  int64_t next_progress_;
+  int64_t next_checkpoint_;
+  bool stopped_;
+
+  // The root's values and best move, as of its last update.
+  uint32_t root_phi_;
+  uint32_t root_delta_;
+  int root_move_;
+  Player root_turn_;
+};
+
+}  // namespace Tictactoe
@@ -0,0 +1,129 @@
+////
+// game.cpp
+////
+
+#include "tictactoe/core/game.h"
+
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/util/random.h"
+#include "tictactoe/core/computer_player.h"
+#include "tictactoe/core/game_rules.h"
+#include "tictactoe/core/game_state.h"
+#include "tictactoe/core/gomoku_board.h"
+#include "tictactoe/core/gomoku_player.h"
+#include "tictactoe/core/mnk_player.h"
+#include "tictactoe/core/mnk_state.h"
+#include "tictactoe/core/move_analysis.h"
+#include "tictactoe/core/qubic_board.h"
+#include "tictactoe/core/qubic_player.h"
+#include "tictactoe/core/variant_player.h"
+
+namespace Tictactoe {
+
+namespace {
+// A game with its position in a |State|, and moves chosen by a
+// |ComputerPlayerType|.  It has no analysis; see AnalyzedGameImpl.
+template <typename State, typename ComputerPlayerType>
+class GameImpl : public Game {
+ public:
+  explicit GameImpl(ComputerPlayerType* computer_player)
+      : computer_player_(computer_player) {}
+  GameImpl(const State& state,
+           const scoped_refptr<ComputerPlayerType>& computer_player)
+      : state_(state), computer_player_(computer_player) {}
+  ~GameImpl() override {}
+
+  // Game:
+  int width() const override { return State::kWidth; }
+  int height() const override { return State::kHeight; }
+  int layers() const override { return State::kLayers; }
+  Player turn() const override { return state_.turn(); }
+  Player winner() const override { return state_.winner(); }
+  int num_moves() const override { return state_.num_moves(); }
+  Player Get(int space) const override { return state_.Get(space); }
+  void PlaceMark(int space) override { state_.PlaceMark(space); }
+  int RemoveLastMark() override { return state_.RemoveLastMark(); }
+
+  std::unique_ptr<Game> Clone() const override {
+    return std::make_unique<GameImpl>(state_, computer_player_);
+  }
+
+  int ChooseComputerMove(const std::atomic<bool>* cancel) override {
+    return computer_player_->ChooseMove(state_, cancel);
+  }
+
+ protected:
+  State state_;
+  scoped_refptr<ComputerPlayerType> computer_player_;
+};
+
+// A GameImpl whose computer player can also analyze the position.
+template <typename State, typename ComputerPlayerType>
+class AnalyzedGameImpl : public GameImpl<State, ComputerPlayerType> {
+ public:
+  using GameImpl<State, ComputerPlayerType>::GameImpl;
+  ~AnalyzedGameImpl() override {}
+
+  // Game:
+  std::unique_ptr<Game> Clone() const override {
+    return std::make_unique<AnalyzedGameImpl>(this->state_,
+                                              this->computer_player_);
+  }
+
+  bool AnalyzeMoves(const std::atomic<bool>* cancel,
+                    MoveAnalysis* analysis) override {
+    return this->computer_player_->AnalyzeMoves(this->state_, cancel,
+                                                analysis);
+  }
+};
+
+// The computer players seed themselves from the global generator, so they
+// must be created on the UI thread.
+template <typename Rules>
+std::unique_ptr<Game> CreateVariantGame(Difficulty difficulty) {
+  return std::make_unique<
+      AnalyzedGameImpl<GameState<Rules>, VariantPlayer<Rules>>>(
+      new VariantPlayer<Rules>(difficulty, Random::get()->Next()));
+}
+
+template <typename Rules>
+std::unique_ptr<Game> CreateMnkGame(Difficulty difficulty) {
+  return std::make_unique<GameImpl<MnkState<Rules>, MnkPlayer<Rules>>>(
+      new MnkPlayer<Rules>(difficulty, Random::get()->Next()));
+}
+}
+
+// static
+std::unique_ptr<Game> Game::Create(Variant variant, Difficulty difficulty) {
+  switch (variant) {
+    case kVariantClassic:
+      return std::make_unique<AnalyzedGameImpl<TictactoeState, ComputerPlayer>>(
+          new ComputerPlayer(difficulty));
+    case kVariantMisere:
+      return CreateVariantGame<MisereRules>(difficulty);
+    case kVariantFourByFour:
+      return CreateVariantGame<FourByFourRules>(difficulty);
+    case kVariantWrap:
+      return CreateVariantGame<WrapRules>(difficulty);
+    case kVariantFiveByFive:
+      return CreateMnkGame<FiveByFiveRules>(difficulty);
+    case kVariantQubic:
+      return std::make_unique<GameImpl<QubicBoard, QubicPlayer>>(
+          new QubicPlayer(difficulty));
+    case kVariantGomoku:
+      return std::make_unique<GameImpl<GomokuBoard, GomokuPlayer>>(
+          new GomokuPlayer(difficulty));
+    case kNumVariants:
+      break;
+  }
+  NOTREACHED();
+  return nullptr;
+}
+
+bool Game::AnalyzeMoves(const std::atomic<bool>*, MoveAnalysis* analysis) {
+  analysis->Reset(num_spaces());
+  return false;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,67 @@
+////
+// game.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "tictactoe/constants.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+struct MoveAnalysis;
+
+// A game of any variant against a computer player, for the UI.  Each
+// variant's state and computer player are specialized for its rules; this
+// interface only adds a virtual call per UI action, never inside the game
+// code or searches.
+class Game {
+ public:
+  static std::unique_ptr<Game> Create(Variant variant, Difficulty difficulty);
+
+  virtual ~Game() {}
+
+  // The board is |layers| boards of |width| by |height| spaces, stacked.
+  // Spaces are numbered left to right, top to bottom, then layer by layer.
+  virtual int width() const = 0;
+  virtual int height() const = 0;
+  virtual int layers() const = 0;
+  int num_spaces() const { return width() * height() * layers(); }
+
+  // See GameState and QubicBoard.
+  virtual Player turn() const = 0;
+  virtual Player winner() const = 0;
+  bool game_over() const { return turn() == kPlayerNone; }
+  virtual int num_moves() const = 0;
+  virtual Player Get(int space) const = 0;
+  bool IsEmpty(int space) const { return Get(space) == kPlayerNone; }
+  virtual void PlaceMark(int space) = 0;
+  virtual int RemoveLastMark() = 0;
+
+  // Return a copy of the game that shares its computer player, so the
+  // computer can think about the copy on another thread.
+  virtual std::unique_ptr<Game> Clone() const = 0;
+
+  // Choose the computer's move for the player to move.  Only one copy of a
+  // game may choose at a time.  Stops early once |cancel| is set.
+  virtual int ChooseComputerMove(const std::atomic<bool>* cancel) = 0;
+
+  // Solve every empty space for the player to move into |analysis|, under
+  // the same rule as ChooseComputerMove().  Returns false if the variant
+  // can't be solved or the analysis stopped before it finished, in which
+  // case |analysis| holds the spaces that were solved.  By default the
+  // variant is too large to solve, so nothing is.
+  virtual bool AnalyzeMoves(const std::atomic<bool>* cancel,
+                            MoveAnalysis* analysis);
+
+ protected:
+  Game() {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(Game);
+};
+
+}  // namespace Tictactoe
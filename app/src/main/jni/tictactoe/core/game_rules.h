@@ -0,0 +1,201 @@
+////
+// game_rules.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/util/bits.h"
+
+namespace Tictactoe {
+
+// Rulesets for GameState.  Each one gives:
+//
+//   kWidth, kHeight  The board size, at most 16 spaces.
+//   kK               How many marks in a row make a line.
+//   kMisere          Completing a line loses rather than wins.
+//   kWrap            Lines continue off one edge of the board onto the
+//                    opposite one.
+//
+// Everything derived from them is worked out at compile time, so each
+// ruleset gets its own fully specialized game code.  Add new rulesets to the
+// Variant enum and Game::Create() to make them playable.
+struct ClassicRules {
+  static const int kWidth = 3;
+  static const int kHeight = 3;
+  static const int kK = 3;
+  static const bool kMisere = false;
+  static const bool kWrap = false;
+};
+
+struct MisereRules {
+  static const int kWidth = 3;
+  static const int kHeight = 3;
+  static const int kK = 3;
+  static const bool kMisere = true;
+  static const bool kWrap = false;
+};
+
+struct FourByFourRules {
+  static const int kWidth = 4;
+  static const int kHeight = 4;
+  static const int kK = 4;
+  static const bool kMisere = false;
+  static const bool kWrap = false;
+};
+
+struct WrapRules {
+  static const int kWidth = 4;
+  static const int kHeight = 4;
+  static const int kK = 4;
+  static const bool kMisere = false;
+  static const bool kWrap = true;
+};
+
+////
+// Line tables
+////
+
+// Directions a line can run in: across, down, and both diagonals.
+constexpr int kLineDirections[4][2] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}};
+
+// Every line on the board.  Large enough for any ruleset, with |count| used.
+template <typename Rules>
+struct LineList {
+  int count;
+  uint16_t masks[4 * Rules::kWidth * Rules::kHeight];
+};
+
+// Return the mask of the k spaces from (|x|, |y|) stepping by (|dx|, |dy|),
+// or 0 if they don't make a line.
+template <typename Rules>
+constexpr uint16_t GetLineMask(int x, int y, int dx, int dy) {
+  uint16_t mask = 0;
+  for (int i = 0; i < Rules::kK; ++i) {
+    int line_x = x + dx * i;
+    int line_y = y + dy * i;
+    if (Rules::kWrap) {
+      line_x = (line_x % Rules::kWidth + Rules::kWidth) % Rules::kWidth;
+      line_y = (line_y % Rules::kHeight + Rules::kHeight) % Rules::kHeight;
+    } else if (line_x < 0 || line_x >= Rules::kWidth || line_y < 0 ||
+               line_y >= Rules::kHeight) {
+      return 0;
+    }
+    mask |= 1 << (line_y * Rules::kWidth + line_x);
+  }
+  // A line that wraps back onto itself is too short.
+  return bits::CountSetBits(mask) == Rules::kK ? mask : 0;
+}
+
+template <typename Rules>
+constexpr LineList<Rules> ListLines() {
+  LineList<Rules> lines{};
+  for (const auto& direction : kLineDirections) {
+    for (int y = 0; y < Rules::kHeight; ++y) {
+      for (int x = 0; x < Rules::kWidth; ++x) {
+        const uint16_t mask =
+            GetLineMask<Rules>(x, y, direction[0], direction[1]);
+        if (!mask)
+          continue;
+
+        // Wrapped lines are found once from each of their spaces.
+        bool duplicate = false;
+        for (int i = 0; i < lines.count; ++i)
+          duplicate |= lines.masks[i] == mask;
+        if (!duplicate)
+          lines.masks[lines.count++] = mask;
+      }
+    }
+  }
+  return lines;
+}
+
+template <typename Rules>
+constexpr int CountLines() {
+  return ListLines<Rules>().count;
+}
+
+template <typename Rules>
+struct LineTable {
+  uint16_t masks[CountLines<Rules>()];
+};
+
+template <typename Rules>
+constexpr LineTable<Rules> GenerateLineTable() {
+  const LineList<Rules> lines = ListLines<Rules>();
+  LineTable<Rules> table{};
+  for (int i = 0; i < lines.count; ++i)
+    table.masks[i] = lines.masks[i];
+  return table;
+}
+
+// Return the most lines any one space is on.
+template <typename Rules>
+constexpr int CountMaxSpaceLines() {
+  const LineList<Rules> lines = ListLines<Rules>();
+  int max_count = 0;
+  for (int space = 0; space < Rules::kWidth * Rules::kHeight; ++space) {
+    int count = 0;
+    for (int i = 0; i < lines.count; ++i)
+      count += (lines.masks[i] >> space) & 1;
+    if (count > max_count)
+      max_count = count;
+  }
+  return max_count;
+}
+
+// The lines through each space.  Spaces on fewer lines than the most repeat
+// their first line, so every space checks the same number and the check can
+// be unrolled.
+template <typename Rules>
+struct SpaceLineTable {
+  uint16_t masks[Rules::kWidth * Rules::kHeight][CountMaxSpaceLines<Rules>()];
+};
+
+template <typename Rules>
+constexpr SpaceLineTable<Rules> GenerateSpaceLineTable() {
+  const LineList<Rules> lines = ListLines<Rules>();
+  const int max_count = CountMaxSpaceLines<Rules>();
+  SpaceLineTable<Rules> table{};
+  for (int space = 0; space < Rules::kWidth * Rules::kHeight; ++space) {
+    int count = 0;
+    for (int i = 0; i < lines.count; ++i) {
+      if ((lines.masks[i] >> space) & 1)
+        table.masks[space][count++] = lines.masks[i];
+    }
+    while (count < max_count) {
+      table.masks[space][count] = table.masks[space][0];
+      count++;
+    }
+  }
+  return table;
+}
+
+// One bit per mask, set if the mask contains a line.  Only built for boards
+// of up to 9 spaces, where it's 64 bytes and beats checking lines.
+template <typename Rules>
+struct HasLineTable {
+  static const int kNumSpaces = Rules::kWidth * Rules::kHeight;
+  static const bool kEnabled = kNumSpaces <= 9;
+
+  uint8_t bits[kEnabled ? (1 << kNumSpaces) / 8 : 1];
+};
+
+template <typename Rules>
+constexpr HasLineTable<Rules> GenerateHasLineTable() {
+  const LineList<Rules> lines = ListLines<Rules>();
+  HasLineTable<Rules> table{};
+  if (!HasLineTable<Rules>::kEnabled)
+    return table;
+  for (int mask = 0; mask < 1 << HasLineTable<Rules>::kNumSpaces; ++mask) {
+    for (int i = 0; i < lines.count; ++i) {
+      if ((mask & lines.masks[i]) == lines.masks[i]) {
+        table.bits[mask / 8] |= 1 << (mask % 8);
+        break;
+      }
+    }
+  }
+  return table;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,302 @@
+////
+// game_search.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "tictactoe/core/game_state.h"
+#include "tictactoe/core/move_analysis.h"
+#include "tictactoe/core/search_util.h"
+#include "tictactoe/core/transposition_table.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Tictactoe {
+
+struct GameSearchResult {
+  GameSearchResult() : move(-1), score(0), depth(0), nodes(0) {}
+
+  // The best space found, or -1 if the game is over.
+  int move;
+  // Score from the point of view of the player to move.
+  int score;
+  // The deepest fully searched iteration.
+  int depth;
+  int64_t nodes;
+};
+
+// The spaces of a board ordered by how many lines they're on, most first,
+// which is the order the search tries them in.
+template <typename Rules>
+struct MoveOrder {
+  int spaces[Rules::kWidth * Rules::kHeight];
+};
+
+template <typename Rules>
+constexpr MoveOrder<Rules> GenerateMoveOrder() {
+  const LineList<Rules> lines = ListLines<Rules>();
+  const int num_spaces = Rules::kWidth * Rules::kHeight;
+  int counts[num_spaces] = {};
+  for (int space = 0; space < num_spaces; ++space) {
+    for (int i = 0; i < lines.count; ++i)
+      counts[space] += (lines.masks[i] >> space) & 1;
+  }
+
+  // Insertion sort, keeping equal spaces in board order.
+  MoveOrder<Rules> order{};
+  for (int space = 0; space < num_spaces; ++space) {
+    int i = space;
+    for (; i > 0 && counts[order.spaces[i - 1]] < counts[space]; --i)
+      order.spaces[i] = order.spaces[i - 1];
+    order.spaces[i] = space;
+  }
+  return order;
+}
+
+// Negamax search with alpha-beta pruning, iterative deepening and a
+// transposition table, specialized for |Rules|.  Unlike MnkSearch it plays
+// every ruleset, including misère and wrapping lines.
+template <typename Rules>
+class GameSearch {
+ public:
+  typedef GameState<Rules> State;
+
+  // Scores at or above kWinScore - State::kNumSpaces are wins, the higher the
+  // sooner.
+  static const int kWinScore = 1 << 20;
+
+  // The transposition table holds 2^|table_bits| entries.
+  explicit GameSearch(int table_bits)
+      : table_(table_bits), nodes_(0), stopped_(false) {}
+  DISALLOW_COPY_AND_ASSIGN(GameSearch);
+
+  // Search for the best move for the player to move in |state|, for up to
+  // |max_time|, or until |cancel| is set if it isn't null.
+  GameSearchResult Search(const State& state,
+                          TimeInterval max_time,
+                          const std::atomic<bool>* cancel) {
+    deadline_.Start(max_time, cancel);
+    nodes_ = 0;
+    stopped_ = false;
+    table_.NewSearch();
+
+    GameSearchResult result;
+    if (state.game_over())
+      return result;
+
+    State search_state = state;
+    for (int depth = 1; depth <= state.EmptyCount(); ++depth) {
+      int move = -1;
+      const int score = SearchRoot(&search_state, depth, result.move, &move);
+      if (stopped_) {
+        // Keep the last complete iteration, unless there isn't one yet.
+        if (result.move == -1)
+          result.move = move;
+        break;
+      }
+
+      result.move = move;
+      result.score = score;
+      result.depth = depth;
+
+      // Stop once the result is known.
+      if (Scores::IsWin(score))
+        break;
+    }
+
+    table_.AddCounters(counters_);
+    counters_ = TranspositionTable::Counters();
+    result.nodes = nodes_;
+    return result;
+  }
+
+  // Solve every empty space of |state| with a full width search to the end
+  // of the game, sharing the transposition table between them, for up to
+  // |max_time| or until |cancel| is set.  Spaces that weren't solved in time
+  // are left unknown.
+  void Analyze(const State& state,
+               TimeInterval max_time,
+               const std::atomic<bool>* cancel,
+               MoveAnalysis* analysis) {
+    deadline_.Start(max_time, cancel);
+    nodes_ = 0;
+    stopped_ = false;
+    table_.NewSearch();
+    analysis->Reset(State::kNumSpaces);
+
+    if (!state.game_over()) {
+      State search_state = state;
+      const int empty_count = state.EmptyCount();
+      int moves[State::kNumSpaces];
+      const int count = GenerateMoves(search_state, -1, moves);
+      int solved = 0;
+      for (int i = 0; i < count && !stopped_; ++i) {
+        search_state.PlaceMark(moves[i]);
+        // Searching as deep as there are empty spaces is exact, and so is
+        // every table entry it can use.
+        const int score = -Negamax(&search_state, empty_count - 1,
+                                   -Scores::kInfinity, Scores::kInfinity, 1);
+        search_state.RemoveLastMark();
+        if (stopped_)
+          break;
+
+        MoveScore& move_score = analysis->scores[moves[i]];
+        if (!Scores::IsWin(score)) {
+          move_score = MoveScore(MoveScore::kResultDraw, empty_count);
+        } else if (score > 0) {
+          move_score = MoveScore(MoveScore::kResultWin, kWinScore - score);
+        } else {
+          move_score = MoveScore(MoveScore::kResultLoss, kWinScore + score);
+        }
+        solved++;
+      }
+      analysis->complete = solved == count;
+    }
+
+    table_.AddCounters(counters_);
+    counters_ = TranspositionTable::Counters();
+    analysis->nodes = nodes_;
+  }
+
+ private:
+  typedef SearchScores<kWinScore, State::kNumSpaces> Scores;
+
+  static constexpr MoveOrder<Rules> kMoveOrder = GenerateMoveOrder<Rules>();
+
+  // Each position has its own index, so a cheap mix of it makes a key.
+  static uint64_t Key(const State& state) {
+    return static_cast<uint64_t>(state.index()) * 0x9e3779b97f4a7c15ull;
+  }
+
+  // Heuristic value of the position for the player to move: the square of
+  // the marks in every line that only one player has entered.  Misère games
+  // aren't judged until the end.
+  static int Evaluate(const State& state) {
+    if (State::kMisere)
+      return 0;
+    const uint16_t x_mask = state.mask(kPlayerX);
+    const uint16_t o_mask = state.mask(kPlayerO);
+    int score = 0;
+    for (int i = 0; i < State::kNumLines; ++i) {
+      const int x_count = bits::CountSetBits(x_mask & State::LineMask(i));
+      const int o_count = bits::CountSetBits(o_mask & State::LineMask(i));
+      if (!o_count)
+        score += x_count * x_count;
+      else if (!x_count)
+        score -= o_count * o_count;
+    }
+    return state.turn() == kPlayerO ? -score : score;
+  }
+
+  int SearchRoot(State* state, int depth, int first_move, int* best_move) {
+    int moves[State::kNumSpaces];
+    const int count = GenerateMoves(*state, first_move, moves);
+
+    int alpha = -Scores::kInfinity;
+    *best_move = moves[0];
+    for (int i = 0; i < count; ++i) {
+      state->PlaceMark(moves[i]);
+      const int score =
+          -Negamax(state, depth - 1, -Scores::kInfinity, -alpha, 1);
+      state->RemoveLastMark();
+      if (stopped_)
+        break;
+
+      if (score > alpha) {
+        alpha = score;
+        *best_move = moves[i];
+      }
+    }
+    return alpha;
+  }
+
+  int Negamax(State* state, int depth, int alpha, int beta, int ply) {
+    nodes_++;
+    if (state->game_over()) {
+      if (state->winner() == kPlayerNone)
+        return 0;
+      // The player to move here is the one who didn't just play.
+      const Player mover = state->num_moves() % 2 ? kPlayerO : kPlayerX;
+      const int score = kWinScore - ply;
+      return state->winner() == mover ? score : -score;
+    }
+    if (ShouldStop())
+      return 0;
+    if (depth == 0)
+      return Evaluate(*state);
+
+    const uint64_t key = Key(*state);
+    TranspositionTable::Entry entry;
+    int score;
+    if (table_.Probe(key, &entry, &counters_) &&
+        Scores::ProbeCutoff(entry, depth, ply, &alpha, &beta, &score)) {
+      return score;
+    }
+
+    int moves[State::kNumSpaces];
+    const int count = GenerateMoves(*state, entry.move, moves);
+
+    const int original_alpha = alpha;
+    int best_score = -Scores::kInfinity;
+    int best_move = -1;
+    for (int i = 0; i < count; ++i) {
+      state->PlaceMark(moves[i]);
+      const int score = -Negamax(state, depth - 1, -beta, -alpha, ply + 1);
+      state->RemoveLastMark();
+      if (stopped_)
+        return 0;
+
+      if (score > best_score) {
+        best_score = score;
+        best_move = moves[i];
+      }
+      alpha = std::max(alpha, score);
+      if (alpha >= beta)
+        break;
+    }
+
+    Scores::FillEntry(best_score, best_move, depth, ply, original_alpha, beta,
+                      &entry);
+    table_.Store(key, entry, &counters_);
+    return best_score;
+  }
+
+  // Fill |moves| with the empty spaces, |first_move| first if it's one of
+  // them, and return the number of moves.
+  static int GenerateMoves(const State& state, int first_move, int* moves) {
+    int count = 0;
+    if (first_move >= 0 && state.IsEmpty(first_move))
+      moves[count++] = first_move;
+    for (int i = 0; i < State::kNumSpaces; ++i) {
+      const int space = kMoveOrder.spaces[i];
+      if (space != first_move && state.IsEmpty(space))
+        moves[count++] = space;
+    }
+    return count;
+  }
+
+  bool ShouldStop() {
+    if (!stopped_ && nodes_ % kTimeCheckInterval == 0)
+      stopped_ = deadline_.Expired();
+    return stopped_;
+  }
+
+  TranspositionTable table_;
+  TranspositionTable::Counters counters_;
+
+  SearchDeadline deadline_;
+  int64_t nodes_;
+  bool stopped_;
+};
+
+template <typename Rules>
+const int GameSearch<Rules>::kWinScore;
+template <typename Rules>
+constexpr MoveOrder<Rules> GameSearch<Rules>::kMoveOrder;
+
+}  // namespace Tictactoe
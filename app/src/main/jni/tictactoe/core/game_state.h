@@ -0,0 +1,247 @@
+////
+// game_state.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/logging.h"
+#include "base/util/bits.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/game_rules.h"
+
+namespace Tictactoe {
+
+template <typename Rules>
+struct PowerOf3Table {
+  int values[Rules::kWidth * Rules::kHeight];
+};
+
+template <typename Rules>
+constexpr PowerOf3Table<Rules> GeneratePowerOf3Table() {
+  PowerOf3Table<Rules> table{};
+  int power = 1;
+  for (int space = 0; space < Rules::kWidth * Rules::kHeight; ++space) {
+    table.values[space] = power;
+    power *= 3;
+  }
+  return table;
+}
+
+// A position under |Rules| (see game_rules.h), stored as one mask per
+// player.  Bit |i| of a mask is set when that player has a mark in space
+// |i|, numbered left to right, top to bottom.  The moves that led to the
+// position are kept in order, so they can be taken back without copying the
+// state.
+template <typename Rules>
+class GameState {
+ public:
+  static const int kWidth = Rules::kWidth;
+  static const int kHeight = Rules::kHeight;
+  static const int kLayers = 1;
+  static const int kK = Rules::kK;
+  static const bool kMisere = Rules::kMisere;
+  static const int kNumSpaces = kWidth * kHeight;
+  static const int kNumLines = CountLines<Rules>();
+  static const uint16_t kFullMask = (1 << kNumSpaces) - 1;
+
+  static_assert(kNumSpaces <= 16, "Masks are 16 bits");
+  static_assert(kK <= kWidth || kK <= kHeight, "Lines must fit the board");
+
+  // The number of base 3 position indices, 3^kNumSpaces.
+  static const int kNumIndices =
+      3 * GeneratePowerOf3Table<Rules>().values[kNumSpaces - 1];
+
+  // The mask of line |i|, for |i| below kNumLines.
+  static constexpr uint16_t LineMask(int i) { return kLines.masks[i]; }
+
+  // The value of |space|'s digit in a position index.
+  static constexpr int PowerOf3(int space) {
+    return kPowersOf3.values[space];
+  }
+
+  // Return true if |mask| contains a complete line.
+  static constexpr bool HasLine(uint16_t mask) {
+    for (int i = 0; i < kNumLines; ++i) {
+      if ((mask & kLines.masks[i]) == kLines.masks[i])
+        return true;
+    }
+    return false;
+  }
+
+  GameState()
+      : x_mask_(0),
+        o_mask_(0),
+        index_(0),
+        turn_(kPlayerX),
+        winner_(kPlayerNone),
+        num_moves_(0) {}
+
+  // The player to move, or kPlayerNone once the game is over.
+  Player turn() const { return turn_; }
+  // The winning player.  kPlayerNone while playing or after a draw.
+  Player winner() const { return winner_; }
+  bool game_over() const { return turn_ == kPlayerNone; }
+
+  // The position as a base 3 number, where space |i| contributes its Player
+  // value times 3^i.
+  int index() const { return index_; }
+
+  // The number of marks placed, and the space of each in the order played.
+  int num_moves() const { return num_moves_; }
+  int move(int i) const { return moves_[i]; }
+
+  uint16_t mask(Player player) const {
+    switch (player) {
+      case kPlayerX:
+        return x_mask_;
+      case kPlayerO:
+        return o_mask_;
+      case kPlayerNone:
+        return empty_mask();
+    }
+    NOTREACHED();
+    return 0;
+  }
+  uint16_t empty_mask() const { return ~(x_mask_ | o_mask_) & kFullMask; }
+
+  Player Get(int space) const {
+    DCHECK_GE(space, 0);
+    DCHECK_LT(space, kNumSpaces);
+    if ((x_mask_ >> space) & 1)
+      return kPlayerX;
+    if ((o_mask_ >> space) & 1)
+      return kPlayerO;
+    return kPlayerNone;
+  }
+  bool IsEmpty(int space) const { return (empty_mask() >> space) & 1; }
+  int EmptyCount() const { return bits::CountSetBits(empty_mask()); }
+
+  // Place a mark for the player to move in |space|, then either advance the
+  // turn or end the game.
+  void PlaceMark(int space) {
+    DCHECK_NE(turn_, kPlayerNone);
+    DCHECK(IsEmpty(space));
+
+    uint16_t* marks = turn_ == kPlayerX ? &x_mask_ : &o_mask_;
+    *marks |= 1 << space;
+    index_ += turn_ * kPowersOf3.values[space];
+    moves_[num_moves_++] = space;
+
+    const Player opponent = turn_ == kPlayerX ? kPlayerO : kPlayerX;
+    if (CompletesLine(*marks, space)) {
+      winner_ = kMisere ? opponent : turn_;
+      turn_ = kPlayerNone;
+    } else if (!empty_mask()) {
+      // No spaces remain, it's a draw.
+      turn_ = kPlayerNone;
+    } else {
+      turn_ = opponent;
+    }
+  }
+
+  // Take back the last mark placed, and return its space.  The player who
+  // placed it is to move again.
+  int RemoveLastMark() {
+    DCHECK_GT(num_moves_, 0);
+
+    const int space = moves_[--num_moves_];
+    const Player player = Get(space);
+    uint16_t* marks = player == kPlayerX ? &x_mask_ : &o_mask_;
+    *marks &= ~(1 << space);
+    index_ -= player * kPowersOf3.values[space];
+
+    // The game can only have ended on the last move, so taking it back
+    // always returns to play.
+    turn_ = player;
+    winner_ = kPlayerNone;
+    return space;
+  }
+
+  // Return a mask of the empty spaces that would complete a line for
+  // |player|.
+  uint16_t WinningMoves(Player player) const {
+    DCHECK_NE(player, kPlayerNone);
+    const uint16_t marks = mask(player);
+    const uint16_t empty = empty_mask();
+
+    uint16_t moves = 0;
+    for (int i = 0; i < kNumLines; ++i) {
+      // The line is a threat if exactly one of its spaces is not ours, and
+      // that space is empty.
+      const uint16_t missing = kLines.masks[i] & ~marks;
+      if (!(missing & (missing - 1)))
+        moves |= missing & empty;
+    }
+    return moves;
+  }
+
+  // Return the lowest space that completes a line for |player|, or -1.
+  int FindWinningMove(Player player) const {
+    const uint16_t moves = WinningMoves(player);
+    if (!moves)
+      return -1;
+    return bits::FindFirstSet(moves);
+  }
+
+ private:
+  static constexpr LineTable<Rules> kLines = GenerateLineTable<Rules>();
+  static constexpr SpaceLineTable<Rules> kSpaceLines =
+      GenerateSpaceLineTable<Rules>();
+  static constexpr HasLineTable<Rules> kHasLine =
+      GenerateHasLineTable<Rules>();
+  static constexpr PowerOf3Table<Rules> kPowersOf3 =
+      GeneratePowerOf3Table<Rules>();
+  static const int kMaxSpaceLines = CountMaxSpaceLines<Rules>();
+
+  // Return true if |marks| has a line through |space|, the newest mark.
+  static bool CompletesLine(uint16_t marks, int space) {
+    if (HasLineTable<Rules>::kEnabled)
+      return (kHasLine.bits[marks / 8] >> (marks % 8)) & 1;
+    bool complete = false;
+    for (int i = 0; i < kMaxSpaceLines; ++i) {
+      const uint16_t line = kSpaceLines.masks[space][i];
+      complete |= (marks & line) == line;
+    }
+    return complete;
+  }
+
+  uint16_t x_mask_;
+  uint16_t o_mask_;
+  int index_;
+  Player turn_;
+  Player winner_;
+  int8_t num_moves_;
+  int8_t moves_[kNumSpaces];
+};
+
+template <typename Rules>
+const int GameState<Rules>::kWidth;
+template <typename Rules>
+const int GameState<Rules>::kHeight;
+template <typename Rules>
+const int GameState<Rules>::kLayers;
+template <typename Rules>
+const int GameState<Rules>::kK;
+template <typename Rules>
+const bool GameState<Rules>::kMisere;
+template <typename Rules>
+const int GameState<Rules>::kNumSpaces;
+template <typename Rules>
+const int GameState<Rules>::kNumLines;
+template <typename Rules>
+const uint16_t GameState<Rules>::kFullMask;
+template <typename Rules>
+const int GameState<Rules>::kNumIndices;
+template <typename Rules>
+const int GameState<Rules>::kMaxSpaceLines;
+template <typename Rules>
+constexpr LineTable<Rules> GameState<Rules>::kLines;
+template <typename Rules>
+constexpr SpaceLineTable<Rules> GameState<Rules>::kSpaceLines;
+template <typename Rules>
+constexpr HasLineTable<Rules> GameState<Rules>::kHasLine;
+template <typename Rules>
+constexpr PowerOf3Table<Rules> GameState<Rules>::kPowersOf3;
+
+}  // namespace Tictactoe
@@ -0,0 +1,199 @@
+////
+// game_status.cpp
+////
+
+#include "tictactoe/core/game_status.h"
+
+#if defined(__SSE2__)
+#define GAME_STATUS_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+// AVX2 is compiled per function and picked at runtime.
+#define GAME_STATUS_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GAME_STATUS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Tictactoe {
+
+namespace {
+const int kNumLines = TictactoeState::kNumLines;
+
+// Each vector version works on 16 bit lanes, one position per lane: a lane is
+// all ones where a player's mask covers a line, then the statuses are picked
+// with masks and narrowed to bytes.
+
+#if GAME_STATUS_SSE2
+__m128i StatusSse2(__m128i x, __m128i o) {
+  __m128i x_wins = _mm_setzero_si128();
+  __m128i o_wins = _mm_setzero_si128();
+  for (int i = 0; i < kNumLines; ++i) {
+    const __m128i line = _mm_set1_epi16(TictactoeState::LineMask(i));
+    x_wins =
+        _mm_or_si128(x_wins, _mm_cmpeq_epi16(_mm_and_si128(x, line), line));
+    o_wins =
+        _mm_or_si128(o_wins, _mm_cmpeq_epi16(_mm_and_si128(o, line), line));
+  }
+  const __m128i full = _mm_cmpeq_epi16(
+      _mm_or_si128(x, o), _mm_set1_epi16(TictactoeState::kFullMask));
+
+  __m128i status = _mm_and_si128(full, _mm_set1_epi16(kGameDraw));
+  status = _mm_or_si128(_mm_andnot_si128(o_wins, status),
+                        _mm_and_si128(o_wins, _mm_set1_epi16(kGameOWins)));
+  status = _mm_or_si128(_mm_andnot_si128(x_wins, status),
+                        _mm_and_si128(x_wins, _mm_set1_epi16(kGameXWins)));
+  return status;
+}
+
+// 16 positions at a time.
+int GetGameStatusesSse2(const uint16_t* x_masks,
+                        const uint16_t* o_masks,
+                        int count,
+                        GameStatus* statuses) {
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i* x = reinterpret_cast<const __m128i*>(x_masks + i);
+    const __m128i* o = reinterpret_cast<const __m128i*>(o_masks + i);
+    const __m128i low = StatusSse2(_mm_loadu_si128(x), _mm_loadu_si128(o));
+    const __m128i high =
+        StatusSse2(_mm_loadu_si128(x + 1), _mm_loadu_si128(o + 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(statuses + i),
+                     _mm_packus_epi16(low, high));
+  }
+  return i;
+}
+#endif
+
+#if GAME_STATUS_AVX2
+__attribute__((target("avx2"))) __m256i StatusAvx2(__m256i x, __m256i o) {
+  __m256i x_wins = _mm256_setzero_si256();
+  __m256i o_wins = _mm256_setzero_si256();
+  for (int i = 0; i < kNumLines; ++i) {
+    const __m256i line = _mm256_set1_epi16(TictactoeState::LineMask(i));
+    x_wins = _mm256_or_si256(
+        x_wins, _mm256_cmpeq_epi16(_mm256_and_si256(x, line), line));
+    o_wins = _mm256_or_si256(
+        o_wins, _mm256_cmpeq_epi16(_mm256_and_si256(o, line), line));
+  }
+  const __m256i full = _mm256_cmpeq_epi16(
+      _mm256_or_si256(x, o), _mm256_set1_epi16(TictactoeState::kFullMask));
+
+  __m256i status = _mm256_and_si256(full, _mm256_set1_epi16(kGameDraw));
+  status = _mm256_blendv_epi8(status, _mm256_set1_epi16(kGameOWins), o_wins);
+  status = _mm256_blendv_epi8(status, _mm256_set1_epi16(kGameXWins), x_wins);
+  return status;
+}
+
+// 32 positions at a time.
+__attribute__((target("avx2"))) int GetGameStatusesAvx2(
+    const uint16_t* x_masks,
+    const uint16_t* o_masks,
+    int count,
+    GameStatus* statuses) {
+  int i = 0;
+  for (; i + 32 <= count; i += 32) {
+    const __m256i* x = reinterpret_cast<const __m256i*>(x_masks + i);
+    const __m256i* o = reinterpret_cast<const __m256i*>(o_masks + i);
+    const __m256i low =
+        StatusAvx2(_mm256_loadu_si256(x), _mm256_loadu_si256(o));
+    const __m256i high =
+        StatusAvx2(_mm256_loadu_si256(x + 1), _mm256_loadu_si256(o + 1));
+    // Packing works within each 128 bit half, so put the quarters back in
+    // order afterwards.
+    const __m256i packed = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(statuses + i), packed);
+  }
+  return i;
+}
+
+bool HasAvx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+#endif
+
+#if GAME_STATUS_NEON
+uint16x8_t StatusNeon(uint16x8_t x, uint16x8_t o) {
+  uint16x8_t x_wins = vdupq_n_u16(0);
+  uint16x8_t o_wins = vdupq_n_u16(0);
+  for (int i = 0; i < kNumLines; ++i) {
+    const uint16x8_t line = vdupq_n_u16(TictactoeState::LineMask(i));
+    x_wins = vorrq_u16(x_wins, vceqq_u16(vandq_u16(x, line), line));
+    o_wins = vorrq_u16(o_wins, vceqq_u16(vandq_u16(o, line), line));
+  }
+  const uint16x8_t full =
+      vceqq_u16(vorrq_u16(x, o), vdupq_n_u16(TictactoeState::kFullMask));
+
+  uint16x8_t status = vandq_u16(full, vdupq_n_u16(kGameDraw));
+  status = vbslq_u16(o_wins, vdupq_n_u16(kGameOWins), status);
+  status = vbslq_u16(x_wins, vdupq_n_u16(kGameXWins), status);
+  return status;
+}
+
+// 16 positions at a time.
+int GetGameStatusesNeon(const uint16_t* x_masks,
+                        const uint16_t* o_masks,
+                        int count,
+                        GameStatus* statuses) {
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const uint16x8_t low =
+        StatusNeon(vld1q_u16(x_masks + i), vld1q_u16(o_masks + i));
+    const uint16x8_t high =
+        StatusNeon(vld1q_u16(x_masks + i + 8), vld1q_u16(o_masks + i + 8));
+    vst1q_u8(reinterpret_cast<uint8_t*>(statuses + i),
+             vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+  }
+  return i;
+}
+#endif
+}
+
+void GetGameStatuses(const uint16_t* x_masks,
+                     const uint16_t* o_masks,
+                     int count,
+                     GameStatus* statuses) {
+  int done = 0;
+#if GAME_STATUS_AVX2
+  if (HasAvx2())
+    done = GetGameStatusesAvx2(x_masks, o_masks, count, statuses);
+#endif
+#if GAME_STATUS_SSE2
+  done += GetGameStatusesSse2(x_masks + done, o_masks + done, count - done,
+                              statuses + done);
+#elif GAME_STATUS_NEON
+  done = GetGameStatusesNeon(x_masks, o_masks, count, statuses);
+#endif
+
+  // Finish whatever doesn't fill a vector.
+  GetGameStatusesScalar(x_masks + done, o_masks + done, count - done,
+                        statuses + done);
+}
+
+void GetGameStatusesScalar(const uint16_t* x_masks,
+                           const uint16_t* o_masks,
+                           int count,
+                           GameStatus* statuses) {
+  for (int i = 0; i < count; ++i)
+    statuses[i] = GetGameStatus(x_masks[i], o_masks[i]);
+}
+
+const char* GetGameStatusesImplementation() {
+#if GAME_STATUS_AVX2
+  if (HasAvx2())
+    return "AVX2";
+#endif
+#if GAME_STATUS_SSE2
+  return "SSE2";
+#elif GAME_STATUS_NEON
+  return "NEON";
+#else
+  return "scalar";
+#endif
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,49 @@
+////
+// game_status.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+namespace Tictactoe {
+
+// The result of a position.  The wins match the winning Player's value.
+enum GameStatus : uint8_t {
+  kGameOngoing = 0,
+  kGameXWins = kPlayerX,
+  kGameOWins = kPlayerO,
+  kGameDraw = 3,
+};
+
+// Return the status of the position with the given player masks.  If both
+// players somehow have a line, X wins.
+inline GameStatus GetGameStatus(uint16_t x_mask, uint16_t o_mask) {
+  if (TictactoeState::HasLine(x_mask))
+    return kGameXWins;
+  if (TictactoeState::HasLine(o_mask))
+    return kGameOWins;
+  if ((x_mask | o_mask) == TictactoeState::kFullMask)
+    return kGameDraw;
+  return kGameOngoing;
+}
+
+// Fill |statuses| with the status of |count| positions, where position |i| is
+// |x_masks[i]| and |o_masks[i]|.  Uses AVX2 or SSE2 on x86 and NEON on ARM,
+// checking 8 to 32 positions at a time.
+void GetGameStatuses(const uint16_t* x_masks,
+                     const uint16_t* o_masks,
+                     int count,
+                     GameStatus* statuses);
+
+// The same, one position at a time.
+void GetGameStatusesScalar(const uint16_t* x_masks,
+                           const uint16_t* o_masks,
+                           int count,
+                           GameStatus* statuses);
+
+// The name of the instruction set GetGameStatuses() uses on this processor.
+const char* GetGameStatusesImplementation();
+
+}  // namespace Tictactoe
@@ -0,0 +1,279 @@
+////
+// gomoku_board.cpp
+////
+
+#include "tictactoe/core/gomoku_board.h"
+
+#include "base/util/random.h"
+
+#include <string.h>
+#include <algorithm>
+
+namespace Tictactoe {
+
+namespace {
+// Fixed so that hashes are stable between runs.
+const uint32_t kZobristSeed = 0x676f6d6b;
+
+// The spaces on either side of the one being classified, four each way.
+const int kReach = 4;
+const int kWindowSize = 2 * kReach + 1;
+
+// Window values while classifying.
+const int8_t kWindowEmpty = 0;
+const int8_t kWindowOwn = 1;
+const int8_t kWindowBlocked = 2;
+
+// Return the length of the run of own marks through the center.
+int CenterRun(const int8_t* window) {
+  int run = 1;
+  for (int i = kReach - 1; i >= 0 && window[i] == kWindowOwn; --i)
+    run++;
+  for (int i = kReach + 1; i < kWindowSize && window[i] == kWindowOwn; ++i)
+    run++;
+  return run;
+}
+
+// Return the number of empty spaces that would make five through the
+// center.
+int CountFiveSpaces(int8_t* window) {
+  int count = 0;
+  for (int i = 0; i < kWindowSize; ++i) {
+    if (window[i] != kWindowEmpty)
+      continue;
+    window[i] = kWindowOwn;
+    if (CenterRun(window) >= GomokuBoard::kK)
+      count++;
+    window[i] = kWindowEmpty;
+  }
+  return count;
+}
+
+// Return the shape a mark in the center of a window makes.  Bit |i| of
+// |own| and |blocked| is the |i|th space out from the center, the four
+// before it and then the four after it.  Walls count as blocked.
+GomokuBoard::Shape ClassifyWindow(int own, int blocked) {
+  int8_t window[kWindowSize];
+  for (int i = 0; i < 2 * kReach; ++i) {
+    const int index = i < kReach ? i : i + 1;
+    if ((own >> i) & 1)
+      window[index] = kWindowOwn;
+    else if ((blocked >> i) & 1)
+      window[index] = kWindowBlocked;
+    else
+      window[index] = kWindowEmpty;
+  }
+  window[kReach] = kWindowOwn;
+
+  if (CenterRun(window) >= GomokuBoard::kK)
+    return GomokuBoard::kShapeFive;
+  const int five_spaces = CountFiveSpaces(window);
+  if (five_spaces >= 2)
+    return GomokuBoard::kShapeOpenFour;
+  if (five_spaces == 1)
+    return GomokuBoard::kShapeFour;
+
+  // Look one more mark ahead for threes.
+  GomokuBoard::Shape shape = GomokuBoard::kShapeNone;
+  for (int i = 0; i < kWindowSize; ++i) {
+    if (window[i] != kWindowEmpty)
+      continue;
+    window[i] = kWindowOwn;
+    const int next_five_spaces = CountFiveSpaces(window);
+    window[i] = kWindowEmpty;
+    if (next_five_spaces >= 2)
+      return GomokuBoard::kShapeOpenThree;
+    if (next_five_spaces == 1)
+      shape = GomokuBoard::kShapeThree;
+  }
+  return shape;
+}
+
+// Shared by every board.  Built on first use, in about as long as a frame.
+struct Tables {
+  Tables();
+
+  // Indexed by a window's own marks, plus its blocked spaces shifted left 8.
+  uint8_t shapes[1 << (4 * kReach)];
+  uint64_t zobrist_keys[2][GomokuBoard::kNumSpaces];
+};
+
+Tables::Tables() {
+  const int mask = (1 << (2 * kReach)) - 1;
+  for (int index = 0; index < (1 << (4 * kReach)); ++index) {
+    const int own = index & mask;
+    const int blocked = index >> (2 * kReach);
+    shapes[index] =
+        own & blocked ? GomokuBoard::kShapeNone : ClassifyWindow(own, blocked);
+  }
+
+  Random random(kZobristSeed);
+  for (auto& player_keys : zobrist_keys) {
+    for (auto& key : player_keys)
+      key = (static_cast<uint64_t>(random.Next()) << 32) | random.Next();
+  }
+}
+
+const Tables& GetTables() {
+  static const Tables tables;
+  return tables;
+}
+}
+
+const int GomokuBoard::kWidth;
+const int GomokuBoard::kHeight;
+const int GomokuBoard::kLayers;
+const int GomokuBoard::kK;
+const int GomokuBoard::kNumSpaces;
+const int GomokuBoard::kNumDirections;
+const int GomokuBoard::kPadding;
+const int GomokuBoard::kStride;
+const int GomokuBoard::kNumCells;
+const uint8_t GomokuBoard::kWall;
+const int GomokuBoard::kDirectionSteps[kNumDirections] = {
+    1, kStride, kStride + 1, kStride - 1,
+};
+
+GomokuBoard::GomokuBoard()
+    : hash_(0), turn_(kPlayerX), winner_(kPlayerNone), num_moves_(0) {
+  memset(cells_, kWall, sizeof(cells_));
+  memset(shapes_, kShapeNone, sizeof(shapes_));
+  for (int space = 0; space < kNumSpaces; ++space)
+    cells_[ToCell(space)] = kPlayerNone;
+
+  // Every space starts with the shapes of an empty board.  Looking up the
+  // shapes around each space covers all of them.
+  for (int space = 0; space < kNumSpaces; ++space)
+    UpdateShapes(space);
+}
+
+bool GomokuBoard::HasNeighbor(int space, int distance) const {
+  const int x = space % kWidth;
+  const int y = space / kWidth;
+  const int min_x = std::max(x - distance, 0);
+  const int max_x = std::min(x + distance, kWidth - 1);
+  const int min_y = std::max(y - distance, 0);
+  const int max_y = std::min(y + distance, kHeight - 1);
+  for (int ny = min_y; ny <= max_y; ++ny) {
+    for (int nx = min_x; nx <= max_x; ++nx) {
+      if (cells_[ToCell(ny * kWidth + nx)] != kPlayerNone)
+        return true;
+    }
+  }
+  return false;
+}
+
+GomokuBoard::Shape GomokuBoard::GetBestShape(Player player, int space) const {
+  const uint8_t* shapes = shapes_[player - kPlayerX][ToCell(space)];
+  return static_cast<Shape>(
+      std::max(std::max(shapes[0], shapes[1]), std::max(shapes[2], shapes[3])));
+}
+
+bool GomokuBoard::IsWinningThreat(Player player, int space) const {
+  const uint8_t* shapes = shapes_[player - kPlayerX][ToCell(space)];
+  int fours = 0;
+  int open_threes = 0;
+  for (int direction = 0; direction < kNumDirections; ++direction) {
+    if (shapes[direction] >= kShapeOpenFour)
+      return true;
+    if (shapes[direction] == kShapeFour)
+      fours++;
+    else if (shapes[direction] == kShapeOpenThree)
+      open_threes++;
+  }
+  return fours >= 2 || (fours && open_threes);
+}
+
+int GomokuBoard::FindShapes(Player player,
+                            Shape min_shape,
+                            int* spaces) const {
+  int count = 0;
+  for (int space = 0; space < kNumSpaces; ++space) {
+    if (IsEmpty(space) && GetBestShape(player, space) >= min_shape)
+      spaces[count++] = space;
+  }
+  return count;
+}
+
+void GomokuBoard::PlaceMark(int space) {
+  DCHECK_NE(turn_, kPlayerNone);
+  DCHECK(IsEmpty(space));
+
+  const Player player = turn_;
+  const bool completes_line = GetBestShape(player, space) == kShapeFive;
+  cells_[ToCell(space)] = player;
+  hash_ ^= GetTables().zobrist_keys[player - kPlayerX][space];
+  moves_[num_moves_++] = space;
+  UpdateShapes(space);
+
+  if (completes_line) {
+    winner_ = player;
+    turn_ = kPlayerNone;
+  } else if (num_moves_ == kNumSpaces) {
+    // No spaces remain, it's a draw.
+    turn_ = kPlayerNone;
+  } else {
+    turn_ = player == kPlayerX ? kPlayerO : kPlayerX;
+  }
+}
+
+int GomokuBoard::RemoveLastMark() {
+  DCHECK_GT(num_moves_, 0);
+
+  const int space = moves_[--num_moves_];
+  const Player player = Get(space);
+  cells_[ToCell(space)] = kPlayerNone;
+  hash_ ^= GetTables().zobrist_keys[player - kPlayerX][space];
+  UpdateShapes(space);
+
+  // The game can only have ended on the last move, so taking it back always
+  // returns to play.
+  turn_ = player;
+  winner_ = kPlayerNone;
+  return space;
+}
+
+// private:
+void GomokuBoard::UpdateShapes(int space) {
+  const uint8_t* table = GetTables().shapes;
+  const int center = ToCell(space);
+  const int window_mask = (1 << kReach) - 1;
+  for (int direction = 0; direction < kNumDirections; ++direction) {
+    const int step = kDirectionSteps[direction];
+
+    // Read the line through |space| once, as masks with bit |i| for the cell
+    // |i| - kPadding steps away.  Every window along it is a slice of these.
+    int x_marks = 0;
+    int o_marks = 0;
+    int walls = 0;
+    for (int i = 0; i <= 2 * kPadding; ++i) {
+      const uint8_t value = cells_[center + (i - kPadding) * step];
+      x_marks |= (value == kPlayerX) << i;
+      o_marks |= (value == kPlayerO) << i;
+      walls |= (value == kWall) << i;
+    }
+
+    for (int offset = -kReach; offset <= kReach; ++offset) {
+      const int cell = center + offset * step;
+      if (!offset || cells_[cell] == kWall)
+        continue;
+
+      // The four cells before |cell| and the four after it.
+      const int before = kPadding + offset - kReach;
+      const int after = kPadding + offset + 1;
+      const int x_window = ((x_marks >> before) & window_mask) |
+                           ((x_marks >> after) & window_mask) << kReach;
+      const int o_window = ((o_marks >> before) & window_mask) |
+                           ((o_marks >> after) & window_mask) << kReach;
+      const int wall_window = ((walls >> before) & window_mask) |
+                              ((walls >> after) & window_mask) << kReach;
+      const int shift = 2 * kReach;
+      shapes_[0][cell][direction] = table[x_window | (o_window | wall_window)
+                                                         << shift];
+      shapes_[1][cell][direction] = table[o_window | (x_window | wall_window)
+                                                         << shift];
+    }
+  }
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,128 @@
+////
+// gomoku_board.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/logging.h"
+#include "tictactoe/constants.h"
+
+namespace Tictactoe {
+
+// A 15x15 board where the first player to get five or more marks in a row,
+// column or diagonal wins.  Spaces are numbered left to right, top to
+// bottom.
+//
+// For every empty space, the board knows the shape each player would make in
+// each direction by playing there.  Shapes come from a lookup table indexed
+// by the four spaces on either side, and a move only changes the shapes of
+// the 32 spaces it lines up with, so they're kept up to date as marks are
+// placed and removed.
+class GomokuBoard {
+ public:
+  static const int kWidth = 15;
+  static const int kHeight = 15;
+  static const int kLayers = 1;
+  static const int kK = 5;
+  static const int kNumSpaces = kWidth * kHeight;
+  // Across, down, and both diagonals.
+  static const int kNumDirections = 4;
+
+  // What a mark makes along one line, weakest first.
+  enum Shape : uint8_t {
+    kShapeNone,
+    // One more mark makes a four.
+    kShapeThree,
+    // One more mark makes an open four.
+    kShapeOpenThree,
+    // One space left makes five.
+    kShapeFour,
+    // Two or more spaces make five, so it can't be blocked.
+    kShapeOpenFour,
+    kShapeFive,
+  };
+
+  GomokuBoard();
+
+  // The player to move, or kPlayerNone once the game is over.
+  Player turn() const { return turn_; }
+  // The winning player.  kPlayerNone while playing or after a draw.
+  Player winner() const { return winner_; }
+  bool game_over() const { return turn_ == kPlayerNone; }
+
+  // The number of marks placed, and the space of each in the order played.
+  int num_moves() const { return num_moves_; }
+  int move(int i) const { return moves_[i]; }
+
+  // Zobrist hash of the marks on the board.
+  uint64_t hash() const { return hash_; }
+
+  Player Get(int space) const {
+    DCHECK_GE(space, 0);
+    DCHECK_LT(space, kNumSpaces);
+    return static_cast<Player>(cells_[ToCell(space)]);
+  }
+  bool IsEmpty(int space) const { return Get(space) == kPlayerNone; }
+
+  // Return true if any mark is within |distance| spaces of |space|.
+  bool HasNeighbor(int space, int distance) const;
+
+  // The shape |player| would make along |direction| by marking |space|.
+  // Only meaningful while |space| is empty.
+  Shape GetShape(Player player, int space, int direction) const {
+    return static_cast<Shape>(
+        shapes_[player - kPlayerX][ToCell(space)][direction]);
+  }
+
+  // The strongest shape |player| would make in any direction by marking
+  // |space|.
+  Shape GetBestShape(Player player, int space) const;
+
+  // Return true if marking |space| leaves |player| threatening to win in
+  // more than one way: an open four, two fours, or a four and an open three.
+  bool IsWinningThreat(Player player, int space) const;
+
+  // Fill |spaces| with the empty spaces where |player| would make
+  // |min_shape| or better, and return how many there are.
+  int FindShapes(Player player, Shape min_shape, int* spaces) const;
+
+  // Place a mark for the player to move in |space|, then either advance the
+  // turn or end the game.
+  void PlaceMark(int space);
+
+  // Take back the last mark placed, and return its space.  The player who
+  // placed it is to move again.
+  int RemoveLastMark();
+
+ private:
+  // The cells are padded with walls eight deep, so the line through any
+  // space, out to the ends of its neighbors' windows, can be read without
+  // bounds checks.
+  static const int kPadding = 8;
+  static const int kStride = kWidth + 2 * kPadding;
+  static const int kNumCells = kStride * (kHeight + 2 * kPadding);
+  static const uint8_t kWall = 3;
+  // The distance between neighboring cells in each direction.
+  static const int kDirectionSteps[kNumDirections];
+
+  static int ToCell(int space) {
+    return (space / kWidth + kPadding) * kStride + space % kWidth + kPadding;
+  }
+
+  // Look up the shapes of the spaces lined up with |space|, which just
+  // changed.
+  void UpdateShapes(int space);
+
+  uint8_t cells_[kNumCells];
+  // Indexed by player, then cell and direction.
+  uint8_t shapes_[2][kNumCells][kNumDirections];
+
+  uint64_t hash_;
+  Player turn_;
+  Player winner_;
+  int num_moves_;
+  int16_t moves_[kNumSpaces];
+};
+
+}  // namespace Tictactoe
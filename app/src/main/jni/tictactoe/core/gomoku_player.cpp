@@ -0,0 +1,196 @@
+////
+// gomoku_player.cpp
+////
+
+#include "tictactoe/core/gomoku_player.h"
+
+#include "base/logging.h"
+#include "base/thread/thread_util.h"
+#include "tictactoe/core/mcts_search.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/mnk_search.h"
+#include "tictactoe/core/opening_book.h"
+#include "tictactoe/core/threat_search.h"
+
+namespace Tictactoe {
+
+namespace {
+const int kSearchTableBits = 18;
+const int kThreatTableBits = 18;
+
+// Tree size for the Monte Carlo computer player.
+const int kMonteCarloMaxNodes = 1 << 18;
+
+// Search time per move.  Threat space spends up to half of its time looking
+// for a forced win, and the rest searching if there isn't one.
+const double kExpertSearchSeconds = 0.25;
+const double kImpossibleSearchSeconds = 1;
+
+// Random moves stay next to the marks already played.
+const int kRandomMoveDistance = 1;
+
+TimeInterval Half(const TimeInterval& interval) {
+  return TimeInterval::FromSeconds(interval.Seconds() / 2);
+}
+}
+
+GomokuPlayer::GomokuPlayer(Difficulty difficulty)
+    : GomokuPlayer(difficulty, Random::get()->Next()) {
+  num_search_threads_ = thread::GetProcessorCount();
+}
+
+GomokuPlayer::GomokuPlayer(Difficulty difficulty, uint32_t seed)
+    : difficulty_(difficulty),
+      max_search_time_(TimeInterval::FromSeconds(
+          difficulty == kDifficultyImpossible ||
+                  difficulty == kDifficultyThreatSpace
+              ? kImpossibleSearchSeconds
+              : kExpertSearchSeconds)),
+      num_search_threads_(1),
+      use_opening_book_(true),
+      random_(seed) {
+  if (difficulty_ == kDifficultyThreatSpace)
+    threat_search_ = std::make_unique<ThreatSearch>(kThreatTableBits);
+  if (difficulty_ == kDifficultyExpert ||
+      difficulty_ == kDifficultyImpossible ||
+      difficulty_ == kDifficultyThreatSpace) {
+    search_ = std::make_unique<MnkSearch>(kSearchTableBits);
+  }
+  if (difficulty_ == kDifficultyMonteCarlo)
+    monte_carlo_search_ = std::make_unique<MctsSearch>(kMonteCarloMaxNodes);
+  if (search_ || monte_carlo_search_) {
+    opening_book_ = OpeningBook::Open(OpeningBook::GetAssetName(
+        GomokuBoard::kWidth, GomokuBoard::kHeight, GomokuBoard::kK));
+  }
+}
+
+GomokuPlayer::~GomokuPlayer() {}
+
+int GomokuPlayer::ChooseMove(const GomokuBoard& board,
+                             const std::atomic<bool>* cancel) {
+  DCHECK(!board.game_over());
+
+  const int book_move = FindBookMove(board);
+  if (book_move != -1)
+    return book_move;
+
+  switch (difficulty_) {
+    case kDifficultyThreatSpace: {
+      int space = FindForcedMove(board);
+      if (space != -1)
+        return space;
+      space = FindThreatMove(board, cancel);
+      if (space != -1)
+        return space;
+      return FindSearchMove(board, Half(max_search_time_), cancel);
+    }
+
+    case kDifficultyImpossible:
+    case kDifficultyExpert:
+      return FindSearchMove(board, max_search_time_, cancel);
+
+    case kDifficultyMonteCarlo:
+      return FindMonteCarloMove(board, cancel);
+
+    case kDifficultyHard: {
+      const int space = FindForcedMove(board);
+      if (space != -1)
+        return space;
+      return FindRandomMove(board);
+    }
+
+    case kDifficultyEasy:
+      break;
+  }
+  return FindRandomMove(board);
+}
+
+// private:
+// static
+int GomokuPlayer::FindForcedMove(const GomokuBoard& board) {
+  const Player player = board.turn();
+  const Player opponent = player == kPlayerX ? kPlayerO : kPlayerX;
+  int spaces[GomokuBoard::kNumSpaces];
+
+  // Check if there is a winning move.
+  if (board.FindShapes(player, GomokuBoard::kShapeFive, spaces))
+    return spaces[0];
+
+  // Block any winning move.
+  if (board.FindShapes(opponent, GomokuBoard::kShapeFive, spaces))
+    return spaces[0];
+
+  return -1;
+}
+
+int GomokuPlayer::FindBookMove(const GomokuBoard& board) {
+  if (!use_opening_book_ || !opening_book_ ||
+      board.num_moves() >= opening_book_->max_moves()) {
+    return -1;
+  }
+  return opening_book_->FindMove(CreateSearchBoard(board), &random_);
+}
+
+int GomokuPlayer::FindThreatMove(const GomokuBoard& board,
+                                 const std::atomic<bool>* cancel) {
+  GomokuBoard search_board = board;
+  ThreatSearchResult result =
+      threat_search_->Search(&search_board, Half(max_search_time_), cancel);
+  DLOG(INFO) << "Threat search win in " << result.plies << " plies, "
+             << result.nodes << " nodes in " << result.elapsed.Seconds()
+             << " sec";
+  return result.move;
+}
+
+int GomokuPlayer::FindSearchMove(const GomokuBoard& board,
+                                 TimeInterval max_time,
+                                 const std::atomic<bool>* cancel) {
+  MnkBoard search_board = CreateSearchBoard(board);
+  MnkSearchLimits limits;
+  limits.max_time = max_time;
+  limits.num_threads = num_search_threads_;
+  limits.cancel = cancel;
+  MnkSearchResult result = search_->Search(&search_board, limits);
+  DLOG(INFO) << "Search depth " << result.depth << ", " << result.nodes
+             << " nodes, " << result.NodesPerSecond() << " nodes/sec, "
+             << result.table_counters.HitRate() * 100 << "% table hits";
+  return result.move;
+}
+
+int GomokuPlayer::FindMonteCarloMove(const GomokuBoard& board,
+                                     const std::atomic<bool>* cancel) {
+  MctsSearchLimits limits;
+  limits.max_time = max_search_time_;
+  limits.num_threads = num_search_threads_;
+  limits.cancel = cancel;
+  MctsSearchResult result =
+      monte_carlo_search_->Search(CreateSearchBoard(board), limits);
+  DLOG(INFO) << "Monte Carlo " << result.rollouts << " rollouts, "
+             << result.RolloutsPerSecond() << " rollouts/sec";
+  return result.move;
+}
+
+int GomokuPlayer::FindRandomMove(const GomokuBoard& board) {
+  if (!board.num_moves())
+    return GomokuBoard::kNumSpaces / 2;
+
+  int spaces[GomokuBoard::kNumSpaces];
+  int count = 0;
+  for (int space = 0; space < GomokuBoard::kNumSpaces; ++space) {
+    if (board.IsEmpty(space) && board.HasNeighbor(space, kRandomMoveDistance))
+      spaces[count++] = space;
+  }
+  DCHECK_GT(count, 0);
+  return spaces[static_cast<int>(random_.NextDouble() * count)];
+}
+
+// static
+MnkBoard GomokuPlayer::CreateSearchBoard(const GomokuBoard& board) {
+  MnkBoard search_board(GomokuBoard::kWidth, GomokuBoard::kHeight,
+                        GomokuBoard::kK);
+  for (int i = 0; i < board.num_moves(); ++i)
+    search_board.PlaceMark(board.move(i));
+  return search_board;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,91 @@
+////
+// gomoku_player.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/gomoku_board.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+class MctsSearch;
+class MnkBoard;
+class MnkSearch;
+class OpeningBook;
+class ThreatSearch;
+
+// Picks the computer's gomoku moves for one difficulty.  The threat space
+// difficulty looks for a forced win with ThreatSearch before falling back to
+// the same alpha-beta search as Impossible.  The difficulties that search
+// play the opening from a book when the app has one.  ChooseMove() may run on
+// any one thread at a time.
+class GomokuPlayer : public base::RefCountedThreadSafe<GomokuPlayer> {
+ public:
+  // Seed the random moves from the global generator, and search on every
+  // processor.  Must be created on the UI thread.
+  explicit GomokuPlayer(Difficulty difficulty);
+  // Seed the random moves from |seed|, and search on one thread.
+  GomokuPlayer(Difficulty difficulty, uint32_t seed);
+  ~GomokuPlayer();
+  DISALLOW_COPY_AND_ASSIGN(GomokuPlayer);
+
+  // The time limit for each move's search.  Defaults to the difficulty's.
+  void set_max_search_time(const TimeInterval& max_search_time) {
+    max_search_time_ = max_search_time;
+  }
+  void set_num_search_threads(int num_search_threads) {
+    num_search_threads_ = num_search_threads;
+  }
+
+  // Whether to play from the opening book.  On by default.
+  void set_use_opening_book(bool use_opening_book) {
+    use_opening_book_ = use_opening_book;
+  }
+
+  // Choose a move for the player to move on |board|.  The searches stop
+  // early once |cancel| is set, in which case the move may be weaker.
+  int ChooseMove(const GomokuBoard& board, const std::atomic<bool>* cancel);
+
+ private:
+  // Return a move that completes a five, or else blocks one, or -1 if
+  // there's neither.
+  static int FindForcedMove(const GomokuBoard& board);
+
+  // Return a move from the opening book, or -1 if it doesn't have one.
+  int FindBookMove(const GomokuBoard& board);
+  int FindThreatMove(const GomokuBoard& board,
+                     const std::atomic<bool>* cancel);
+  int FindSearchMove(const GomokuBoard& board,
+                     TimeInterval max_time,
+                     const std::atomic<bool>* cancel);
+  int FindMonteCarloMove(const GomokuBoard& board,
+                         const std::atomic<bool>* cancel);
+  // Choose a random space next to a mark, or the center of an empty board.
+  int FindRandomMove(const GomokuBoard& board);
+
+  static MnkBoard CreateSearchBoard(const GomokuBoard& board);
+
+  const Difficulty difficulty_;
+  TimeInterval max_search_time_;
+  int num_search_threads_;
+  bool use_opening_book_;
+
+  std::unique_ptr<ThreatSearch> threat_search_;
+  std::unique_ptr<MnkSearch> search_;
+  std::unique_ptr<MctsSearch> monte_carlo_search_;
+  // Only for the difficulties that search.  May be null.
+  std::unique_ptr<OpeningBook> opening_book_;
+
+  // The global generator belongs to the UI thread.
+  Random random_;
+};
+
+}  // namespace Tictactoe
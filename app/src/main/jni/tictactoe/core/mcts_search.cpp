@@ -0,0 +1,289 @@
+////
+// mcts_search.cpp
+////
+
+#include "tictactoe/core/mcts_search.h"
+
+#include "base/logging.h"
+#include "base/math/math.h"
+#include "base/thread/thread_pool.h"
+#include "base/util/random.h"
+#include "tictactoe/core/mnk_board.h"
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+namespace Tictactoe {
+
+namespace {
+const int kMaxMoves = MnkBoard::kMaxSize * MnkBoard::kMaxSize;
+
+// Boards larger than this only expand spaces near existing marks.
+const int kMaxFullWidthSpaces = 25;
+const int kNeighborDistance = 2;
+
+// UCT exploration constant.
+const double kExploration = 1.4;
+
+// A node is expanded once it has been visited this many times.
+const int kExpandVisits = 1;
+
+const double kDefaultMaxSeconds = 1.0;
+}
+
+// Runs the rollout workers of one search, one per index, each on its own
+// copy of the board.
+class MctsSearch::WorkerBody : public ThreadPool::Body {
+ public:
+  WorkerBody(MctsSearch* search, MnkBoard* boards, uint32_t seed)
+      : search_(search), boards_(boards), seed_(seed) {}
+  ~WorkerBody() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerBody);
+
+  // ThreadPool::Body:
+  void Run(int begin, int end) override {
+    for (int i = begin; i < end; ++i) {
+      // Worker 0 always runs, so there's at least one rollout, but the
+      // others have nothing to do once the search is over.
+      if (i && search_->stopped_.load(std::memory_order_relaxed))
+        continue;
+      search_->RunWorker(&boards_[i], seed_ + i);
+    }
+  }
+
+ private:
+  MctsSearch* search_;
+  MnkBoard* boards_;
+  uint32_t seed_;
+};
+
+////
+// MctsSearchLimits
+////
+MctsSearchLimits::MctsSearchLimits()
+    : max_time(TimeInterval::FromSeconds(kDefaultMaxSeconds)),
+      num_threads(1),
+      cancel(nullptr) {}
+
+////
+// MctsSearchResult
+////
+MctsSearchResult::MctsSearchResult()
+    : move(-1), win_rate(0), rollouts(0), nodes(0) {}
+
+double MctsSearchResult::RolloutsPerSecond() const {
+  if (elapsed.Seconds() <= 0)
+    return 0;
+  return rollouts / elapsed.Seconds();
+}
+
+////
+// MctsSearch
+////
+MctsSearch::MctsSearch(int max_nodes)
+    : nodes_(new Node[max_nodes]),
+      max_nodes_(max_nodes),
+      next_node_(0),
+      rollouts_(0),
+      stopped_(false),
+      cancel_(nullptr),
+      random_(Random::get()->Next()) {
+  DCHECK_GT(max_nodes_, 0);
+}
+
+MctsSearch::~MctsSearch() {}
+
+MctsSearchResult MctsSearch::Search(const MnkBoard& board,
+                                    const MctsSearchLimits& limits) {
+  const Timestamp start = Timestamp::Now();
+  MctsSearchResult result;
+  if (board.game_over())
+    return result;
+
+  // Reset the tree to a single root node.
+  Node* root = &nodes_[0];
+  root->score = 0;
+  root->visits = 0;
+  root->virtual_loss = 0;
+  root->first_child = kUnexpanded;
+  root->num_children = 0;
+  root->move = -1;
+  next_node_ = 1;
+  rollouts_ = 0;
+  stopped_ = false;
+  deadline_ = start + limits.max_time;
+  cancel_ = limits.cancel;
+
+  // Each thread plays out its rollouts on its own copy of the board.
+  const int num_threads = math::Clamp(limits.num_threads, 1, kMaxThreads);
+  std::vector<MnkBoard> boards(num_threads, board);
+  // A single thread search doesn't start the pool.
+  WorkerBody body(this, boards.data(), random_.Next());
+  if (num_threads > 1)
+    SearchThreadPool()->ParallelFor(0, num_threads, 1, &body);
+  else
+    body.Run(0, 1);
+
+  // Play the most visited move.
+  const int first = root->first_child;
+  int best_visits = -1;
+  for (int i = 0; first >= 0 && i < root->num_children; ++i) {
+    const Node& child = nodes_[first + i];
+    if (child.visits > best_visits) {
+      best_visits = child.visits;
+      result.move = child.move;
+      result.win_rate = child.visits ? child.score / (2.0 * child.visits) : 0;
+    }
+  }
+
+  result.rollouts = rollouts_;
+  result.nodes = std::min(next_node_.load(), max_nodes_);
+  result.elapsed = Timestamp::Now() - start;
+  return result;
+}
+
+// private:
+void MctsSearch::RunWorker(MnkBoard* board, uint32_t seed) {
+  const Player root_turn = board->turn();
+  const Player root_opponent = root_turn == kPlayerX ? kPlayerO : kPlayerX;
+
+  Random random(seed);
+  int path[kMaxMoves + 1];
+  int moves[kMaxMoves];
+  int empty[kMaxMoves];
+
+  // Count locally so the threads don't fight over the shared counter.
+  int64_t rollouts = 0;
+  while (!stopped_.load(std::memory_order_relaxed)) {
+    // Select a path down the tree, expanding the leaf if it's due.
+    int depth = 0;
+    int num_moves = 0;
+    Node* node = &nodes_[0];
+    node->virtual_loss++;
+    path[depth++] = 0;
+    while (!board->game_over()) {
+      int first = node->first_child.load(std::memory_order_acquire);
+      if (first == kUnexpanded && node->visits >= kExpandVisits) {
+        int32_t expected = kUnexpanded;
+        if (node->first_child.compare_exchange_strong(expected, kExpanding)) {
+          Expand(node, *board);
+          first = node->first_child.load(std::memory_order_acquire);
+        }
+      }
+      if (first < 0)
+        break;
+
+      const int child = SelectChild(*node);
+      node = &nodes_[child];
+      node->virtual_loss++;
+      path[depth++] = child;
+      board->PlaceMark(node->move);
+      moves[num_moves++] = node->move;
+    }
+
+    // Play out the rest of the game at random.
+    if (!board->game_over()) {
+      int num_empty = 0;
+      for (int space = 0; space < board->num_spaces(); ++space) {
+        if (board->IsEmpty(space))
+          empty[num_empty++] = space;
+      }
+      while (!board->game_over()) {
+        const int index = random.Next() % num_empty;
+        const int space = empty[index];
+        empty[index] = empty[--num_empty];
+        board->PlaceMark(space);
+        moves[num_moves++] = space;
+      }
+    }
+
+    const Player winner = board->winner();
+    while (num_moves)
+      board->RemoveMark(moves[--num_moves]);
+
+    // Back up the result, replacing the virtual losses with real visits.
+    for (int i = 0; i < depth; ++i) {
+      Node* path_node = &nodes_[path[i]];
+      const Player mover = (i % 2) ? root_turn : root_opponent;
+      int32_t result = 1;
+      if (winner == mover)
+        result = 2;
+      else if (winner != kPlayerNone)
+        result = 0;
+      path_node->score += result;
+      path_node->visits++;
+      path_node->virtual_loss--;
+    }
+
+    rollouts++;
+    if (Timestamp::Now() >= deadline_ ||
+        (cancel_ && cancel_->load(std::memory_order_relaxed))) {
+      stopped_ = true;
+    }
+  }
+  rollouts_ += rollouts;
+}
+
+int MctsSearch::SelectChild(const Node& node) {
+  const int first = node.first_child.load(std::memory_order_acquire);
+  DCHECK_GE(first, 0);
+
+  const int parent_visits = node.visits + node.virtual_loss;
+  const double log_parent_visits = log(std::max(parent_visits, 1));
+
+  int best_child = first;
+  double best_value = -1;
+  for (int i = 0; i < node.num_children; ++i) {
+    const Node& child = nodes_[first + i];
+    // Virtual losses count as visits that scored nothing.
+    const int visits = child.visits.load(std::memory_order_relaxed) +
+                       child.virtual_loss.load(std::memory_order_relaxed);
+    if (!visits)
+      return first + i;
+
+    const double value =
+        child.score.load(std::memory_order_relaxed) / (2.0 * visits) +
+        kExploration * sqrt(log_parent_visits / visits);
+    if (value > best_value) {
+      best_value = value;
+      best_child = first + i;
+    }
+  }
+  return best_child;
+}
+
+void MctsSearch::Expand(Node* node, const MnkBoard& board) {
+  const bool near_only = board.num_spaces() > kMaxFullWidthSpaces;
+  int moves[kMaxMoves];
+  int count = 0;
+  for (int space = 0; space < board.num_spaces(); ++space) {
+    if (!board.IsEmpty(space))
+      continue;
+    if (near_only && board.move_count() &&
+        !board.HasNeighbor(space, kNeighborDistance)) {
+      continue;
+    }
+    moves[count++] = space;
+  }
+
+  const int first = next_node_.fetch_add(count);
+  if (first + count > max_nodes_) {
+    // The pool is full, so leave this node as a leaf.
+    return;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    Node* child = &nodes_[first + i];
+    child->score.store(0, std::memory_order_relaxed);
+    child->visits.store(0, std::memory_order_relaxed);
+    child->virtual_loss.store(0, std::memory_order_relaxed);
+    child->first_child.store(kUnexpanded, std::memory_order_relaxed);
+    child->num_children = 0;
+    child->move = moves[i];
+  }
+  node->num_children = count;
+  node->first_child.store(first, std::memory_order_release);
+}
+
+}  // namespace Tictactoe
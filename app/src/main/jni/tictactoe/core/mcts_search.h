@@ -0,0 +1,103 @@
+////
+// mcts_search.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/core/search_util.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+class MnkBoard;
+
+struct MctsSearchLimits {
+  MctsSearchLimits();
+
+  TimeInterval max_time;
+  // Number of threads running rollouts, including the calling thread.
+  // Limited by the size of SearchThreadPool().
+  int num_threads;
+  // Stop early once this is set, if not null.  Set from any thread.
+  const std::atomic<bool>* cancel;
+};
+
+struct MctsSearchResult {
+  MctsSearchResult();
+
+  double RolloutsPerSecond() const;
+
+  // The most visited space, or -1 if the game is over.
+  int move;
+  // Expected score of |move| for the player to move, from 0 for a loss to 1
+  // for a win.
+  double win_rate;
+  int64_t rollouts;
+  int nodes;
+  TimeInterval elapsed;
+};
+
+// Monte Carlo tree search using UCT, with rollouts run on several threads
+// sharing one tree.  Threads add a virtual loss to each node while they are
+// under it, which steers the others toward different lines.  Nodes come from
+// a pool allocated up front, so a search never touches the heap once its
+// threads are started.  The threads come from the shared SearchThreadPool().
+class MctsSearch {
+ public:
+  static const int kMaxThreads = kMaxSearchThreads;
+
+  // Allocate room for |max_nodes| tree nodes.
+  explicit MctsSearch(int max_nodes);
+  ~MctsSearch();
+  DISALLOW_COPY_AND_ASSIGN(MctsSearch);
+
+  MctsSearchResult Search(const MnkBoard& board,
+                          const MctsSearchLimits& limits);
+
+ private:
+  class WorkerBody;
+  friend class WorkerBody;
+
+  struct Node {
+    // Total of the rollout results for the player who moved into this node,
+    // in half points: 2 for a win, 1 for a draw.
+    std::atomic<int32_t> score;
+    std::atomic<int32_t> visits;
+    std::atomic<int32_t> virtual_loss;
+    // Index of the first child, kUnexpanded, or kExpanding while a thread
+    // is adding the children.
+    std::atomic<int32_t> first_child;
+    int16_t num_children;
+    int16_t move;
+  };
+
+  static const int32_t kUnexpanded = -1;
+  static const int32_t kExpanding = -2;
+
+  // Run rollouts on a copy of the root board until the search is stopped.
+  void RunWorker(MnkBoard* board, uint32_t seed);
+
+  int SelectChild(const Node& node);
+  void Expand(Node* node, const MnkBoard& board);
+
+  std::unique_ptr<Node[]> nodes_;
+  const int max_nodes_;
+  std::atomic<int> next_node_;
+
+  std::atomic<int64_t> rollouts_;
+  std::atomic<bool> stopped_;
+  Timestamp deadline_;
+  const std::atomic<bool>* cancel_;
+
+  // Seeds the worker threads.  Seeded on construction, so searches don't
+  // share the global generator with other threads.
+  Random random_;
+};
+
+}  // namespace Tictactoe
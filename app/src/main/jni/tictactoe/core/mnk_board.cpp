@@ -0,0 +1,249 @@
+////
+// mnk_board.cpp
+////
+
+#include "tictactoe/core/mnk_board.h"
+
+#include "base/logging.h"
+#include "base/util/random.h"
+
+#include <algorithm>
+
+namespace Tictactoe {
+
+namespace {
+// Fixed so that hashes are stable between runs.
+const uint32_t kZobristSeed = 0x6d6e6b21;
+
+// The largest weight given to a single window.
+const int kMaxWindowShift = 20;
+
+// Step for each line direction: horizontal, vertical, and both diagonals.
+const int kDirections[][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+}
+
+MnkBoard::MnkBoard(int width, int height, int k)
+    : width_(width),
+      height_(height),
+      k_(k),
+      cells_(width * height, kPlayerNone),
+      window_weights_(k + 1),
+      space_window_starts_(width * height + 1),
+      score_(0),
+      num_symmetries_(width == height ? kNumSymmetries : kNumSymmetries / 2),
+      transforms_(num_symmetries_ * width * height),
+      zobrist_keys_(2 * num_symmetries_ * width * height),
+      turn_(kPlayerX),
+      winner_(kPlayerNone),
+      move_count_(0),
+      hashes_{} {
+  DCHECK_GT(width_, 0);
+  DCHECK_GT(height_, 0);
+  DCHECK_LE(width_, kMaxSize);
+  DCHECK_LE(height_, kMaxSize);
+  DCHECK_LE(k_, std::max(width_, height_));
+
+  // Each extra mark in an open window is worth four times as much.
+  window_weights_[0] = 0;
+  for (int i = 1; i <= k_; ++i)
+    window_weights_[i] = 1 << std::min(2 * (i - 1), kMaxWindowShift);
+
+  // Work out what a mark does to a window in every state up front, so
+  // placing one is a table lookup per window.
+  const int num_states = (k_ + 1) * (k_ + 1);
+  window_steps_[0] = 1;
+  window_steps_[1] = k_ + 1;
+  window_moves_.resize(2 * num_states);
+  for (int o_count = 0; o_count <= k_; ++o_count) {
+    for (int x_count = 0; x_count <= k_; ++x_count) {
+      const int state = x_count + o_count * (k_ + 1);
+      const int score = WindowScore(x_count, o_count);
+      if (x_count < k_) {
+        WindowMove* move = &window_moves_[state];
+        move->score_delta = WindowScore(x_count + 1, o_count) - score;
+        move->completes_line = x_count + 1 == k_;
+      }
+      if (o_count < k_) {
+        WindowMove* move = &window_moves_[num_states + state];
+        move->score_delta = WindowScore(x_count, o_count + 1) - score;
+        move->completes_line = o_count + 1 == k_;
+      }
+    }
+  }
+
+  // Number every window, and list the windows through each space.
+  std::vector<std::vector<int>> windows(num_spaces());
+  int num_windows = 0;
+  for (const auto& direction : kDirections) {
+    const int dx = direction[0];
+    const int dy = direction[1];
+    for (int y = 0; y < height_; ++y) {
+      const int end_y = y + dy * (k_ - 1);
+      if (end_y < 0 || end_y >= height_)
+        continue;
+      for (int x = 0; x + dx * (k_ - 1) < width_; ++x) {
+        for (int i = 0; i < k_; ++i)
+          windows[(y + dy * i) * width_ + x + dx * i].push_back(num_windows);
+        num_windows++;
+      }
+    }
+  }
+  window_states_.resize(num_windows);
+  for (int space = 0; space < num_spaces(); ++space) {
+    space_window_starts_[space] = space_windows_.size();
+    space_windows_.insert(space_windows_.end(), windows[space].begin(),
+                          windows[space].end());
+  }
+  space_window_starts_[num_spaces()] = space_windows_.size();
+
+  for (int symmetry = 0; symmetry < num_symmetries_; ++symmetry) {
+    for (int space = 0; space < num_spaces(); ++space) {
+      transforms_[symmetry * num_spaces() + space] =
+          Tictactoe::TransformSpace(space, width_, height_, symmetry);
+    }
+  }
+
+  Random random(kZobristSeed);
+  std::vector<uint64_t> keys(2 * num_spaces());
+  for (auto& key : keys)
+    key = (static_cast<uint64_t>(random.Next()) << 32) | random.Next();
+
+  // Each symmetry hashes a mark with the key of the space it moves to.
+  for (int space = 0; space < num_spaces(); ++space) {
+    for (int player = 0; player < 2; ++player) {
+      for (int symmetry = 0; symmetry < num_symmetries_; ++symmetry) {
+        zobrist_keys_[(2 * space + player) * num_symmetries_ + symmetry] =
+            keys[2 * TransformSpace(space, symmetry) + player];
+      }
+    }
+  }
+}
+
+MnkBoard::~MnkBoard() {}
+
+bool MnkBoard::HasNeighbor(int space, int distance) const {
+  const int x = space % width_;
+  const int y = space / width_;
+  const int min_x = std::max(x - distance, 0);
+  const int max_x = std::min(x + distance, width_ - 1);
+  const int min_y = std::max(y - distance, 0);
+  const int max_y = std::min(y + distance, height_ - 1);
+  for (int ny = min_y; ny <= max_y; ++ny) {
+    for (int nx = min_x; nx <= max_x; ++nx) {
+      if (cells_[ny * width_ + nx] != kPlayerNone)
+        return true;
+    }
+  }
+  return false;
+}
+
+bool MnkBoard::CompletesLine(Player player, int space) const {
+  DCHECK(IsEmpty(space));
+
+  const int index = player - kPlayerX;
+  const WindowMove* moves = &window_moves_[index * (k_ + 1) * (k_ + 1)];
+  for (int i = space_window_starts_[space];
+       i < space_window_starts_[space + 1]; ++i) {
+    if (moves[window_states_[space_windows_[i]]].completes_line)
+      return true;
+  }
+  return false;
+}
+
+bool MnkBoard::CanStillWin(Player player) const {
+  for (uint16_t state : window_states_) {
+    const int opponent_count =
+        player == kPlayerX ? state / (k_ + 1) : state % (k_ + 1);
+    if (!opponent_count)
+      return true;
+  }
+  return false;
+}
+
+void MnkBoard::PlaceMark(int space) {
+  DCHECK_NE(turn_, kPlayerNone);
+  DCHECK(IsEmpty(space));
+
+  const Player player = turn_;
+  cells_[space] = player;
+  ToggleHashes(space, player);
+  move_count_++;
+
+  // Count the mark in each of its windows, noting if it fills one.
+  const int index = player - kPlayerX;
+  const WindowMove* moves = &window_moves_[index * (k_ + 1) * (k_ + 1)];
+  const int step = window_steps_[index];
+  bool completes_line = false;
+  for (int i = space_window_starts_[space];
+       i < space_window_starts_[space + 1]; ++i) {
+    uint16_t* state = &window_states_[space_windows_[i]];
+    const WindowMove& move = moves[*state];
+    score_ += move.score_delta;
+    completes_line |= move.completes_line;
+    *state += step;
+  }
+
+  if (completes_line) {
+    winner_ = player;
+    turn_ = kPlayerNone;
+  } else if (move_count_ == num_spaces()) {
+    // No spaces remain, it's a draw.
+    turn_ = kPlayerNone;
+  } else {
+    turn_ = player == kPlayerX ? kPlayerO : kPlayerX;
+  }
+}
+
+void MnkBoard::RemoveMark(int space) {
+  DCHECK(!IsEmpty(space));
+
+  const Player player = Get(space);
+  cells_[space] = kPlayerNone;
+  ToggleHashes(space, player);
+  move_count_--;
+
+  const int index = player - kPlayerX;
+  const WindowMove* moves = &window_moves_[index * (k_ + 1) * (k_ + 1)];
+  const int step = window_steps_[index];
+  for (int i = space_window_starts_[space];
+       i < space_window_starts_[space + 1]; ++i) {
+    uint16_t* state = &window_states_[space_windows_[i]];
+    *state -= step;
+    score_ -= moves[*state].score_delta;
+  }
+
+  // The game can only have ended on the last move, so undoing it always
+  // returns to play.
+  turn_ = player;
+  winner_ = kPlayerNone;
+}
+
+uint64_t MnkBoard::CanonicalHash(int* symmetry) const {
+  uint64_t best_hash = hashes_[0];
+  *symmetry = 0;
+  for (int i = 1; i < num_symmetries_; ++i) {
+    if (hashes_[i] < best_hash) {
+      best_hash = hashes_[i];
+      *symmetry = i;
+    }
+  }
+  return best_hash;
+}
+
+// private:
+int MnkBoard::WindowScore(int x_count, int o_count) const {
+  if (!o_count)
+    return window_weights_[x_count];
+  if (!x_count)
+    return -window_weights_[o_count];
+  return 0;
+}
+
+void MnkBoard::ToggleHashes(int space, Player player) {
+  const uint64_t* keys =
+      &zobrist_keys_[(2 * space + player - kPlayerX) * num_symmetries_];
+  for (int i = 0; i < num_symmetries_; ++i)
+    hashes_[i] ^= keys[i];
+}
+
+}  // namespace Tictactoe
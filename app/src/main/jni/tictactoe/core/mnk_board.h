@@ -0,0 +1,126 @@
+////
+// mnk_board.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/symmetry.h"
+
+#include <vector>
+
+namespace Tictactoe {
+
+// A |width| by |height| board where the first player to get |k| marks in a
+// row, column or diagonal wins.  Spaces are numbered left to right, top to
+// bottom.
+class MnkBoard {
+ public:
+  static const int kMaxSize = 19;
+
+  MnkBoard(int width, int height, int k);
+  ~MnkBoard();
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int k() const { return k_; }
+  int num_spaces() const { return width_ * height_; }
+
+  // The player to move, or kPlayerNone once the game is over.
+  Player turn() const { return turn_; }
+  // The winning player.  kPlayerNone while playing or after a draw.
+  Player winner() const { return winner_; }
+  bool game_over() const { return turn_ == kPlayerNone; }
+  int move_count() const { return move_count_; }
+
+  // Zobrist hash of the marks on the board.
+  uint64_t hash() const { return hashes_[0]; }
+
+  // The number of symmetries that keep the board's shape: all 8 for a square
+  // board, otherwise the 4 that don't swap rows and columns.  These are the
+  // first symmetries in the numbering from symmetry.h.
+  int num_symmetries() const { return num_symmetries_; }
+
+  // Return the space that |symmetry| moves |space| to.
+  int TransformSpace(int space, int symmetry) const {
+    return transforms_[symmetry * num_spaces() + space];
+  }
+
+  // Return the smallest hash of the board seen through any of its
+  // symmetries, which is the same for every symmetric position.  Sets
+  // |symmetry| to a symmetry that turns the board into that one.
+  uint64_t CanonicalHash(int* symmetry) const;
+
+  Player Get(int space) const { return static_cast<Player>(cells_[space]); }
+  bool IsEmpty(int space) const { return cells_[space] == kPlayerNone; }
+
+  // Return true if any mark is within |distance| spaces of |space|.
+  bool HasNeighbor(int space, int distance) const;
+
+  // Return true if a mark for |player| in the empty |space| would complete
+  // a line.
+  bool CompletesLine(Player player, int space) const;
+
+  // Return true if |player| still has a window with none of the opponent's
+  // marks, so they might yet win.
+  bool CanStillWin(Player player) const;
+
+  // Place a mark for the player to move in |space|, then either advance the
+  // turn or end the game.
+  void PlaceMark(int space);
+
+  // Undo the most recent PlaceMark(), which was made in |space|.
+  void RemoveMark(int space);
+
+  // Heuristic value of the position for the player to move.  Counts the
+  // marks in every k long window that only one player has entered.
+  int Evaluate() const { return turn_ == kPlayerO ? -score_ : score_; }
+
+ private:
+  // The effect of one more mark in a window.
+  struct WindowMove {
+    int score_delta;
+    bool completes_line;
+  };
+
+  // Return the contribution of a window with these marks to the score.
+  int WindowScore(int x_count, int o_count) const;
+  void ToggleHashes(int space, Player player);
+
+  int width_;
+  int height_;
+  int k_;
+
+  std::vector<uint8_t> cells_;
+  std::vector<int> window_weights_;
+
+  // The k long windows through each space, which are a win once one player
+  // fills them.  Space |i|'s windows are listed from
+  // |space_windows_[space_window_starts_[i]]| up to the next space's.
+  std::vector<int> space_window_starts_;
+  std::vector<int> space_windows_;
+  // The marks in each window, as X's count plus O's count times k + 1.
+  std::vector<uint16_t> window_states_;
+  // Indexed by player then window state, for each player's mark.
+  std::vector<WindowMove> window_moves_;
+  // The change to a window's state from each player's mark.
+  int window_steps_[2];
+  // Evaluate() for X, updated as marks are placed and removed.
+  int score_;
+
+  int num_symmetries_;
+  // The space each symmetry moves each space to, num_spaces() per symmetry.
+  std::vector<int16_t> transforms_;
+  // Keys for each space and player, with one key per symmetry next to each
+  // other so a move updates every hash in one pass.
+  std::vector<uint64_t> zobrist_keys_;
+
+  Player turn_;
+  Player winner_;
+  int move_count_;
+  // The hash as seen through each symmetry.  hashes_[0] is hash().
+  uint64_t hashes_[kNumSymmetries];
+};
+
+}  // namespace Tictactoe
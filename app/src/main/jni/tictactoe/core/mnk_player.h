@@ -0,0 +1,177 @@
+////
+// mnk_player.h
+////
+
+#pragma once
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/dfpn_solver.h"
+#include "tictactoe/core/mcts_search.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/mnk_search.h"
+#include "tictactoe/core/mnk_state.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+// Picks the computer's moves for one difficulty under an MnkState ruleset.
+// The stronger difficulties play the same MnkSearch and MctsSearch as the
+// classic and gomoku players, on the state's own board, and Impossible first
+// tries to prove a win with DfpnSolver.  ChooseMove() may run on any one
+// thread at a time.
+template <typename Rules>
+class MnkPlayer : public base::RefCountedThreadSafe<MnkPlayer<Rules>> {
+ public:
+  typedef MnkState<Rules> State;
+
+  MnkPlayer(Difficulty difficulty, uint32_t seed)
+      : difficulty_(difficulty), random_(seed) {
+    if (difficulty_ == kDifficultyMonteCarlo) {
+      monte_carlo_search_ = std::make_unique<MctsSearch>(kMonteCarloMaxNodes);
+    } else if (difficulty_ != kDifficultyEasy &&
+               difficulty_ != kDifficultyHard) {
+      search_ = std::make_unique<MnkSearch>(kSearchTableBits);
+    }
+    if (difficulty_ == kDifficultyImpossible ||
+        difficulty_ == kDifficultyThreatSpace) {
+      solver_ = std::make_unique<DfpnSolver>(kSolverTableBits);
+    }
+  }
+  ~MnkPlayer() {}
+  DISALLOW_COPY_AND_ASSIGN(MnkPlayer);
+
+  // Choose a move for the player to move in |state|.  The searches stop
+  // early once |cancel| is set, in which case the move may be weaker.
+  int ChooseMove(const State& state, const std::atomic<bool>* cancel) {
+    DCHECK(!state.game_over());
+
+    switch (difficulty_) {
+      // Threat search only plays gomoku, so this searches like Impossible.
+      case kDifficultyThreatSpace:
+      case kDifficultyImpossible: {
+        const int move = FindProvenWin(state, cancel);
+        if (move >= 0)
+          return move;
+        return FindSearchMove(state, kImpossibleSearchSeconds - kProofSeconds,
+                              cancel);
+      }
+
+      case kDifficultyExpert:
+        return FindSearchMove(state, kExpertSearchSeconds, cancel);
+
+      case kDifficultyMonteCarlo:
+        return FindMonteCarloMove(state, cancel);
+
+      case kDifficultyHard:
+        return FindHardMove(state);
+
+      case kDifficultyEasy:
+        break;
+    }
+    return FindRandomMove(state);
+  }
+
+ private:
+  static const int kSearchTableBits = 18;
+  static const int kSolverTableBits = 16;
+  // Tree size for the Monte Carlo computer player.
+  static const int kMonteCarloMaxNodes = 1 << 18;
+  static constexpr double kExpertSearchSeconds = 0.25;
+  static constexpr double kImpossibleSearchSeconds = 1;
+  // The part of Impossible's time spent trying to prove a win.
+  static constexpr double kProofSeconds = 0.25;
+
+  // Try to prove a forced win for the player to move.  Deep forcing wins
+  // are proven well past the depth the search reaches in time.  Returns the
+  // winning move, or -1 if there wasn't time to prove one.
+  int FindProvenWin(const State& state, const std::atomic<bool>* cancel) {
+    MnkBoard board = state.board();
+    DfpnLimits limits;
+    limits.max_time = TimeInterval::FromSeconds(kProofSeconds);
+    limits.cancel = cancel;
+    const DfpnProgress progress = solver_->Solve(&board, state.turn(), limits);
+    DLOG(INFO) << "Proof search " << progress.nodes << " nodes, "
+               << progress.NodesPerSecond() << " nodes/sec";
+    if (progress.result != DfpnProgress::kResultProven)
+      return -1;
+    return progress.move;
+  }
+
+  int FindSearchMove(const State& state,
+                     double seconds,
+                     const std::atomic<bool>* cancel) {
+    MnkBoard board = state.board();
+    MnkSearchLimits limits;
+    limits.max_time = TimeInterval::FromSeconds(seconds);
+    limits.cancel = cancel;
+    MnkSearchResult result = search_->Search(&board, limits);
+    DLOG(INFO) << "Search depth " << result.depth << ", " << result.nodes
+               << " nodes, " << result.NodesPerSecond() << " nodes/sec";
+    return result.move;
+  }
+
+  int FindMonteCarloMove(const State& state,
+                         const std::atomic<bool>* cancel) {
+    MctsSearchLimits limits;
+    limits.max_time = TimeInterval::FromSeconds(kExpertSearchSeconds);
+    limits.cancel = cancel;
+    MctsSearchResult result =
+        monte_carlo_search_->Search(state.board(), limits);
+    DLOG(INFO) << "Monte Carlo " << result.rollouts << " rollouts, "
+               << result.RolloutsPerSecond() << " rollouts/sec";
+    return result.move;
+  }
+
+  // Win if possible, otherwise block.
+  int FindHardMove(const State& state) {
+    const Player player = state.turn();
+    const Player opponent = player == kPlayerX ? kPlayerO : kPlayerX;
+    const MnkBoard& board = state.board();
+
+    for (int space = 0; space < State::kNumSpaces; ++space) {
+      if (board.IsEmpty(space) && board.CompletesLine(player, space))
+        return space;
+    }
+    for (int space = 0; space < State::kNumSpaces; ++space) {
+      if (board.IsEmpty(space) && board.CompletesLine(opponent, space))
+        return space;
+    }
+    return FindRandomMove(state);
+  }
+
+  // Choose a random empty space.
+  int FindRandomMove(const State& state) {
+    int spaces[State::kNumSpaces];
+    int count = 0;
+    for (int space = 0; space < State::kNumSpaces; ++space) {
+      if (state.IsEmpty(space))
+        spaces[count++] = space;
+    }
+    DCHECK_GT(count, 0);
+    return spaces[static_cast<int>(random_.NextDouble() * count)];
+  }
+
+  const Difficulty difficulty_;
+  // Whichever search the difficulty plays with.  The other is null.
+  std::unique_ptr<MnkSearch> search_;
+  std::unique_ptr<MctsSearch> monte_carlo_search_;
+  // For Impossible, and Threat search, which plays like it.  Null otherwise.
+  std::unique_ptr<DfpnSolver> solver_;
+  Random random_;
+};
+
+template <typename Rules>
+const int MnkPlayer<Rules>::kSearchTableBits;
+template <typename Rules>
+const int MnkPlayer<Rules>::kSolverTableBits;
+template <typename Rules>
+const int MnkPlayer<Rules>::kMonteCarloMaxNodes;
+
+}  // namespace Tictactoe
@@ -0,0 +1,318 @@
+////
+// mnk_search.cpp
+////
+
+#include "tictactoe/core/mnk_search.h"
+
+#include "base/logging.h"
+#include "base/math/math.h"
+#include "base/thread/thread_pool.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/search_util.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Tictactoe {
+
+namespace {
+const int kMaxMoves = MnkBoard::kMaxSize * MnkBoard::kMaxSize;
+
+// Boards larger than this only consider spaces near existing marks.
+const int kMaxFullWidthSpaces = 25;
+const int kNeighborDistance = 2;
+
+typedef SearchScores<MnkSearch::kWinScore, MnkSearch::kMaxPly> Scores;
+}
+
+// Runs the workers of one search, one per index.  Worker 0 is the main
+// search; the helpers only help it, so the search stops when it's done.
+class MnkSearch::WorkerBody : public ThreadPool::Body {
+ public:
+  WorkerBody(MnkSearch* search, Worker* workers)
+      : search_(search), workers_(workers) {}
+  ~WorkerBody() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerBody);
+
+  // ThreadPool::Body:
+  void Run(int begin, int end) override {
+    for (int i = begin; i < end; ++i) {
+      // A helper that only gets a thread once the search is over has nothing
+      // left to do.
+      if (i && search_->stopped_.load(std::memory_order_relaxed))
+        continue;
+      search_->RunWorker(&workers_[i]);
+      if (!i)
+        search_->stopped_ = true;
+    }
+  }
+
+ private:
+  MnkSearch* search_;
+  Worker* workers_;
+};
+
+////
+// MnkSearchLimits
+////
+MnkSearchLimits::MnkSearchLimits()
+    : max_depth(MnkSearch::kMaxPly),
+      max_nodes(std::numeric_limits<int64_t>::max()),
+      num_threads(1),
+      cancel(nullptr) {}
+
+////
+// MnkSearchResult
+////
+MnkSearchResult::MnkSearchResult() : move(-1), score(0), depth(0), nodes(0) {}
+
+double MnkSearchResult::NodesPerSecond() const {
+  if (elapsed.Seconds() <= 0)
+    return 0;
+  return nodes / elapsed.Seconds();
+}
+
+////
+// MnkSearch::Worker
+////
+MnkSearch::Worker::Worker()
+    : index(0),
+      board(nullptr),
+      nodes(0),
+      move(-1),
+      score(0),
+      depth(0) {}
+
+////
+// MnkSearch
+////
+MnkSearch::MnkSearch(int table_bits)
+    : table_(new TranspositionTable(table_bits)),
+      max_depth_(0),
+      nodes_(0),
+      stopped_(false) {}
+
+MnkSearch::~MnkSearch() {}
+
+MnkSearchResult MnkSearch::Search(MnkBoard* board,
+                                  const MnkSearchLimits& limits) {
+  const Timestamp start = Timestamp::Now();
+  limits_ = limits;
+  deadline_.Start(limits.max_time, limits.cancel);
+  nodes_ = 0;
+  stopped_ = false;
+  table_->NewSearch();
+
+  MnkSearchResult result;
+  if (board->game_over())
+    return result;
+
+  max_depth_ =
+      std::min(limits.max_depth, board->num_spaces() - board->move_count());
+
+  // Worker 0 searches |board|, and each helper its own copy.
+  const int num_threads = math::Clamp(limits.num_threads, 1, kMaxThreads);
+  std::vector<MnkBoard> boards(num_threads - 1, *board);
+  Worker workers[kMaxThreads];
+  for (int i = 0; i < num_threads; ++i) {
+    workers[i].index = i;
+    workers[i].board = i ? &boards[i - 1] : board;
+    workers[i].history.assign(kMaxMoves, 0);
+  }
+
+  // Worker 0 is the first index claimed, so it's never left waiting behind a
+  // helper on the same thread.  A single thread search doesn't start the
+  // pool.
+  WorkerBody body(this, workers);
+  if (num_threads > 1)
+    SearchThreadPool()->ParallelFor(0, num_threads, 1, &body);
+  else
+    body.Run(0, 1);
+
+  // Take the deepest iteration any worker finished, preferring worker 0's,
+  // which always has a move.
+  for (int i = 0; i < num_threads; ++i) {
+    const Worker& worker = workers[i];
+    if (!i || worker.depth > result.depth) {
+      result.move = worker.move;
+      result.score = worker.score;
+      result.depth = worker.depth;
+    }
+    result.nodes += worker.nodes;
+    result.table_counters.Add(worker.table_counters);
+  }
+  result.elapsed = Timestamp::Now() - start;
+  return result;
+}
+
+// private:
+void MnkSearch::RunWorker(Worker* worker) {
+  // Odd helpers start a ply deeper, so the threads spread over two depths
+  // instead of all searching the same one.
+  for (int depth = 1 + worker->index % 2; depth <= max_depth_; ++depth) {
+    int move = -1;
+    int score = SearchRoot(worker, depth, worker->move, &move);
+    if (stopped_.load(std::memory_order_relaxed)) {
+      // Keep the last complete iteration, unless there isn't one yet.
+      if (worker->move == -1)
+        worker->move = move;
+      break;
+    }
+
+    worker->move = move;
+    worker->score = score;
+    worker->depth = depth;
+
+    // Stop once the result is known.
+    if (Scores::IsWin(score))
+      break;
+  }
+  table_->AddCounters(worker->table_counters);
+}
+
+int MnkSearch::SearchRoot(Worker* worker,
+                          int depth,
+                          int first_move,
+                          int* best_move) {
+  MnkBoard* board = worker->board;
+  int moves[kMaxMoves];
+  const int count = GenerateMoves(*worker, first_move, moves);
+  DCHECK_GT(count, 0);
+
+  int alpha = -Scores::kInfinity;
+  *best_move = moves[0];
+  for (int i = 0; i < count; ++i) {
+    board->PlaceMark(moves[i]);
+    int score = -Negamax(worker, depth - 1, -Scores::kInfinity, -alpha, 1);
+    board->RemoveMark(moves[i]);
+    if (stopped_.load(std::memory_order_relaxed))
+      break;
+
+    if (score > alpha) {
+      alpha = score;
+      *best_move = moves[i];
+    }
+  }
+  return alpha;
+}
+
+int MnkSearch::Negamax(Worker* worker,
+                       int depth,
+                       int alpha,
+                       int beta,
+                       int ply) {
+  MnkBoard* board = worker->board;
+  worker->nodes++;
+  if (board->game_over()) {
+    // The previous player either won or filled the board.
+    if (board->winner() != kPlayerNone)
+      return -(kWinScore - ply);
+    return 0;
+  }
+  if (ShouldStop(worker))
+    return 0;
+  if (depth == 0)
+    return board->Evaluate();
+
+  // Probe the transposition table.  Symmetric positions share an entry, with
+  // the move stored as it would be played on the canonical board.
+  int symmetry = 0;
+  const uint64_t hash = board->CanonicalHash(&symmetry);
+  TranspositionTable::Entry entry;
+  int table_move = -1;
+  if (table_->Probe(hash, &entry, &worker->table_counters)) {
+    if (entry.move >= 0)
+      table_move = board->TransformSpace(entry.move, InverseSymmetry(symmetry));
+    int score;
+    if (Scores::ProbeCutoff(entry, depth, ply, &alpha, &beta, &score))
+      return score;
+  }
+
+  int moves[kMaxMoves];
+  const int count = GenerateMoves(*worker, table_move, moves);
+
+  const int original_alpha = alpha;
+  int best_score = -Scores::kInfinity;
+  int best_move = -1;
+  for (int i = 0; i < count; ++i) {
+    board->PlaceMark(moves[i]);
+    int score = -Negamax(worker, depth - 1, -beta, -alpha, ply + 1);
+    board->RemoveMark(moves[i]);
+    if (stopped_.load(std::memory_order_relaxed))
+      return 0;
+
+    if (score > best_score) {
+      best_score = score;
+      best_move = moves[i];
+    }
+    if (score > alpha)
+      alpha = score;
+    if (alpha >= beta) {
+      worker->history[moves[i]] += depth * depth;
+      break;
+    }
+  }
+
+  // Store the result, with the move as it's played on the canonical board.
+  const int canonical_move =
+      best_move >= 0 ? board->TransformSpace(best_move, symmetry) : -1;
+  Scores::FillEntry(best_score, canonical_move, depth, ply, original_alpha,
+                    beta, &entry);
+  table_->Store(hash, entry, &worker->table_counters);
+
+  return best_score;
+}
+
+int MnkSearch::GenerateMoves(const Worker& worker,
+                             int first_move,
+                             int* moves) {
+  const MnkBoard& board = *worker.board;
+  const int num_spaces = board.num_spaces();
+
+  // Open in the center of an empty board.
+  if (!board.move_count()) {
+    moves[0] = (board.height() / 2) * board.width() + board.width() / 2;
+    return 1;
+  }
+
+  const bool near_only = num_spaces > kMaxFullWidthSpaces;
+  int scores[kMaxMoves];
+  int count = 0;
+  for (int space = 0; space < num_spaces; ++space) {
+    if (!board.IsEmpty(space))
+      continue;
+    if (near_only && !board.HasNeighbor(space, kNeighborDistance))
+      continue;
+
+    int score = space == first_move ? std::numeric_limits<int>::max()
+                                    : worker.history[space];
+
+    // Insertion sort, highest score first.
+    int i = count++;
+    for (; i > 0 && scores[i - 1] < score; --i) {
+      moves[i] = moves[i - 1];
+      scores[i] = scores[i - 1];
+    }
+    moves[i] = space;
+    scores[i] = score;
+  }
+  return count;
+}
+
+bool MnkSearch::ShouldStop(Worker* worker) {
+  if (stopped_.load(std::memory_order_relaxed))
+    return true;
+  if (worker->nodes % kTimeCheckInterval == 0) {
+    // Count the nodes in batches so the threads don't fight over the total.
+    const int64_t nodes =
+        nodes_.fetch_add(kTimeCheckInterval, std::memory_order_relaxed) +
+        kTimeCheckInterval;
+    if (nodes >= limits_.max_nodes || deadline_.Expired()) {
+      stopped_ = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace Tictactoe
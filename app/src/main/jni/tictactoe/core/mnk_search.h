@@ -0,0 +1,130 @@
+////
+// mnk_search.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "tictactoe/core/search_util.h"
+#include "tictactoe/core/transposition_table.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace Tictactoe {
+
+class MnkBoard;
+
+// Limits for a single search.  The search stops at whichever is hit first.
+struct MnkSearchLimits {
+  MnkSearchLimits();
+
+  int max_depth;
+  // Counted across all threads, and checked every thousand or so nodes, so a
+  // search may go slightly over.
+  int64_t max_nodes;
+  // No time limit if zero.
+  TimeInterval max_time;
+  // Threads to search with, including the calling thread.  Limited by the
+  // size of SearchThreadPool().
+  int num_threads;
+  // Stop early once this is set, if not null.  Set from any thread.
+  const std::atomic<bool>* cancel;
+};
+
+struct MnkSearchResult {
+  MnkSearchResult();
+
+  double NodesPerSecond() const;
+
+  // The best space found, or -1 if the game is over.
+  int move;
+  // Score from the point of view of the player to move.
+  int score;
+  // The deepest fully searched iteration, by any thread.
+  int depth;
+  // Nodes searched by all threads.
+  int64_t nodes;
+  TimeInterval elapsed;
+  // Transposition table use during this search.
+  TranspositionTable::Counters table_counters;
+};
+
+// Negamax search with alpha-beta pruning, iterative deepening and a
+// transposition table, for any m,n,k board.  Positions that are rotations or
+// reflections of each other share a table entry.
+//
+// Searches on several threads use Lazy SMP: every thread runs its own
+// iterative deepening from the root on its own copy of the board, with half
+// the helpers a ply ahead of the main search, and they share only the
+// lock-free transposition table and a stop flag.  The threads speed each
+// other up through the table, and the result is the deepest iteration any
+// of them finished.  The threads come from the shared SearchThreadPool(),
+// so a search runs on at most one more thread than the pool has workers.
+class MnkSearch {
+ public:
+  // Scores at or above kWinScore - kMaxPly are wins, the higher the sooner.
+  static const int kWinScore = 1000000;
+  static const int kMaxPly = 512;
+  static const int kMaxThreads = kMaxSearchThreads;
+
+  // The transposition table holds 2^|table_bits| entries.
+  explicit MnkSearch(int table_bits);
+  ~MnkSearch();
+  DISALLOW_COPY_AND_ASSIGN(MnkSearch);
+
+  // Search for the best move for the player to move on |board|.  |board| is
+  // modified during the search but restored before returning.
+  MnkSearchResult Search(MnkBoard* board, const MnkSearchLimits& limits);
+
+  const TranspositionTable& table() const { return *table_; }
+
+ private:
+  class WorkerBody;
+  friend class WorkerBody;
+
+  // The state of one search thread.
+  struct Worker {
+    Worker();
+
+    // Worker 0 is the main search, which the others help.
+    int index;
+    MnkBoard* board;
+    // Cutoff counts by space, for move ordering.
+    std::vector<int> history;
+    TranspositionTable::Counters table_counters;
+    int64_t nodes;
+
+    // The thread's deepest complete iteration.
+    int move;
+    int score;
+    int depth;
+  };
+
+  // Run iterative deepening on |worker| until it reaches the depth limit or
+  // the search is stopped.
+  void RunWorker(Worker* worker);
+
+  int SearchRoot(Worker* worker, int depth, int first_move, int* best_move);
+  int Negamax(Worker* worker, int depth, int alpha, int beta, int ply);
+
+  // Fill |moves| with the candidate moves, best guesses first, and return
+  // the number of moves.
+  int GenerateMoves(const Worker& worker, int first_move, int* moves);
+
+  bool ShouldStop(Worker* worker);
+
+  std::unique_ptr<TranspositionTable> table_;
+
+  MnkSearchLimits limits_;
+  int max_depth_;
+  SearchDeadline deadline_;
+  // Nodes counted so far by all threads, added in batches.
+  std::atomic<int64_t> nodes_;
+  std::atomic<bool> stopped_;
+};
+
+}  // namespace Tictactoe
@@ -0,0 +1,85 @@
+////
+// mnk_state.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/logging.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/mnk_board.h"
+
+namespace Tictactoe {
+
+// Rulesets for MnkState, for boards with too many spaces for GameState.
+// Each one gives kWidth, kHeight and kK, as for GameState.
+struct FiveByFiveRules {
+  static const int kWidth = 5;
+  static const int kHeight = 5;
+  static const int kK = 4;
+};
+
+// A position on an m,n,k board whose size is fixed by |Rules|, for Game.
+// The marks live in an MnkBoard that the searches play on directly, and the
+// moves are kept so the last one can be taken back.
+template <typename Rules>
+class MnkState {
+ public:
+  static const int kWidth = Rules::kWidth;
+  static const int kHeight = Rules::kHeight;
+  static const int kLayers = 1;
+  static const int kK = Rules::kK;
+  static const int kNumSpaces = kWidth * kHeight;
+
+  MnkState() : board_(kWidth, kHeight, kK), num_moves_(0) {}
+
+  const MnkBoard& board() const { return board_; }
+
+  // The player to move, or kPlayerNone once the game is over.
+  Player turn() const { return board_.turn(); }
+  // The winning player.  kPlayerNone while playing or after a draw.
+  Player winner() const { return board_.winner(); }
+  bool game_over() const { return board_.game_over(); }
+
+  // The number of marks placed, and the space of each in the order played.
+  int num_moves() const { return num_moves_; }
+  int move(int i) const { return moves_[i]; }
+
+  Player Get(int space) const { return board_.Get(space); }
+  bool IsEmpty(int space) const { return board_.IsEmpty(space); }
+
+  // Place a mark for the player to move in |space|, then either advance the
+  // turn or end the game.
+  void PlaceMark(int space) {
+    DCHECK_LT(num_moves_, kNumSpaces);
+    board_.PlaceMark(space);
+    moves_[num_moves_++] = space;
+  }
+
+  // Take back the last mark placed, and return its space.  The player who
+  // placed it is to move again.
+  int RemoveLastMark() {
+    DCHECK_GT(num_moves_, 0);
+    const int space = moves_[--num_moves_];
+    board_.RemoveMark(space);
+    return space;
+  }
+
+ private:
+  MnkBoard board_;
+  int num_moves_;
+  int16_t moves_[kNumSpaces];
+};
+
+template <typename Rules>
+const int MnkState<Rules>::kWidth;
+template <typename Rules>
+const int MnkState<Rules>::kHeight;
+template <typename Rules>
+const int MnkState<Rules>::kLayers;
+template <typename Rules>
+const int MnkState<Rules>::kK;
+template <typename Rules>
+const int MnkState<Rules>::kNumSpaces;
+
+}  // namespace Tictactoe
@@ -0,0 +1,80 @@
+////
+// move_analysis.cpp
+////
+
+#include "tictactoe/core/move_analysis.h"
+
+#include "base/logging.h"
+
+#include <algorithm>
+
+namespace Tictactoe {
+
+namespace {
+// Larger than any game's length, so results never overlap in Rank().
+const int kResultRankStep = 1 << 16;
+}
+
+////
+// MoveScore
+////
+int MoveScore::Rank() const {
+  switch (result) {
+    case kResultWin:
+      return 2 * kResultRankStep - distance;
+    case kResultDraw:
+      return 0;
+    case kResultLoss:
+      return -2 * kResultRankStep + distance;
+    case kResultUnknown:
+      break;
+  }
+  return -4 * kResultRankStep;
+}
+
+////
+// MoveAnalysis
+////
+MoveAnalysis::MoveAnalysis() : complete(false), nodes(0) {}
+
+void MoveAnalysis::Reset(int num_spaces) {
+  scores.assign(num_spaces, MoveScore());
+  complete = false;
+  nodes = 0;
+}
+
+bool MoveAnalysis::IsBest(int space) const {
+  DCHECK_LT(space, static_cast<int>(scores.size()));
+  if (scores[space].result == MoveScore::kResultUnknown)
+    return false;
+  const int rank = scores[space].Rank();
+  for (const MoveScore& score : scores) {
+    if (score.Rank() > rank)
+      return false;
+  }
+  return true;
+}
+
+MoveGrade MoveAnalysis::Grade(int space) const {
+  DCHECK_LT(space, static_cast<int>(scores.size()));
+  const MoveScore& score = scores[space];
+  if (score.result == MoveScore::kResultUnknown)
+    return kMoveGradeUnknown;
+
+  MoveScore best = score;
+  for (const MoveScore& other : scores) {
+    if (other.Rank() > best.Rank())
+      best = other;
+  }
+  if (best.Rank() == score.Rank())
+    return kMoveGradeBest;
+  if (best.result == score.result)
+    return kMoveGradeGood;
+  if (best.result == MoveScore::kResultWin &&
+      score.result == MoveScore::kResultLoss) {
+    return kMoveGradeBlunder;
+  }
+  return kMoveGradeMistake;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,74 @@
+////
+// move_analysis.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+
+#include <vector>
+
+namespace Tictactoe {
+
+// The solved result of playing one space, for the player who plays it.
+struct MoveScore {
+  enum Result {
+    // Not solved, because the space is taken or the analysis ran out of
+    // time.
+    kResultUnknown,
+    kResultLoss,
+    kResultDraw,
+    kResultWin,
+  };
+
+  MoveScore() : result(kResultUnknown), distance(0) {}
+  MoveScore(Result result, int distance)
+      : result(result), distance(distance) {}
+
+  // Return a number that orders scores from worst to best: slower wins are
+  // worse than faster ones, and faster losses worse than slower ones.
+  int Rank() const;
+
+  Result result;
+  // Moves until the game ends with perfect play, counting this one and both
+  // players'.
+  int distance;
+};
+
+// How a move compares to the best one.
+enum MoveGrade {
+  kMoveGradeUnknown,
+  // One of the best moves.
+  kMoveGradeBest,
+  // The same result as the best move, but it takes longer to win or less
+  // long to lose.
+  kMoveGradeGood,
+  // A worse result than the best move: a draw given away, or a loss where
+  // there was a draw.
+  kMoveGradeMistake,
+  // A loss where there was a win.
+  kMoveGradeBlunder,
+};
+
+// The solved score of every empty space in a position, from one search
+// that shares its tree and table between the moves.
+struct MoveAnalysis {
+  MoveAnalysis();
+
+  // Start over for a position with |num_spaces| spaces.
+  void Reset(int num_spaces);
+
+  // Return true if |space| is solved and no other move scores better.
+  bool IsBest(int space) const;
+
+  // Grade playing |space| against the best solved move.
+  MoveGrade Grade(int space) const;
+
+  // Indexed by space.
+  std::vector<MoveScore> scores;
+  // True once every empty space is solved.
+  bool complete;
+  int64_t nodes;
+};
+
+}  // namespace Tictactoe
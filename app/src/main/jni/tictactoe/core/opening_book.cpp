@@ -0,0 +1,184 @@
+////
+// opening_book.cpp
+////
+
+#include "tictactoe/core/opening_book.h"
+
+#include "base/file/file.h"
+#include "base/file/file_manager.h"
+#include "base/logging.h"
+#include "base/util/random.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/symmetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace Tictactoe {
+
+namespace {
+const uint32_t kFileMagic = 0x4b4f4f42;  // "BOOK"
+const uint32_t kFileVersion = 1;
+const char kTempSuffix[] = ".tmp";
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t k;
+  uint32_t max_moves;
+  uint64_t num_entries;
+};
+
+bool EntryLess(const OpeningBook::Entry& a, const OpeningBook::Entry& b) {
+  if (a.hash != b.hash)
+    return a.hash < b.hash;
+  return a.move < b.move;
+}
+}
+
+// static
+std::string OpeningBook::GetAssetName(int width, int height, int k) {
+  char filename[48];
+  snprintf(filename, sizeof(filename), "assets/books/mnk_%d_%d_%d.book",
+           width, height, k);
+  return filename;
+}
+
+// static
+std::unique_ptr<OpeningBook> OpeningBook::Open(const std::string& filename) {
+  std::unique_ptr<File> file = FileManager::Get()->OpenAsset(filename);
+  if (!file)
+    return nullptr;
+
+  const size_t length = file->Length();
+  const uint8_t* contents = static_cast<const uint8_t*>(file->GetContents());
+  FileHeader header;
+  if (!contents || length < sizeof(header)) {
+    LOG(ERROR) << "Cannot read opening book " << filename;
+    return nullptr;
+  }
+  memcpy(&header, contents, sizeof(header));
+  if (header.magic != kFileMagic || header.version != kFileVersion ||
+      header.num_entries > (length - sizeof(header)) / sizeof(Entry)) {
+    LOG(ERROR) << "Bad opening book " << filename;
+    return nullptr;
+  }
+
+  return std::unique_ptr<OpeningBook>(new OpeningBook(
+      std::move(file), header.width, header.height, header.k,
+      header.max_moves, contents + sizeof(header), header.num_entries));
+}
+
+// static
+bool OpeningBook::Write(const std::string& filename,
+                        int width,
+                        int height,
+                        int k,
+                        int max_moves,
+                        std::vector<Entry> entries) {
+  std::sort(entries.begin(), entries.end(), EntryLess);
+
+  const std::string temp_file = filename + kTempSuffix;
+  std::unique_ptr<File> file = FileManager::Get()->WriteFile(temp_file, false);
+  if (!file) {
+    LOG(ERROR) << "Cannot write opening book " << temp_file;
+    return false;
+  }
+
+  FileHeader header = {};
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  header.width = width;
+  header.height = height;
+  header.k = k;
+  header.max_moves = max_moves;
+  header.num_entries = entries.size();
+  const size_t bytes = entries.size() * sizeof(Entry);
+  bool ok = file->Write(&header, sizeof(header)) == sizeof(header) &&
+            file->Write(entries.data(), bytes) == bytes;
+  file->Close();
+
+  if (!ok || !FileManager::Get()->Rename(temp_file, filename)) {
+    LOG(ERROR) << "Failed to save opening book " << filename;
+    return false;
+  }
+  return true;
+}
+
+OpeningBook::~OpeningBook() {}
+
+int OpeningBook::FindMove(const MnkBoard& board, Random* random) const {
+  if (board.width() != width_ || board.height() != height_ ||
+      board.k() != k_ || board.move_count() >= max_moves_ ||
+      board.game_over()) {
+    return -1;
+  }
+
+  int symmetry = 0;
+  const uint64_t hash = board.CanonicalHash(&symmetry);
+
+  // Find the first entry for the position.
+  size_t begin = 0;
+  size_t end = num_entries_;
+  while (begin < end) {
+    const size_t middle = begin + (end - begin) / 2;
+    if (GetEntry(middle).hash < hash)
+      begin = middle + 1;
+    else
+      end = middle;
+  }
+
+  uint32_t total_weight = 0;
+  for (end = begin; end < num_entries_; ++end) {
+    const Entry entry = GetEntry(end);
+    if (entry.hash != hash)
+      break;
+    total_weight += entry.weight;
+  }
+  if (!total_weight)
+    return -1;
+
+  // Pick by weight.
+  uint32_t pick = random->NextDouble() * total_weight;
+  for (size_t i = begin; i < end; ++i) {
+    const Entry entry = GetEntry(i);
+    if (pick < entry.weight) {
+      // A hash collision could name any space.
+      if (entry.move >= board.num_spaces())
+        return -1;
+      const int move =
+          board.TransformSpace(entry.move, InverseSymmetry(symmetry));
+      return board.IsEmpty(move) ? move : -1;
+    }
+    pick -= entry.weight;
+  }
+  NOTREACHED();
+  return -1;
+}
+
+// private:
+OpeningBook::OpeningBook(std::unique_ptr<File> file,
+                         int width,
+                         int height,
+                         int k,
+                         int max_moves,
+                         const uint8_t* entries,
+                         size_t num_entries)
+    : file_(std::move(file)),
+      width_(width),
+      height_(height),
+      k_(k),
+      max_moves_(max_moves),
+      entries_(entries),
+      num_entries_(num_entries) {}
+
+OpeningBook::Entry OpeningBook::GetEntry(size_t i) const {
+  Entry entry;
+  memcpy(&entry, entries_ + i * sizeof(Entry), sizeof(Entry));
+  return entry;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,91 @@
+////
+// opening_book.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class File;
+class Random;
+
+namespace Tictactoe {
+
+class MnkBoard;
+
+// Moves for the first few positions of an m,n,k game, built offline by the
+// book builder tool so the computer doesn't have to search them.  The book
+// is an app asset holding entries sorted by the position's canonical hash
+// from MnkBoard, which is used in place without copying and binary searched
+// on each probe.  A position can have several moves, each weighted by how
+// often the builder's games chose it.
+class OpeningBook {
+ public:
+  struct Entry {
+    // MnkBoard::CanonicalHash() of the position.
+    uint64_t hash;
+    // The move on the board as seen through the canonical symmetry.
+    uint16_t move;
+    uint16_t weight;
+    uint32_t reserved;
+  };
+
+  // Return the asset name of the book for the board size.
+  static std::string GetAssetName(int width, int height, int k);
+
+  // Open the book asset |filename|.  Returns null if there isn't one or
+  // it's corrupt.
+  static std::unique_ptr<OpeningBook> Open(const std::string& filename);
+
+  // Write a book of |entries|, which needn't be sorted, for positions with
+  // fewer than |max_moves| marks.  Returns false on failure.
+  static bool Write(const std::string& filename,
+                    int width,
+                    int height,
+                    int k,
+                    int max_moves,
+                    std::vector<Entry> entries);
+
+  ~OpeningBook();
+  DISALLOW_COPY_AND_ASSIGN(OpeningBook);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int k() const { return k_; }
+  // Positions with this many marks or more are never in the book.
+  int max_moves() const { return max_moves_; }
+  size_t num_entries() const { return num_entries_; }
+
+  // Return a move for |board| from the book, chosen at random by weight, or
+  // -1 if the position isn't in it.
+  int FindMove(const MnkBoard& board, Random* random) const;
+
+ private:
+  OpeningBook(std::unique_ptr<File> file,
+              int width,
+              int height,
+              int k,
+              int max_moves,
+              const uint8_t* entries,
+              size_t num_entries);
+
+  // Entries are read by copying, since assets may not be aligned.
+  Entry GetEntry(size_t i) const;
+
+  // Keeps the entries mapped.
+  std::unique_ptr<File> file_;
+
+  const int width_;
+  const int height_;
+  const int k_;
+  const int max_moves_;
+  const uint8_t* const entries_;
+  const size_t num_entries_;
+};
+
+}  // namespace Tictactoe
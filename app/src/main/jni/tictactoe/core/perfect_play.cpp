@@ -0,0 +1,194 @@
+////
+// perfect_play.cpp
+////
+
+#include "tictactoe/core/perfect_play.h"
+
+#include "base/util/bits.h"
+#include "tictactoe/core/symmetry.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+namespace Tictactoe {
+
+namespace {
+// Every position, indexed by TictactoeState::index().  Only built at compile
+// time, as a step towards the table of canonical positions below.
+struct PerfectPlayTable {
+  PerfectPlayEntry entries[TictactoeState::kNumIndices];
+};
+
+// Solve every position by working backwards from the highest index.  Placing
+// a mark only ever adds to the index, so every position a move leads to has
+// already been solved by the time it's needed.
+constexpr PerfectPlayTable GeneratePerfectPlayTable() {
+  PerfectPlayTable table{};
+  int digits[TictactoeState::kNumSpaces] = {2, 2, 2, 2, 2, 2, 2, 2, 2};
+
+  for (int index = TictactoeState::kNumIndices - 1; index >= 0; --index) {
+    uint16_t x_mask = 0;
+    uint16_t o_mask = 0;
+    int x_count = 0;
+    int o_count = 0;
+    for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+      if (digits[space] == kPlayerX) {
+        x_mask |= 1 << space;
+        x_count++;
+      } else if (digits[space] == kPlayerO) {
+        o_mask |= 1 << space;
+        o_count++;
+      }
+    }
+
+    PerfectPlayEntry& entry = table.entries[index];
+    entry.score = 0;
+    entry.move = -1;
+
+    // X always moves first.
+    int turn = kPlayerNone;
+    if (x_count == o_count)
+      turn = kPlayerX;
+    else if (x_count == o_count + 1)
+      turn = kPlayerO;
+
+    const int marks = x_count + o_count;
+    if (turn == kPlayerNone) {
+      // Unreachable position.
+    } else if (TictactoeState::HasLine(x_mask) ||
+               TictactoeState::HasLine(o_mask)) {
+      // The previous player won.
+      entry.score = -(TictactoeState::kNumSpaces + 1 - marks);
+    } else if (marks < TictactoeState::kNumSpaces) {
+      int best_score = -128;
+      for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+        if (digits[space] != kPlayerNone)
+          continue;
+
+        const int child = index + turn * TictactoeState::PowerOf3(space);
+        const int score = -table.entries[child].score;
+        if (score > best_score) {
+          best_score = score;
+          entry.move = space;
+        }
+      }
+      entry.score = best_score;
+    }
+
+    // Step to the next lower index.
+    for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+      if (digits[space]--)
+        break;
+      digits[space] = 2;
+    }
+  }
+
+  return table;
+}
+
+constexpr void GetMasks(int index, uint16_t* x_mask, uint16_t* o_mask) {
+  *x_mask = 0;
+  *o_mask = 0;
+  for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+    const int digit = index % 3;
+    index /= 3;
+    if (digit == kPlayerX)
+      *x_mask |= 1 << space;
+    else if (digit == kPlayerO)
+      *o_mask |= 1 << space;
+  }
+}
+
+// Only positions with a legal number of marks that are the canonical member
+// of their symmetry group are stored.
+constexpr bool IsStored(int index) {
+  uint16_t x_mask = 0;
+  uint16_t o_mask = 0;
+  GetMasks(index, &x_mask, &o_mask);
+  const int x_count = bits::CountSetBits(x_mask);
+  const int o_count = bits::CountSetBits(o_mask);
+  if (x_count != o_count && x_count != o_count + 1)
+    return false;
+  int symmetry = 0;
+  return TictactoeSymmetry::CanonicalIndex(x_mask, o_mask, &symmetry) == index;
+}
+
+constexpr int CountStoredPositions() {
+  int count = 0;
+  for (int index = 0; index < TictactoeState::kNumIndices; ++index) {
+    if (IsStored(index))
+      count++;
+  }
+  return count;
+}
+
+const int kNumStoredPositions = CountStoredPositions();
+
+// The canonical positions, sorted by index, with their entries.  About an
+// eighth the size of the full table.
+struct CanonicalPerfectPlayTable {
+  int16_t indices[kNumStoredPositions];
+  PerfectPlayEntry entries[kNumStoredPositions];
+};
+
+constexpr CanonicalPerfectPlayTable GenerateCanonicalPerfectPlayTable() {
+  const PerfectPlayTable solved = GeneratePerfectPlayTable();
+  CanonicalPerfectPlayTable table{};
+  int count = 0;
+  for (int index = 0; index < TictactoeState::kNumIndices; ++index) {
+    if (!IsStored(index))
+      continue;
+    table.indices[count] = index;
+    table.entries[count] = solved.entries[index];
+    count++;
+  }
+  return table;
+}
+
+constexpr CanonicalPerfectPlayTable kCanonicalPerfectPlayTable =
+    GenerateCanonicalPerfectPlayTable();
+
+constexpr PerfectPlayEntry Lookup(uint16_t x_mask, uint16_t o_mask) {
+  int symmetry = 0;
+  const int index =
+      TictactoeSymmetry::CanonicalIndex(x_mask, o_mask, &symmetry);
+
+  // Binary search for the canonical position.
+  int low = 0;
+  int high = kNumStoredPositions;
+  while (low < high) {
+    const int middle = (low + high) / 2;
+    if (kCanonicalPerfectPlayTable.indices[middle] < index)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low == kNumStoredPositions ||
+      kCanonicalPerfectPlayTable.indices[low] != index) {
+    return PerfectPlayEntry{0, -1};
+  }
+
+  // Turn the canonical move back around to match the position.
+  PerfectPlayEntry entry = kCanonicalPerfectPlayTable.entries[low];
+  if (entry.move >= 0) {
+    entry.move = TictactoeSymmetry::TransformSpace(entry.move,
+                                                   InverseSymmetry(symmetry));
+  }
+  return entry;
+}
+
+// Spot check the table against known results.
+static_assert(Lookup(0, 0).score == 0, "The empty board should be a draw");
+static_assert(Lookup(0x001, 0x010).score == 0,
+              "Answering a corner with the center should draw");
+static_assert(Lookup(0x001, 0x002).score > 0,
+              "Answering a corner with an adjacent side should lose");
+static_assert(Lookup(0x101, 0x010).move % 2 == 1,
+              "O should take a side against opposite corners");
+static_assert(Lookup(0x180, 0x010).move == 6,
+              "X should complete the bottom row");
+}
+
+PerfectPlayEntry LookupPerfectPlay(const TictactoeState& state) {
+  return Lookup(state.mask(kPlayerX), state.mask(kPlayerO));
+}
+
+}  // namespace Tictactoe
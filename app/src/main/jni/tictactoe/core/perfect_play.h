@@ -0,0 +1,28 @@
+////
+// perfect_play.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+namespace Tictactoe {
+
+// The solved result of a position, from the point of view of the player to
+// move.
+struct PerfectPlayEntry {
+  // Positive for a win, negative for a loss and 0 for a draw.  Faster wins
+  // and slower losses have a larger magnitude.
+  int8_t score;
+  // The best space to play, or -1 if the game is over or the position can't
+  // be reached.
+  int8_t move;
+};
+
+// Look up the solved result for |state|.  The table is generated at compile
+// time and only holds one position from each set of symmetric positions, so
+// the move is turned to match |state| on the way out.
+PerfectPlayEntry LookupPerfectPlay(const TictactoeState& state);
+
+}  // namespace Tictactoe
@@ -0,0 +1,193 @@
+////
+// qubic_board.cpp
+////
+
+#include "tictactoe/core/qubic_board.h"
+
+#include "base/util/bits.h"
+
+namespace Tictactoe {
+
+namespace {
+const int kSize = QubicBoard::kWidth;
+
+// The score of a line holding only one player's marks, by how many it holds.
+// Three is a threat to win next move.
+constexpr int kLineWeights[] = {0, 1, 6, 40, 0};
+
+struct LineTable {
+  int count;
+  uint64_t masks[QubicBoard::kNumLines];
+  // The lines through each space, as indices into |masks|.
+  int8_t space_lines[QubicBoard::kNumSpaces][QubicBoard::kMaxSpaceLines];
+  int8_t space_line_counts[QubicBoard::kNumSpaces];
+};
+
+constexpr int SpaceAt(int x, int y, int z) {
+  return (z * kSize + y) * kSize + x;
+}
+
+constexpr bool InCube(int x, int y, int z) {
+  return x >= 0 && x < kSize && y >= 0 && y < kSize && z >= 0 && z < kSize;
+}
+
+// Lines run in 13 directions: one of each pair of opposite steps.  Since a
+// line spans the cube, each starts on the face it enters from.
+constexpr LineTable GenerateLineTable() {
+  LineTable table{};
+  for (int dz = -1; dz <= 1; ++dz) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        // Keep the step whose first nonzero component is positive.
+        const int first = dz ? dz : dy ? dy : dx;
+        if (first <= 0)
+          continue;
+        for (int z = 0; z < kSize; ++z) {
+          for (int y = 0; y < kSize; ++y) {
+            for (int x = 0; x < kSize; ++x) {
+              if (InCube(x - dx, y - dy, z - dz) ||
+                  !InCube(x + 3 * dx, y + 3 * dy, z + 3 * dz)) {
+                continue;
+              }
+              uint64_t mask = 0;
+              for (int i = 0; i < kSize; ++i)
+                mask |= 1ull << SpaceAt(x + i * dx, y + i * dy, z + i * dz);
+              table.masks[table.count++] = mask;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int space = 0; space < QubicBoard::kNumSpaces; ++space) {
+    int space_count = 0;
+    for (int i = 0; i < QubicBoard::kNumLines; ++i) {
+      if ((table.masks[i] >> space) & 1)
+        table.space_lines[space][space_count++] = i;
+    }
+    table.space_line_counts[space] = space_count;
+  }
+  return table;
+}
+
+constexpr LineTable kLines = GenerateLineTable();
+static_assert(kLines.count == QubicBoard::kNumLines, "Qubic has 76 lines");
+
+// Return the score for X of a line holding these marks.
+int LineScore(uint64_t x_marks, uint64_t o_marks) {
+  if (o_marks == 0)
+    return kLineWeights[bits::CountSetBits64(x_marks)];
+  if (x_marks == 0)
+    return -kLineWeights[bits::CountSetBits64(o_marks)];
+  return 0;
+}
+
+uint64_t Mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdull;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ull;
+  value ^= value >> 33;
+  return value;
+}
+}
+
+const int QubicBoard::kWidth;
+const int QubicBoard::kHeight;
+const int QubicBoard::kLayers;
+const int QubicBoard::kNumSpaces;
+const int QubicBoard::kNumLines;
+const int QubicBoard::kMaxSpaceLines;
+
+QubicBoard::QubicBoard()
+    : x_mask_(0),
+      o_mask_(0),
+      score_(0),
+      turn_(kPlayerX),
+      winner_(kPlayerNone),
+      num_moves_(0) {}
+
+// static
+uint64_t QubicBoard::LineMask(int i) {
+  DCHECK_GE(i, 0);
+  DCHECK_LT(i, kNumLines);
+  return kLines.masks[i];
+}
+
+// static
+int QubicBoard::CountSpaceLines(int space) {
+  return kLines.space_line_counts[space];
+}
+
+uint64_t QubicBoard::hash() const {
+  return Mix(x_mask_) ^ Mix(o_mask_ ^ 0x9e3779b97f4a7c15ull);
+}
+
+void QubicBoard::PlaceMark(int space) {
+  DCHECK_NE(turn_, kPlayerNone);
+  DCHECK(IsEmpty(space));
+
+  ScoreSpaceLines(space, -1);
+  uint64_t* marks = turn_ == kPlayerX ? &x_mask_ : &o_mask_;
+  *marks |= 1ull << space;
+  moves_[num_moves_++] = space;
+  const bool completes_line = ScoreSpaceLines(space, 1);
+
+  if (completes_line) {
+    winner_ = turn_;
+    turn_ = kPlayerNone;
+  } else if (!empty_mask()) {
+    // No spaces remain, it's a draw.
+    turn_ = kPlayerNone;
+  } else {
+    turn_ = turn_ == kPlayerX ? kPlayerO : kPlayerX;
+  }
+}
+
+int QubicBoard::RemoveLastMark() {
+  DCHECK_GT(num_moves_, 0);
+
+  const int space = moves_[--num_moves_];
+  const Player player = Get(space);
+  ScoreSpaceLines(space, -1);
+  uint64_t* marks = player == kPlayerX ? &x_mask_ : &o_mask_;
+  *marks &= ~(1ull << space);
+  ScoreSpaceLines(space, 1);
+
+  // The game can only have ended on the last move, so taking it back always
+  // returns to play.
+  turn_ = player;
+  winner_ = kPlayerNone;
+  return space;
+}
+
+uint64_t QubicBoard::Threats(Player player) const {
+  DCHECK_NE(player, kPlayerNone);
+  const uint64_t marks = player == kPlayerX ? x_mask_ : o_mask_;
+  const uint64_t opponent_marks = player == kPlayerX ? o_mask_ : x_mask_;
+
+  uint64_t threats = 0;
+  for (int i = 0; i < kNumLines; ++i) {
+    const uint64_t line = kLines.masks[i];
+    if (!(opponent_marks & line) && bits::CountSetBits64(marks & line) == 3)
+      threats |= line & ~marks;
+  }
+  return threats;
+}
+
+// private:
+bool QubicBoard::ScoreSpaceLines(int space, int sign) {
+  const int count = kLines.space_line_counts[space];
+  bool full = false;
+  for (int i = 0; i < count; ++i) {
+    const uint64_t line = kLines.masks[kLines.space_lines[space][i]];
+    const uint64_t x_marks = x_mask_ & line;
+    const uint64_t o_marks = o_mask_ & line;
+    score_ += sign * LineScore(x_marks, o_marks);
+    full |= x_marks == line || o_marks == line;
+  }
+  return full;
+}
+
+}  // namespace Tictactoe
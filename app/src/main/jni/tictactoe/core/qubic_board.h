@@ -0,0 +1,106 @@
+////
+// qubic_board.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/logging.h"
+#include "tictactoe/constants.h"
+
+namespace Tictactoe {
+
+// A Qubic position: 3D tic tac toe on a 4x4x4 cube, where the first player
+// to fill one of the 76 lines of four wins.  Space (x, y, z) is bit
+// z * 16 + y * 4 + x of each player's mask, so a layer is a 4x4 board
+// numbered left to right, top to bottom.
+class QubicBoard {
+ public:
+  static const int kWidth = 4;
+  static const int kHeight = 4;
+  static const int kLayers = 4;
+  static const int kNumSpaces = kWidth * kHeight * kLayers;
+  static const int kNumLines = 76;
+  // Corners and the 8 center spaces are on 7 lines, the rest on 4.
+  static const int kMaxSpaceLines = 7;
+
+  QubicBoard();
+
+  // The mask of line |i|, for |i| below kNumLines.
+  static uint64_t LineMask(int i);
+
+  // The number of lines through |space|.
+  static int CountSpaceLines(int space);
+
+  // The player to move, or kPlayerNone once the game is over.
+  Player turn() const { return turn_; }
+  // The winning player.  kPlayerNone while playing or after a draw.
+  Player winner() const { return winner_; }
+  bool game_over() const { return turn_ == kPlayerNone; }
+
+  // The number of marks placed, and the space of each in the order played.
+  int num_moves() const { return num_moves_; }
+  int move(int i) const { return moves_[i]; }
+
+  uint64_t mask(Player player) const {
+    switch (player) {
+      case kPlayerX:
+        return x_mask_;
+      case kPlayerO:
+        return o_mask_;
+      case kPlayerNone:
+        return empty_mask();
+    }
+    NOTREACHED();
+    return 0;
+  }
+  uint64_t empty_mask() const { return ~(x_mask_ | o_mask_); }
+
+  Player Get(int space) const {
+    DCHECK_GE(space, 0);
+    DCHECK_LT(space, kNumSpaces);
+    if ((x_mask_ >> space) & 1)
+      return kPlayerX;
+    if ((o_mask_ >> space) & 1)
+      return kPlayerO;
+    return kPlayerNone;
+  }
+  bool IsEmpty(int space) const { return (empty_mask() >> space) & 1; }
+
+  // A hash of the marks on the board.  The masks decide whose turn it is,
+  // so this is all a position needs.
+  uint64_t hash() const;
+
+  // Place a mark for the player to move in |space|, then either advance the
+  // turn or end the game.
+  void PlaceMark(int space);
+
+  // Take back the last mark placed, and return its space.  The player who
+  // placed it is to move again.
+  int RemoveLastMark();
+
+  // Return a mask of the empty spaces that would complete a line for
+  // |player|.  Each is a line where |player| has three marks and the
+  // opponent none.
+  uint64_t Threats(Player player) const;
+
+  // Heuristic value of the position for the player to move.  Weighs the
+  // marks in every line that only one player has entered.
+  int Evaluate() const { return turn_ == kPlayerO ? -score_ : score_; }
+
+ private:
+  // Add |sign| times the score of every line through |space| to score_,
+  // and return true if one of them is full of one player's marks.
+  bool ScoreSpaceLines(int space, int sign);
+
+  uint64_t x_mask_;
+  uint64_t o_mask_;
+  // Evaluate() for X, updated as marks are placed and removed.
+  int score_;
+  Player turn_;
+  Player winner_;
+  int8_t num_moves_;
+  int8_t moves_[kNumSpaces];
+};
+
+}  // namespace Tictactoe
@@ -0,0 +1,98 @@
+////
+// qubic_player.cpp
+////
+
+#include "tictactoe/core/qubic_player.h"
+
+#include "base/logging.h"
+#include "base/util/bits.h"
+#include "tictactoe/core/qubic_search.h"
+
+namespace Tictactoe {
+
+namespace {
+const int kSearchTableBits = 17;
+
+// Search time per move.  Impossible uses the whole budget for a move on a
+// phone core, Expert half of it.
+const double kExpertSearchSeconds = 0.05;
+const double kImpossibleSearchSeconds = 0.1;
+}
+
+QubicPlayer::QubicPlayer(Difficulty difficulty)
+    : QubicPlayer(difficulty, Random::get()->Next()) {}
+
+QubicPlayer::QubicPlayer(Difficulty difficulty, uint32_t seed)
+    : difficulty_(difficulty),
+      max_search_time_(TimeInterval::FromSeconds(
+          difficulty == kDifficultyImpossible ||
+                  difficulty == kDifficultyThreatSpace
+              ? kImpossibleSearchSeconds
+              : kExpertSearchSeconds)),
+      random_(seed) {
+  if (difficulty_ == kDifficultyExpert ||
+      difficulty_ == kDifficultyMonteCarlo ||
+      difficulty_ == kDifficultyImpossible ||
+      difficulty_ == kDifficultyThreatSpace) {
+    search_ = std::make_unique<QubicSearch>(kSearchTableBits);
+  }
+}
+
+QubicPlayer::~QubicPlayer() {}
+
+int QubicPlayer::ChooseMove(const QubicBoard& board,
+                            const std::atomic<bool>* cancel) {
+  DCHECK(!board.game_over());
+
+  switch (difficulty_) {
+    // There's no Monte Carlo engine for Qubic, so it searches like Expert.
+    // The search already answers threats without spending depth, so threat
+    // space plays like Impossible.
+    case kDifficultyThreatSpace:
+    case kDifficultyImpossible:
+    case kDifficultyExpert:
+    case kDifficultyMonteCarlo:
+      return FindSearchMove(board, cancel);
+
+    case kDifficultyHard: {
+      const Player player = board.turn();
+      const Player opponent = player == kPlayerX ? kPlayerO : kPlayerX;
+
+      // Check if there is a winning move.
+      uint64_t spaces = board.Threats(player);
+      if (spaces)
+        return bits::FindFirstSet64(spaces);
+
+      // Block any winning move.
+      spaces = board.Threats(opponent);
+      if (spaces)
+        return bits::FindFirstSet64(spaces);
+
+      return FindRandomMove(board.empty_mask());
+    }
+
+    case kDifficultyEasy:
+      break;
+  }
+  return FindRandomMove(board.empty_mask());
+}
+
+// private:
+int QubicPlayer::FindSearchMove(const QubicBoard& board,
+                                const std::atomic<bool>* cancel) {
+  QubicBoard search_board = board;
+  QubicSearchResult result =
+      search_->Search(&search_board, max_search_time_, cancel);
+  DLOG(INFO) << "Qubic search depth " << result.depth << ", " << result.nodes
+             << " nodes, " << result.NodesPerSecond() << " nodes/sec, "
+             << result.table_counters.HitRate() * 100 << "% table hits";
+  return result.move;
+}
+
+int QubicPlayer::FindRandomMove(uint64_t spaces) {
+  DCHECK(spaces);
+  const int offset = random_.NextDouble() * bits::CountSetBits64(spaces);
+  return bits::FindNthSet64(spaces, offset);
+}
+
+}  // namespace Tictactoe
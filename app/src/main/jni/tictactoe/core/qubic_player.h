@@ -0,0 +1,55 @@
+////
+// qubic_player.h
+////
+
+#pragma once
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/qubic_board.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+class QubicSearch;
+
+// Picks the computer's Qubic moves for one difficulty.  ChooseMove() may run
+// on any one thread at a time.
+class QubicPlayer : public base::RefCountedThreadSafe<QubicPlayer> {
+ public:
+  // Seed the random moves from the global generator.  Must be created on the
+  // UI thread.
+  explicit QubicPlayer(Difficulty difficulty);
+  // Seed the random moves from |seed|.
+  QubicPlayer(Difficulty difficulty, uint32_t seed);
+  ~QubicPlayer();
+  DISALLOW_COPY_AND_ASSIGN(QubicPlayer);
+
+  // The time limit for each move's search.  Defaults to the difficulty's.
+  void set_max_search_time(const TimeInterval& max_search_time) {
+    max_search_time_ = max_search_time;
+  }
+
+  // Choose a move for the player to move on |board|.  The search stops early
+  // once |cancel| is set, in which case the move may be weaker.
+  int ChooseMove(const QubicBoard& board, const std::atomic<bool>* cancel);
+
+ private:
+  int FindSearchMove(const QubicBoard& board, const std::atomic<bool>* cancel);
+  int FindRandomMove(uint64_t spaces);
+
+  const Difficulty difficulty_;
+  TimeInterval max_search_time_;
+
+  std::unique_ptr<QubicSearch> search_;
+
+  // The global generator belongs to the UI thread.
+  Random random_;
+};
+
+}  // namespace Tictactoe
@@ -0,0 +1,240 @@
+////
+// qubic_search.cpp
+////
+
+#include "tictactoe/core/qubic_search.h"
+
+#include "base/logging.h"
+#include "base/util/bits.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Tictactoe {
+
+namespace {
+typedef SearchScores<QubicSearch::kWinScore, QubicSearch::kMaxPly> Scores;
+
+Player Opponent(Player player) {
+  return player == kPlayerX ? kPlayerO : kPlayerX;
+}
+}
+
+////
+// QubicSearchResult
+////
+QubicSearchResult::QubicSearchResult()
+    : move(-1), score(0), depth(0), nodes(0) {}
+
+double QubicSearchResult::NodesPerSecond() const {
+  if (elapsed.Seconds() <= 0)
+    return 0;
+  return nodes / elapsed.Seconds();
+}
+
+////
+// QubicSearch
+////
+const int QubicSearch::kWinScore;
+const int QubicSearch::kMaxPly;
+
+QubicSearch::QubicSearch(int table_bits)
+    : table_(new TranspositionTable(table_bits)),
+      history_{},
+      nodes_(0),
+      stopped_(false) {}
+
+QubicSearch::~QubicSearch() {}
+
+QubicSearchResult QubicSearch::Search(QubicBoard* board,
+                                      TimeInterval max_time,
+                                      const std::atomic<bool>* cancel) {
+  const Timestamp start = Timestamp::Now();
+  deadline_.Start(max_time, cancel);
+  nodes_ = 0;
+  stopped_ = false;
+  table_counters_ = TranspositionTable::Counters();
+  table_->NewSearch();
+  std::fill(std::begin(history_), std::end(history_), 0);
+
+  QubicSearchResult result;
+  if (board->game_over())
+    return result;
+
+  const int max_depth = bits::CountSetBits64(board->empty_mask());
+  for (int depth = 1; depth <= max_depth; ++depth) {
+    int move = -1;
+    const int score = SearchRoot(board, depth, result.move, &move);
+    if (stopped_) {
+      // Keep the last complete iteration, unless there isn't one yet.
+      if (result.move == -1)
+        result.move = move;
+      break;
+    }
+
+    result.move = move;
+    result.score = score;
+    result.depth = depth;
+
+    // Stop once the result is known.
+    if (Scores::IsWin(score))
+      break;
+  }
+
+  table_->AddCounters(table_counters_);
+  result.nodes = nodes_;
+  result.elapsed = Timestamp::Now() - start;
+  result.table_counters = table_counters_;
+  return result;
+}
+
+// private:
+int QubicSearch::SearchRoot(QubicBoard* board,
+                            int depth,
+                            int first_move,
+                            int* best_move) {
+  const Player player = board->turn();
+
+  // Take a win if there is one.
+  const uint64_t wins = board->Threats(player);
+  if (wins) {
+    *best_move = bits::FindFirstSet64(wins);
+    return kWinScore - 1;
+  }
+
+  // Block the opponent's threats.  If there's more than one, the game is
+  // lost whichever is blocked.
+  const uint64_t blocks = board->Threats(Opponent(player));
+  int moves[QubicBoard::kNumSpaces];
+  const int count =
+      OrderMoves(blocks ? blocks : board->empty_mask(), first_move, moves);
+  DCHECK_GT(count, 0);
+
+  int alpha = -Scores::kInfinity;
+  *best_move = moves[0];
+  for (int i = 0; i < count; ++i) {
+    board->PlaceMark(moves[i]);
+    const int score = -Negamax(board, depth - 1, -Scores::kInfinity, -alpha, 1);
+    board->RemoveLastMark();
+    if (stopped_)
+      break;
+
+    if (score > alpha) {
+      alpha = score;
+      *best_move = moves[i];
+    }
+  }
+  return alpha;
+}
+
+int QubicSearch::Negamax(QubicBoard* board,
+                         int depth,
+                         int alpha,
+                         int beta,
+                         int ply) {
+  nodes_++;
+  if (board->game_over()) {
+    // The previous player either won or filled the board.
+    if (board->winner() != kPlayerNone)
+      return -(kWinScore - ply);
+    return 0;
+  }
+  if (ShouldStop())
+    return 0;
+
+  // A player with a threat wins on their move.
+  const Player player = board->turn();
+  if (board->Threats(player))
+    return kWinScore - (ply + 1);
+
+  // Otherwise they must block the opponent's threats, and can only block
+  // one.  A single block is forced, so it doesn't use up depth.
+  const uint64_t blocks = board->Threats(Opponent(player));
+  if (blocks & (blocks - 1))
+    return -(kWinScore - (ply + 2));
+  if (blocks) {
+    board->PlaceMark(bits::FindFirstSet64(blocks));
+    const int score = -Negamax(board, depth, -beta, -alpha, ply + 1);
+    board->RemoveLastMark();
+    return score;
+  }
+
+  if (depth <= 0)
+    return board->Evaluate();
+
+  // Probe the transposition table.
+  const uint64_t hash = board->hash();
+  TranspositionTable::Entry entry;
+  int table_move = -1;
+  if (table_->Probe(hash, &entry, &table_counters_)) {
+    table_move = entry.move;
+    int score;
+    if (Scores::ProbeCutoff(entry, depth, ply, &alpha, &beta, &score))
+      return score;
+  }
+
+  int moves[QubicBoard::kNumSpaces];
+  const int count = OrderMoves(board->empty_mask(), table_move, moves);
+
+  const int original_alpha = alpha;
+  int best_score = -Scores::kInfinity;
+  int best_move = -1;
+  for (int i = 0; i < count; ++i) {
+    board->PlaceMark(moves[i]);
+    const int score = -Negamax(board, depth - 1, -beta, -alpha, ply + 1);
+    board->RemoveLastMark();
+    if (stopped_)
+      return 0;
+
+    if (score > best_score) {
+      best_score = score;
+      best_move = moves[i];
+    }
+    if (score > alpha)
+      alpha = score;
+    if (alpha >= beta) {
+      history_[moves[i]] += depth * depth;
+      break;
+    }
+  }
+
+  // Store the result.
+  Scores::FillEntry(best_score, best_move, depth, ply, original_alpha, beta,
+                    &entry);
+  table_->Store(hash, entry, &table_counters_);
+
+  return best_score;
+}
+
+int QubicSearch::OrderMoves(uint64_t candidates,
+                            int first_move,
+                            int* moves) const {
+  int scores[QubicBoard::kNumSpaces];
+  int count = 0;
+  for (; candidates; candidates &= candidates - 1) {
+    const int space = bits::FindFirstSet64(candidates);
+
+    // Before any cutoffs, prefer the spaces on the most lines.
+    const int score = space == first_move
+                          ? std::numeric_limits<int>::max()
+                          : history_[space] + QubicBoard::CountSpaceLines(space);
+
+    // Insertion sort, highest score first.
+    int i = count++;
+    for (; i > 0 && scores[i - 1] < score; --i) {
+      moves[i] = moves[i - 1];
+      scores[i] = scores[i - 1];
+    }
+    moves[i] = space;
+    scores[i] = score;
+  }
+  return count;
+}
+
+bool QubicSearch::ShouldStop() {
+  if (!stopped_ && nodes_ % kTimeCheckInterval == 0)
+    stopped_ = deadline_.Expired();
+  return stopped_;
+}
+
+}  // namespace Tictactoe
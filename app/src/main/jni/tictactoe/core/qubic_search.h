@@ -0,0 +1,77 @@
+////
+// qubic_search.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "tictactoe/core/qubic_board.h"
+#include "tictactoe/core/search_util.h"
+#include "tictactoe/core/transposition_table.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+struct QubicSearchResult {
+  QubicSearchResult();
+
+  double NodesPerSecond() const;
+
+  // The best space found, or -1 if the game is over.
+  int move;
+  // Score from the point of view of the player to move.
+  int score;
+  // The deepest fully searched iteration.
+  int depth;
+  int64_t nodes;
+  TimeInterval elapsed;
+  // Transposition table use during this search.
+  TranspositionTable::Counters table_counters;
+};
+
+// Negamax search with alpha-beta pruning, iterative deepening and a
+// transposition table, for Qubic.  Threats are found with one popcount per
+// line, so a player who can win does, a player facing one threat blocks it
+// without spending depth, and two threats at once are scored as lost.
+class QubicSearch {
+ public:
+  // Scores at or above kWinScore - kMaxPly are wins, the higher the sooner.
+  static const int kWinScore = 1000000;
+  static const int kMaxPly = QubicBoard::kNumSpaces + 2;
+
+  // The transposition table holds 2^|table_bits| entries.
+  explicit QubicSearch(int table_bits);
+  ~QubicSearch();
+  DISALLOW_COPY_AND_ASSIGN(QubicSearch);
+
+  // Search for the best move for the player to move on |board|, for up to
+  // |max_time|, or until |cancel| is set if it isn't null.  |board| is
+  // modified during the search but restored before returning.
+  QubicSearchResult Search(QubicBoard* board,
+                           TimeInterval max_time,
+                           const std::atomic<bool>* cancel);
+
+ private:
+  int SearchRoot(QubicBoard* board, int depth, int first_move, int* best_move);
+  int Negamax(QubicBoard* board, int depth, int alpha, int beta, int ply);
+
+  // Fill |moves| with the spaces in |candidates|, best guesses first, and
+  // return the number of moves.
+  int OrderMoves(uint64_t candidates, int first_move, int* moves) const;
+
+  bool ShouldStop();
+
+  std::unique_ptr<TranspositionTable> table_;
+  TranspositionTable::Counters table_counters_;
+  int history_[QubicBoard::kNumSpaces];
+
+  SearchDeadline deadline_;
+  int64_t nodes_;
+  bool stopped_;
+};
+
+}  // namespace Tictactoe
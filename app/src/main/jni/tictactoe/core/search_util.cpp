@@ -0,0 +1,44 @@
+////
+// search_util.cpp
+////
+
+#include "tictactoe/core/search_util.h"
+
+#include "base/math/math.h"
+#include "base/thread/thread_pool.h"
+#include "base/thread/thread_util.h"
+
+namespace Tictactoe {
+
+namespace {
+ThreadPool* CreateSearchThreadPool() {
+  const int num_workers =
+      math::Clamp(thread::GetProcessorCount() - 1, 1, kMaxSearchThreads - 1);
+  ThreadPool* pool = new ThreadPool(num_workers);
+  pool->Start();
+  return pool;
+}
+}
+
+ThreadPool* SearchThreadPool() {
+  // Leaked, so a search still running at exit doesn't race its destructor.
+  static ThreadPool* g_pool = CreateSearchThreadPool();
+  return g_pool;
+}
+
+SearchDeadline::SearchDeadline() : has_deadline_(false), cancel_(nullptr) {}
+
+void SearchDeadline::Start(TimeInterval max_time,
+                           const std::atomic<bool>* cancel) {
+  has_deadline_ = max_time > TimeInterval();
+  deadline_ = Timestamp::Now() + max_time;
+  cancel_ = cancel;
+}
+
+bool SearchDeadline::Expired() const {
+  if (cancel_ && cancel_->load(std::memory_order_relaxed))
+    return true;
+  return has_deadline_ && Timestamp::Now() >= deadline_;
+}
+
+}  // namespace Tictactoe
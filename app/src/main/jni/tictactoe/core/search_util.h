@@ -0,0 +1,130 @@
+////
+// search_util.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/time.h"
+#include "tictactoe/core/transposition_table.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+
+class ThreadPool;
+
+// Helpers shared by the negamax searches: MnkSearch, GameSearch and
+// QubicSearch.
+
+namespace Tictactoe {
+
+// How often the searches check the clock, in nodes.
+const int64_t kTimeCheckInterval = 1024;
+
+// The most threads a parallel search uses, including the calling thread.
+const int kMaxSearchThreads = 16;
+
+// The pool that parallel searches run their helper threads on, shared by
+// every search in the process so they don't each start their own threads.
+// It has a worker for each processor besides the calling thread, up to
+// kMaxSearchThreads - 1, and is started on first use and never stopped.
+ThreadPool* SearchThreadPool();
+
+// Scores for a negamax search whose wins score |WinScore| less the ply the
+// game is won on, so scores at or above WinScore - MaxPly are wins, the
+// higher the sooner.
+template <int WinScore, int MaxPly>
+struct SearchScores {
+  // Above any score, for the initial alpha-beta window.
+  static const int kInfinity = WinScore + 1;
+
+  static bool IsWin(int score) { return abs(score) >= WinScore - MaxPly; }
+
+  // Win scores are stored relative to the node rather than the root, so they
+  // stay correct when the position is reached at a different ply.
+  static int ToTable(int score, int ply) {
+    if (!IsWin(score))
+      return score;
+    return score > 0 ? score + ply : score - ply;
+  }
+
+  static int FromTable(int score, int ply) {
+    if (!IsWin(score))
+      return score;
+    return score > 0 ? score - ply : score + ply;
+  }
+
+  // Narrow the window to the bound |entry| gives a node searched |depth|
+  // deep at |ply|, if it was searched at least as deep.  Returns true, with
+  // the node's |score|, if that settles the node.
+  static bool ProbeCutoff(const TranspositionTable::Entry& entry,
+                          int depth,
+                          int ply,
+                          int* alpha,
+                          int* beta,
+                          int* score) {
+    if (entry.depth < depth)
+      return false;
+    *score = FromTable(entry.score, ply);
+    switch (entry.bound) {
+      case TranspositionTable::kBoundExact:
+        return true;
+      case TranspositionTable::kBoundLower:
+        *alpha = std::max(*alpha, *score);
+        break;
+      case TranspositionTable::kBoundUpper:
+        *beta = std::min(*beta, *score);
+        break;
+      case TranspositionTable::kBoundNone:
+        break;
+    }
+    return *alpha >= *beta;
+  }
+
+  // Fill |entry| with the result of a node searched |depth| deep at |ply|
+  // with the window (|original_alpha|, |beta|).  |best_move| is as it's
+  // stored in the table.
+  static void FillEntry(int best_score,
+                        int best_move,
+                        int depth,
+                        int ply,
+                        int original_alpha,
+                        int beta,
+                        TranspositionTable::Entry* entry) {
+    entry->score = ToTable(best_score, ply);
+    entry->move = best_move;
+    entry->depth = std::min(depth, TranspositionTable::kMaxDepth);
+    if (best_score <= original_alpha)
+      entry->bound = TranspositionTable::kBoundUpper;
+    else if (best_score >= beta)
+      entry->bound = TranspositionTable::kBoundLower;
+    else
+      entry->bound = TranspositionTable::kBoundExact;
+  }
+};
+
+template <int WinScore, int MaxPly>
+const int SearchScores<WinScore, MaxPly>::kInfinity;
+
+// Decides when a search runs out of time.  Set up with Start() before the
+// search, after which any number of search threads may check it.
+class SearchDeadline {
+ public:
+  SearchDeadline();
+
+  // Run out |max_time| from now, or never if it's zero, or once |cancel| is
+  // set if it isn't null.
+  void Start(TimeInterval max_time, const std::atomic<bool>* cancel);
+
+  // Whether the search has to stop.  This reads the clock, so the searches
+  // only check every kTimeCheckInterval nodes.
+  bool Expired() const;
+
+ private:
+  bool has_deadline_;
+  Timestamp deadline_;
+  const std::atomic<bool>* cancel_;
+};
+
+}  // namespace Tictactoe
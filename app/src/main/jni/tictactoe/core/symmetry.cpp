@@ -0,0 +1,22 @@
+////
+// symmetry.cpp
+////
+
+#include "tictactoe/core/symmetry.h"
+
+namespace Tictactoe {
+
+constexpr TictactoeSymmetryTables TictactoeSymmetry::kTables;
+
+// Spot check the tables.
+static_assert(TictactoeSymmetry::TransformMask(0x001, 1) == 0x004,
+              "Mirroring left to right should move the top left corner");
+static_assert(TictactoeSymmetry::TransformMask(0x002, 4) == 0x008,
+              "Swapping axes should move the top side to the left side");
+static_assert(TictactoeSymmetry::Index(0x001, 0x010) == 1 + 2 * 81,
+              "Indices should match TictactoeState");
+static_assert(TransformSpace(TransformSpace(5, 3, 3, 5), 3, 3,
+                             InverseSymmetry(5)) == 5,
+              "The inverse should undo a symmetry");
+
+}  // namespace Tictactoe
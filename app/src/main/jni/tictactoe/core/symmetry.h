@@ -0,0 +1,105 @@
+////
+// symmetry.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+namespace Tictactoe {
+
+// The rotations and reflections of a board.  A symmetry is three bits: bit 0
+// mirrors left to right, then bit 1 mirrors top to bottom, then bit 2 swaps
+// rows and columns, which only keeps the shape of a square board.  Symmetry 0
+// leaves the board alone.
+const int kNumSymmetries = 8;
+
+// Return the space that |symmetry| moves |space| to on a |width| by |height|
+// board.
+constexpr int TransformSpace(int space, int width, int height, int symmetry) {
+  int x = space % width;
+  int y = space / width;
+  if (symmetry & 1)
+    x = width - 1 - x;
+  if (symmetry & 2)
+    y = height - 1 - y;
+  if (symmetry & 4)
+    return x * width + y;
+  return y * width + x;
+}
+
+// Return the symmetry that undoes |symmetry|.
+constexpr int InverseSymmetry(int symmetry) {
+  // Once the axes are swapped, a left to right mirror undoes a top to bottom
+  // one and the other way around.
+  if (!(symmetry & 4))
+    return symmetry;
+  return 4 | ((symmetry & 1) << 1) | ((symmetry & 2) >> 1);
+}
+
+struct TictactoeSymmetryTables {
+  // Every 9 bit mask under every symmetry.
+  uint16_t masks[kNumSymmetries][TictactoeState::kFullMask + 1];
+  // The base 3 digits a mask contributes to a position index, with each mark
+  // counted as 1.
+  uint16_t index_digits[TictactoeState::kFullMask + 1];
+};
+
+constexpr TictactoeSymmetryTables GenerateTictactoeSymmetryTables() {
+  TictactoeSymmetryTables tables{};
+  for (int mask = 0; mask <= TictactoeState::kFullMask; ++mask) {
+    for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+      if (!(mask & (1 << space)))
+        continue;
+      tables.index_digits[mask] += TictactoeState::PowerOf3(space);
+      for (int symmetry = 0; symmetry < kNumSymmetries; ++symmetry) {
+        tables.masks[symmetry][mask] |=
+            1 << TransformSpace(space, 3, 3, symmetry);
+      }
+    }
+  }
+  return tables;
+}
+
+// Symmetry lookups for the 3x3 board, from tables built at compile time.
+class TictactoeSymmetry {
+ public:
+  static constexpr TictactoeSymmetryTables kTables =
+      GenerateTictactoeSymmetryTables();
+
+  static constexpr int TransformSpace(int space, int symmetry) {
+    return Tictactoe::TransformSpace(space, 3, 3, symmetry);
+  }
+
+  static constexpr uint16_t TransformMask(uint16_t mask, int symmetry) {
+    return kTables.masks[symmetry][mask];
+  }
+
+  // The TictactoeState::index() of the position with these masks.
+  static constexpr int Index(uint16_t x_mask, uint16_t o_mask) {
+    return kTables.index_digits[x_mask] +
+           kPlayerO * kTables.index_digits[o_mask];
+  }
+
+  // Return the smallest index of any symmetry of the position, which is the
+  // same for every symmetric position.  Sets |symmetry| to a symmetry that
+  // turns the position into that one.
+  static constexpr int CanonicalIndex(uint16_t x_mask,
+                                      uint16_t o_mask,
+                                      int* symmetry) {
+    int best_index = Index(x_mask, o_mask);
+    *symmetry = 0;
+    for (int i = 1; i < kNumSymmetries; ++i) {
+      const int index =
+          Index(TransformMask(x_mask, i), TransformMask(o_mask, i));
+      if (index < best_index) {
+        best_index = index;
+        *symmetry = i;
+      }
+    }
+    return best_index;
+  }
+};
+
+}  // namespace Tictactoe
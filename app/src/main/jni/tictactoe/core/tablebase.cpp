@@ -0,0 +1,302 @@
+////
+// tablebase.cpp
+////
+
+#include "tictactoe/core/tablebase.h"
+
+#include "base/file/file.h"
+#include "base/file/file_manager.h"
+#include "base/logging.h"
+#include "base/util/bits.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Tictactoe {
+
+namespace {
+const uint32_t kFileMagic = 0x54424e4d;  // "MNKT"
+const uint32_t kFileVersion = 1;
+const char kTempSuffix[] = ".tmp";
+
+const int kValuesPerByte = 4;
+const int kValueBits = 2;
+const uint8_t kValueMask = 3;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t k;
+  uint32_t max_empty;
+  uint64_t num_values;
+};
+
+// Binomial coefficients, n choose k.  All of them up to 64 fit in 64 bits.
+struct Binomials {
+  Binomials();
+
+  uint64_t values[TablebaseIndex::kMaxSpaces + 1]
+                 [TablebaseIndex::kMaxSpaces + 1];
+};
+
+Binomials::Binomials() {
+  memset(values, 0, sizeof(values));
+  for (int n = 0; n <= TablebaseIndex::kMaxSpaces; ++n) {
+    values[n][0] = 1;
+    for (int k = 1; k <= n; ++k)
+      values[n][k] = values[n - 1][k - 1] + values[n - 1][k];
+  }
+}
+
+const Binomials& GetBinomials() {
+  static const Binomials binomials;
+  return binomials;
+}
+
+uint64_t Choose(int n, int k) {
+  return GetBinomials().values[n][k];
+}
+
+// Return the rank of |mask|'s set bits among all combinations of as many of
+// |universe|'s set bits, which are numbered from the lowest.  |mask| must be
+// within |universe|.
+uint64_t RankCombination(uint64_t mask, uint64_t universe) {
+  uint64_t rank = 0;
+  int count = 0;
+  while (mask) {
+    const int space = bits::FindFirstSet64(mask);
+    const uint64_t below = (uint64_t(1) << space) - 1;
+    rank += Choose(bits::CountSetBits64(universe & below), ++count);
+    mask &= mask - 1;
+  }
+  return rank;
+}
+
+// Return the |count| of |universe|'s set bits that make the combination at
+// |rank|.
+uint64_t UnrankCombination(uint64_t rank, int count, uint64_t universe) {
+  uint64_t mask = 0;
+  int position = bits::CountSetBits64(universe);
+  for (int i = count; i > 0; --i) {
+    do {
+      --position;
+    } while (Choose(position, i) > rank);
+    rank -= Choose(position, i);
+    mask |= uint64_t(1) << bits::FindNthSet64(universe, position);
+  }
+  return mask;
+}
+
+uint64_t FullMask(int num_spaces) {
+  return num_spaces == 64 ? ~uint64_t(0) : (uint64_t(1) << num_spaces) - 1;
+}
+
+Tablebase::Value Negate(Tablebase::Value value) {
+  switch (value) {
+    case Tablebase::kValueLoss:
+      return Tablebase::kValueWin;
+    case Tablebase::kValueWin:
+      return Tablebase::kValueLoss;
+    default:
+      return value;
+  }
+}
+}
+
+////
+// TablebaseIndex
+////
+TablebaseIndex::TablebaseIndex(int num_spaces, int max_empty)
+    : num_spaces_(num_spaces), max_empty_(max_empty) {
+  DCHECK_GT(num_spaces, 0);
+  DCHECK_LE(num_spaces, kMaxSpaces);
+  DCHECK_GE(max_empty, 0);
+  DCHECK_LE(max_empty, num_spaces);
+
+  group_starts_[0] = 0;
+  for (int empty = 0; empty <= max_empty_; ++empty) {
+    const uint64_t size = group_size(empty);
+    group_starts_[empty + 1] = group_starts_[empty] +
+                               (size + kValuesPerByte - 1) / kValuesPerByte *
+                                   kValuesPerByte;
+  }
+}
+
+uint64_t TablebaseIndex::group_size(int empty) const {
+  const int marks = num_spaces_ - empty;
+  return Choose(num_spaces_, empty) * Choose(marks, marks / 2);
+}
+
+bool TablebaseIndex::Covers(uint64_t x_mask, uint64_t o_mask) const {
+  const int x_count = bits::CountSetBits64(x_mask);
+  const int o_count = bits::CountSetBits64(o_mask);
+  return !(x_mask & o_mask) && !((x_mask | o_mask) & ~FullMask(num_spaces_)) &&
+         (x_count == o_count || x_count == o_count + 1) &&
+         num_spaces_ - x_count - o_count <= max_empty_;
+}
+
+uint64_t TablebaseIndex::Rank(uint64_t x_mask, uint64_t o_mask) const {
+  DCHECK(Covers(x_mask, o_mask));
+  const uint64_t filled = x_mask | o_mask;
+  const uint64_t empty = ~filled & FullMask(num_spaces_);
+  const int empty_count = bits::CountSetBits64(empty);
+  const int marks = num_spaces_ - empty_count;
+
+  const uint64_t empty_rank = RankCombination(empty, ~uint64_t(0));
+  const uint64_t o_rank = RankCombination(o_mask, filled);
+  return group_starts_[empty_count] +
+         empty_rank * Choose(marks, marks / 2) + o_rank;
+}
+
+void TablebaseIndex::Unrank(int empty,
+                            uint64_t offset,
+                            uint64_t* x_mask,
+                            uint64_t* o_mask) const {
+  DCHECK_LE(empty, max_empty_);
+  DCHECK_LT(offset, group_size(empty));
+  const int marks = num_spaces_ - empty;
+  const uint64_t o_choices = Choose(marks, marks / 2);
+
+  const uint64_t full = FullMask(num_spaces_);
+  const uint64_t filled =
+      ~UnrankCombination(offset / o_choices, empty, full) & full;
+  *o_mask = UnrankCombination(offset % o_choices, marks / 2, filled);
+  *x_mask = filled & ~*o_mask;
+}
+
+////
+// Tablebase
+////
+
+// static
+std::string Tablebase::GetFilename(int width, int height, int k) {
+  char filename[32];
+  snprintf(filename, sizeof(filename), "mnk_%d_%d_%d.tb", width, height, k);
+  return filename;
+}
+
+// static
+std::unique_ptr<Tablebase> Tablebase::Open(const std::string& filename) {
+  std::unique_ptr<File> file = FileManager::Get()->ReadFile(filename);
+  if (!file)
+    return nullptr;
+
+  // Probes jump all over the table, so it's mapped rather than read.
+  const size_t length = file->Length();
+  const uint8_t* contents = static_cast<const uint8_t*>(file->GetContents());
+  FileHeader header;
+  if (!contents || length < sizeof(header)) {
+    LOG(ERROR) << "Cannot read tablebase " << filename;
+    return nullptr;
+  }
+  memcpy(&header, contents, sizeof(header));
+  // Bound each dimension first, so their product can't wrap.
+  if (header.magic != kFileMagic || header.version != kFileVersion ||
+      !header.width || !header.height ||
+      header.width > TablebaseIndex::kMaxSpaces ||
+      header.height > TablebaseIndex::kMaxSpaces ||
+      header.width * header.height > TablebaseIndex::kMaxSpaces ||
+      header.max_empty > header.width * header.height) {
+    LOG(ERROR) << "Bad tablebase header in " << filename;
+    return nullptr;
+  }
+  const TablebaseIndex index(header.width * header.height, header.max_empty);
+  const uint64_t value_bytes =
+      (index.size() + kValuesPerByte - 1) / kValuesPerByte;
+  if (header.num_values != index.size() ||
+      length - sizeof(header) < value_bytes) {
+    LOG(ERROR) << "Tablebase " << filename << " is truncated";
+    return nullptr;
+  }
+
+  return std::unique_ptr<Tablebase>(new Tablebase(
+      std::move(file), header.width, header.height, header.k,
+      header.max_empty, contents + sizeof(header)));
+}
+
+// static
+bool Tablebase::Write(const std::string& filename,
+                      int width,
+                      int height,
+                      int k,
+                      int max_empty,
+                      const std::vector<uint8_t>& values) {
+  const TablebaseIndex index(width * height, max_empty);
+  DCHECK_EQ(values.size(), index.size() / kValuesPerByte);
+
+  const std::string temp_file = filename + kTempSuffix;
+  std::unique_ptr<File> file = FileManager::Get()->WriteFile(temp_file, false);
+  if (!file) {
+    LOG(ERROR) << "Cannot write tablebase " << temp_file;
+    return false;
+  }
+
+  FileHeader header = {};
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  header.width = width;
+  header.height = height;
+  header.k = k;
+  header.max_empty = max_empty;
+  header.num_values = index.size();
+  bool ok = file->Write(&header, sizeof(header)) == sizeof(header) &&
+            file->Write(values.data(), values.size()) == values.size();
+  file->Close();
+
+  if (!ok || !FileManager::Get()->Rename(temp_file, filename)) {
+    LOG(ERROR) << "Failed to save tablebase " << filename;
+    return false;
+  }
+  return true;
+}
+
+Tablebase::~Tablebase() {}
+
+Tablebase::Value Tablebase::Probe(uint64_t x_mask, uint64_t o_mask) const {
+  if (!index_.Covers(x_mask, o_mask))
+    return kValueUnknown;
+  const uint64_t i = index_.Rank(x_mask, o_mask);
+  return static_cast<Value>(
+      (values_[i / kValuesPerByte] >> (i % kValuesPerByte * kValueBits)) &
+      kValueMask);
+}
+
+uint64_t Tablebase::FindBestMoves(uint64_t x_mask,
+                                  uint64_t o_mask,
+                                  Value* value) const {
+  *value = Probe(x_mask, o_mask);
+  if (*value == kValueUnknown)
+    return 0;
+
+  const bool x_to_move =
+      bits::CountSetBits64(x_mask) == bits::CountSetBits64(o_mask);
+  uint64_t empty = ~(x_mask | o_mask) & FullMask(index_.num_spaces());
+  uint64_t best_moves = 0;
+  while (empty) {
+    const uint64_t move = empty & -empty;
+    empty &= empty - 1;
+    const Value child = x_to_move ? Probe(x_mask | move, o_mask)
+                                  : Probe(x_mask, o_mask | move);
+    if (Negate(child) == *value)
+      best_moves |= move;
+  }
+  return best_moves;
+}
+
+// private:
+Tablebase::Tablebase(std::unique_ptr<File> file,
+                     int width,
+                     int height,
+                     int k,
+                     int max_empty,
+                     const uint8_t* values)
+    : file_(std::move(file)),
+      width_(width),
+      height_(height),
+      k_(k),
+      index_(width * height, max_empty),
+      values_(values) {}
+
+}  // namespace Tictactoe
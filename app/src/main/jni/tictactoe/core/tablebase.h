@@ -0,0 +1,132 @@
+////
+// tablebase.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class File;
+
+namespace Tictactoe {
+
+// Numbers every position on an m,n,k board with up to |max_empty| empty
+// spaces.  Positions are grouped by their number of empty spaces, and within
+// a group ranked by which spaces are empty and then by which of the rest are
+// O's, as combinations.  Each player's marks are counted from the number
+// played, so every index is a distinct position and there are no gaps.
+// Positions are passed as a mask of spaces per player, bit |i| for space |i|.
+class TablebaseIndex {
+ public:
+  static const int kMaxSpaces = 64;
+
+  TablebaseIndex(int num_spaces, int max_empty);
+
+  int num_spaces() const { return num_spaces_; }
+  int max_empty() const { return max_empty_; }
+
+  // The number of indices, including padding that starts each group on a
+  // multiple of four so the groups can be filled in parallel a byte at a
+  // time.
+  uint64_t size() const { return group_starts_[max_empty_ + 1]; }
+
+  // The first index and number of positions with |empty| empty spaces.
+  uint64_t group_start(int empty) const { return group_starts_[empty]; }
+  uint64_t group_size(int empty) const;
+
+  // Return true if the marks could have been played in turn, X first, and
+  // there are few enough empty spaces.
+  bool Covers(uint64_t x_mask, uint64_t o_mask) const;
+
+  // Return the index of the position.  It must be covered.
+  uint64_t Rank(uint64_t x_mask, uint64_t o_mask) const;
+
+  // Set the masks to the position with |empty| empty spaces at |offset|
+  // into its group.
+  void Unrank(int empty,
+              uint64_t offset,
+              uint64_t* x_mask,
+              uint64_t* o_mask) const;
+
+ private:
+  const int num_spaces_;
+  const int max_empty_;
+  uint64_t group_starts_[kMaxSpaces + 2];
+};
+
+// A win, draw or loss for the player to move in every position an m,n,k
+// board can reach with up to some number of empty spaces, two bits each,
+// numbered by TablebaseIndex.  Tables are built offline by the tablebase
+// generator tool, and too big to build into the app, so they're read from
+// the FileManager data directory.  The file is mapped rather than read, so
+// opening one costs nothing up front and a probe only touches the page its
+// value is on.
+class Tablebase {
+ public:
+  enum Value {
+    // Not in the table, because the position has too many empty spaces or
+    // can't be reached.
+    kValueUnknown,
+    kValueLoss,
+    kValueDraw,
+    kValueWin,
+  };
+
+  // Return the name tables are saved under for the board size.
+  static std::string GetFilename(int width, int height, int k);
+
+  // Map the table in |filename|.  Returns null if there isn't one or it's
+  // corrupt.
+  static std::unique_ptr<Tablebase> Open(const std::string& filename);
+
+  // Write a table with |values| packed four to a byte in index order, the
+  // first in the low bits.  Returns false on failure.
+  static bool Write(const std::string& filename,
+                    int width,
+                    int height,
+                    int k,
+                    int max_empty,
+                    const std::vector<uint8_t>& values);
+
+  ~Tablebase();
+  DISALLOW_COPY_AND_ASSIGN(Tablebase);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int k() const { return k_; }
+  int max_empty() const { return index_.max_empty(); }
+
+  // Return the value of the position for the player to move.  Never
+  // allocates.
+  Value Probe(uint64_t x_mask, uint64_t o_mask) const;
+
+  // Return the mask of moves that get the best value for the player to
+  // move, and set |value| to it.  Returns 0 if the position isn't covered or
+  // the game is over.
+  uint64_t FindBestMoves(uint64_t x_mask, uint64_t o_mask, Value* value) const;
+
+ private:
+  Tablebase(std::unique_ptr<File> file,
+            int width,
+            int height,
+            int k,
+            int max_empty,
+            const uint8_t* values);
+
+  // Holds the mapping |values_| points into.
+  std::unique_ptr<File> file_;
+
+  const int width_;
+  const int height_;
+  const int k_;
+  const TablebaseIndex index_;
+
+  const uint8_t* const values_;
+};
+
+}  // namespace Tictactoe
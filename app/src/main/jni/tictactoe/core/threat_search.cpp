@@ -0,0 +1,253 @@
+////
+// threat_search.cpp
+////
+
+#include "tictactoe/core/threat_search.h"
+
+#include "base/logging.h"
+
+#include <limits>
+
+namespace Tictactoe {
+
+namespace {
+// How often to check the clock, in nodes.
+const int64_t kTimeCheckInterval = 1024;
+
+// Mixed into the hash when open threes are allowed, since the same position
+// can be lost with fours alone and won with threes.
+const uint64_t kThreesKey = 0x9e3779b97f4a7c15ULL;
+
+Player Opponent(Player player) {
+  return player == kPlayerX ? kPlayerO : kPlayerX;
+}
+}
+
+////
+// ThreatSearchResult
+////
+ThreatSearchResult::ThreatSearchResult()
+    : move(-1), plies(0), uses_threes(false), nodes(0) {}
+
+////
+// ThreatSearch
+////
+const int ThreatSearch::kMaxDepth;
+
+ThreatSearch::ThreatSearch(int table_bits)
+    : table_(new TranspositionTable(table_bits)),
+      cancel_(nullptr),
+      nodes_(0),
+      stopped_(false) {}
+
+ThreatSearch::~ThreatSearch() {}
+
+ThreatSearchResult ThreatSearch::Search(GomokuBoard* board,
+                                        TimeInterval max_time,
+                                        const std::atomic<bool>* cancel) {
+  const Timestamp start = Timestamp::Now();
+  deadline_ = start + max_time;
+  cancel_ = cancel;
+  nodes_ = 0;
+  stopped_ = false;
+  table_counters_ = TranspositionTable::Counters();
+  table_->NewSearch();
+
+  ThreatSearchResult result;
+  if (!board->game_over()) {
+    // Fours leave the defender one reply, so try them alone first.
+    for (int pass = 0; pass < 2 && result.move == -1 && !stopped_; ++pass) {
+      const bool threes = pass == 1;
+      for (int depth = 0; depth <= kMaxDepth; ++depth) {
+        int move = -1;
+        if (AttackerWins(board, depth, threes, &move)) {
+          result.move = move;
+          result.plies = 2 * depth + 1;
+          result.uses_threes = threes;
+          break;
+        }
+        if (stopped_)
+          break;
+      }
+    }
+  }
+
+  table_->AddCounters(table_counters_);
+  result.nodes = nodes_;
+  result.elapsed = Timestamp::Now() - start;
+  return result;
+}
+
+// private:
+bool ThreatSearch::AttackerWins(GomokuBoard* board,
+                                int depth,
+                                bool threes,
+                                int* move) {
+  nodes_++;
+  if (ShouldStop())
+    return false;
+
+  const Player attacker = board->turn();
+  const Player defender = Opponent(attacker);
+  int spaces[GomokuBoard::kNumSpaces];
+
+  // Take a win if there is one.
+  if (board->FindShapes(attacker, GomokuBoard::kShapeFive, spaces)) {
+    *move = spaces[0];
+    return true;
+  }
+  if (depth <= 0)
+    return false;
+
+  // Probe the transposition table.  A win within fewer moves is a win here,
+  // and a loss within more moves is a loss here.
+  const uint64_t hash = board->hash() ^ (threes ? kThreesKey : 0);
+  TranspositionTable::Entry entry;
+  int table_move = -1;
+  if (table_->Probe(hash, &entry, &table_counters_)) {
+    if (entry.bound == TranspositionTable::kBoundLower &&
+        entry.depth <= depth) {
+      *move = entry.move;
+      return true;
+    }
+    if (entry.bound == TranspositionTable::kBoundUpper &&
+        entry.depth >= depth) {
+      return false;
+    }
+    table_move = entry.move;
+  }
+
+  // A four by the defender has to be blocked, so the block is the only move,
+  // and only keeps the attack going if it's a threat too.  Two can't both be
+  // blocked.
+  const GomokuBoard::Shape min_shape =
+      threes ? GomokuBoard::kShapeOpenThree : GomokuBoard::kShapeFour;
+  int count = board->FindShapes(defender, GomokuBoard::kShapeFive, spaces);
+  if (count > 1)
+    return false;
+  if (count == 1) {
+    if (board->GetBestShape(attacker, spaces[0]) < min_shape)
+      return false;
+  } else {
+    count = board->FindShapes(attacker, min_shape, spaces);
+    OrderThreats(*board, table_move, count, spaces);
+  }
+
+  bool win = false;
+  for (int i = 0; i < count && !win; ++i) {
+    board->PlaceMark(spaces[i]);
+    win = DefenderLoses(board, depth - 1, threes);
+    board->RemoveLastMark();
+    if (stopped_)
+      return false;
+    if (win)
+      *move = spaces[i];
+  }
+
+  entry.score = win;
+  entry.move = win ? *move : -1;
+  entry.depth = depth;
+  entry.bound = win ? TranspositionTable::kBoundLower
+                    : TranspositionTable::kBoundUpper;
+  table_->Store(hash, entry, &table_counters_);
+  return win;
+}
+
+bool ThreatSearch::DefenderLoses(GomokuBoard* board, int depth, bool threes) {
+  nodes_++;
+  if (board->game_over())
+    return board->winner() != kPlayerNone;
+
+  const Player defender = board->turn();
+  const Player attacker = Opponent(defender);
+  int spaces[GomokuBoard::kNumSpaces];
+
+  // The defender wins first if they can.
+  if (board->FindShapes(defender, GomokuBoard::kShapeFive, spaces))
+    return false;
+
+  // A four has to be blocked, and two can't be.
+  int count = board->FindShapes(attacker, GomokuBoard::kShapeFive, spaces);
+  if (count > 1)
+    return true;
+  if (count == 0) {
+    // An open three can be answered on any space where the attacker would
+    // make a three or better, which covers every line it can still grow
+    // along, or by the defender making a four of their own.
+    // Refutations are usually the defender's fours, then the spaces the
+    // attacker needs most, so try those first.
+    DCHECK(threes);
+    int scores[GomokuBoard::kNumSpaces];
+    for (int space = 0; space < GomokuBoard::kNumSpaces; ++space) {
+      if (!board->IsEmpty(space))
+        continue;
+      const GomokuBoard::Shape attack = board->GetBestShape(attacker, space);
+      const GomokuBoard::Shape counter = board->GetBestShape(defender, space);
+      if (attack < GomokuBoard::kShapeThree &&
+          counter < GomokuBoard::kShapeFour) {
+        continue;
+      }
+      const int score =
+          counter >= GomokuBoard::kShapeFour ? GomokuBoard::kShapeFive : attack;
+
+      // Insertion sort, highest score first.
+      int i = count++;
+      for (; i > 0 && scores[i - 1] < score; --i) {
+        spaces[i] = spaces[i - 1];
+        scores[i] = scores[i - 1];
+      }
+      spaces[i] = space;
+      scores[i] = score;
+    }
+  }
+
+  for (int i = 0; i < count; ++i) {
+    board->PlaceMark(spaces[i]);
+    int move = -1;
+    const bool win = AttackerWins(board, depth, threes, &move);
+    board->RemoveLastMark();
+    if (!win)
+      return false;
+  }
+  return true;
+}
+
+void ThreatSearch::OrderThreats(const GomokuBoard& board,
+                                int first_move,
+                                int count,
+                                int* spaces) const {
+  const Player attacker = board.turn();
+  int scores[GomokuBoard::kNumSpaces];
+  for (int n = 0; n < count; ++n) {
+    const int space = spaces[n];
+    // Threats that win outright first, then fours before threes.
+    int score = std::numeric_limits<int>::max();
+    if (space != first_move) {
+      score = 2 * board.GetBestShape(attacker, space) +
+              board.IsWinningThreat(attacker, space);
+    }
+
+    // Insertion sort, highest score first.
+    int i = n;
+    for (; i > 0 && scores[i - 1] < score; --i) {
+      spaces[i] = spaces[i - 1];
+      scores[i] = scores[i - 1];
+    }
+    spaces[i] = space;
+    scores[i] = score;
+  }
+}
+
+bool ThreatSearch::ShouldStop() {
+  if (stopped_)
+    return true;
+  if (nodes_ % kTimeCheckInterval == 0) {
+    if (Timestamp::Now() >= deadline_)
+      stopped_ = true;
+    if (cancel_ && cancel_->load(std::memory_order_relaxed))
+      stopped_ = true;
+  }
+  return stopped_;
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,89 @@
+////
+// threat_search.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "tictactoe/core/gomoku_board.h"
+#include "tictactoe/core/transposition_table.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+struct ThreatSearchResult {
+  ThreatSearchResult();
+
+  // The first move of a forced win for the player to move, or -1 if none was
+  // found.
+  int move;
+  // Moves until the win, counting both players'.  Zero if there's no win.
+  int plies;
+  // True if the win needs open threes, false if it's fours alone.
+  bool uses_threes;
+  int64_t nodes;
+  TimeInterval elapsed;
+};
+
+// Looks for a forced win on a GomokuBoard by making only threats, so the
+// defender's replies are limited to the few spaces that answer them.  Every
+// attacking move makes a four, which has one reply, or in the second pass an
+// open three, whose replies are the spaces on its lines plus any four the
+// defender can make back.  Either way the tree stays narrow enough to see
+// wins far deeper than a full-width search.
+//
+// The defender's replies always include every move that could refute a
+// threat, so a win that's found is real.  Wins that need a quiet move along
+// the way aren't found.
+class ThreatSearch {
+ public:
+  // The most threats in a sequence, not counting the final five.
+  static const int kMaxDepth = 16;
+
+  // The transposition table holds 2^|table_bits| entries.
+  explicit ThreatSearch(int table_bits);
+  ~ThreatSearch();
+  DISALLOW_COPY_AND_ASSIGN(ThreatSearch);
+
+  // Search for a forced win for the player to move on |board|, for up to
+  // |max_time|, or until |cancel| is set if it isn't null.  Sequences of
+  // fours are tried before ones with threes, and shorter sequences before
+  // longer ones.  |board| is modified during the search but restored before
+  // returning.
+  ThreatSearchResult Search(GomokuBoard* board,
+                            TimeInterval max_time,
+                            const std::atomic<bool>* cancel);
+
+ private:
+  // Return true if the player to move can win making at most |depth| more
+  // threats, and set |move| to the first.  Threats are fours, and also open
+  // threes if |threes| is set.
+  bool AttackerWins(GomokuBoard* board, int depth, bool threes, int* move);
+
+  // Return true if every answer by the player to move to the threat just
+  // made loses.
+  bool DefenderLoses(GomokuBoard* board, int depth, bool threes);
+
+  // Sort the first |count| of |spaces| so the attacker's strongest threats
+  // come first, after |first_move|.
+  void OrderThreats(const GomokuBoard& board,
+                    int first_move,
+                    int count,
+                    int* spaces) const;
+
+  bool ShouldStop();
+
+  std::unique_ptr<TranspositionTable> table_;
+  TranspositionTable::Counters table_counters_;
+
+  Timestamp deadline_;
+  const std::atomic<bool>* cancel_;
+  int64_t nodes_;
+  bool stopped_;
+};
+
+}  // namespace Tictactoe
@@ -13,24 +13,25 @@ std::unique_ptr<SimpleGame> SimpleGame::Create(
 namespace Tictactoe {
 
 TictactoeGame::TictactoeGame(PlatformDelegate* platform_delegate)
-    : SimpleGame(platform_delegate) {}
+    : SimpleGame(platform_delegate), variant_(kVariantClassic) {}
 
 TictactoeGame::~TictactoeGame() {}
 
 // private:
 // SimpleGame:
 void TictactoeGame::OnCreate() {
-  SetView(std::make_unique<MainMenu>(this));
+  SetView(std::make_unique<MainMenu>(this, variant_));
 }
 
 // GameBoard::Listener:
 void TictactoeGame::OnCloseBoard() {
-  SetView(std::make_unique<MainMenu>(this));
+  SetView(std::make_unique<MainMenu>(this, variant_));
 }
 
 // MainMenu::Listener:
-void TictactoeGame::OnStartGame(Difficulty difficulty) {
-  SetView(std::make_unique<GameBoard>(this, difficulty));
+void TictactoeGame::OnStartGame(Variant variant, Difficulty difficulty) {
+  variant_ = variant;
+  SetView(std::make_unique<GameBoard>(this, variant, difficulty));
 }
 
 }  // namespace Tictactoe
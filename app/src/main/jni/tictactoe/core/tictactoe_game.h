@@ -27,7 +27,10 @@ class TictactoeGame : public SimpleGame,
   void OnCloseBoard() override;
 
   // MainMenu::Listener:
-  void OnStartGame(Difficulty difficulty) override;
+  void OnStartGame(Variant variant, Difficulty difficulty) override;
+
+  // The rules of the last game, which the menu keeps selected.
+  Variant variant_;
 };
 
 }  // namespace Tictactoe
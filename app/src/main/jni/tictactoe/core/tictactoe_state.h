@@ -0,0 +1,15 @@
+////
+// tictactoe_state.h
+////
+
+#pragma once
+
+#include "tictactoe/core/game_rules.h"
+#include "tictactoe/core/game_state.h"
+
+namespace Tictactoe {
+
+// A classic 3x3 tic tac toe position.
+typedef GameState<ClassicRules> TictactoeState;
+
+}  // namespace Tictactoe
@@ -0,0 +1,219 @@
+////
+// transposition_table.cpp
+////
+
+#include "tictactoe/core/transposition_table.h"
+
+#include "base/logging.h"
+
+#include <limits>
+#include <new>
+
+namespace Tictactoe {
+
+const int TranspositionTable::kBucketSize;
+const int TranspositionTable::kMaxDepth;
+
+namespace {
+const size_t kCacheLineSize = 64;
+
+// Layout of an entry's data word.
+const int kMoveShift = 32;
+const int kDepthShift = 44;
+const int kBoundShift = 54;
+const int kAgeShift = 56;
+const uint64_t kMoveMask = 0xfff;
+const uint64_t kDepthMask = 0x3ff;
+const uint64_t kBoundMask = 0x3;
+
+// When picking an entry to replace, each search of age counts for this many
+// plies of depth.
+const int kAgeWeight = 8;
+
+uint8_t GetAge(uint64_t data) {
+  return data >> kAgeShift;
+}
+
+int GetDepth(uint64_t data) {
+  return (data >> kDepthShift) & kDepthMask;
+}
+
+bool IsEmpty(uint64_t data) {
+  return ((data >> kBoundShift) & kBoundMask) ==
+         TranspositionTable::kBoundNone;
+}
+}
+
+////
+// TranspositionTable::Entry
+////
+TranspositionTable::Entry::Entry()
+    : score(0), move(-1), depth(0), bound(kBoundNone) {}
+
+////
+// TranspositionTable::Counters
+////
+TranspositionTable::Counters::Counters() : probes(0), hits(0), collisions(0) {}
+
+void TranspositionTable::Counters::Add(const Counters& other) {
+  probes += other.probes;
+  hits += other.hits;
+  collisions += other.collisions;
+}
+
+double TranspositionTable::Counters::HitRate() const {
+  return probes ? static_cast<double>(hits) / probes : 0;
+}
+
+////
+// TranspositionTable
+////
+TranspositionTable::TranspositionTable(int table_bits)
+    : buckets_(nullptr),
+      num_buckets_((static_cast<size_t>(1) << table_bits) / kBucketSize),
+      age_(0),
+      probes_(0),
+      hits_(0),
+      collisions_(0) {
+  DCHECK_GT(num_buckets_, 0u);
+  DCHECK_EQ(sizeof(Bucket), kCacheLineSize);
+
+  // Line the buckets up with cache lines, so a probe touches only one.
+  storage_.reset(
+      new uint8_t[num_buckets_ * sizeof(Bucket) + kCacheLineSize - 1]);
+  const uintptr_t address = reinterpret_cast<uintptr_t>(storage_.get());
+  buckets_ = reinterpret_cast<Bucket*>((address + kCacheLineSize - 1) &
+                                       ~(kCacheLineSize - 1));
+  for (size_t i = 0; i < num_buckets_; ++i)
+    new (&buckets_[i]) Bucket;
+  Clear();
+}
+
+TranspositionTable::~TranspositionTable() {
+  for (size_t i = 0; i < num_buckets_; ++i)
+    buckets_[i].~Bucket();
+}
+
+void TranspositionTable::NewSearch() {
+  age_++;
+}
+
+void TranspositionTable::Clear() {
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    for (Slot& slot : buckets_[i].slots) {
+      slot.check.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  }
+  age_ = 0;
+  probes_ = 0;
+  hits_ = 0;
+  collisions_ = 0;
+}
+
+bool TranspositionTable::Probe(uint64_t key,
+                               Entry* entry,
+                               Counters* counters) const {
+  counters->probes++;
+  const Bucket& bucket = buckets_[key & (num_buckets_ - 1)];
+  for (const Slot& slot : bucket.slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) == key && !IsEmpty(data)) {
+      Unpack(data, entry);
+      counters->hits++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TranspositionTable::Store(uint64_t key,
+                               const Entry& entry,
+                               Counters* counters) {
+  DCHECK_NE(entry.bound, kBoundNone);
+  Bucket* bucket = &buckets_[key & (num_buckets_ - 1)];
+
+  // Reuse the position's own entry if it has one.  Otherwise replace the
+  // entry with the least value, where older searches and shallower depths
+  // are worth less.
+  Slot* victim = nullptr;
+  uint64_t victim_data = 0;
+  int victim_value = std::numeric_limits<int>::max();
+  bool same_position = false;
+  for (Slot& slot : bucket->slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if (IsEmpty(data) || (check ^ data) == key) {
+      victim = &slot;
+      victim_data = data;
+      same_position = !IsEmpty(data);
+      break;
+    }
+
+    const uint8_t age = age_ - GetAge(data);
+    const int value = GetDepth(data) - kAgeWeight * age;
+    if (value < victim_value) {
+      victim = &slot;
+      victim_data = data;
+      victim_value = value;
+    }
+  }
+
+  Entry stored = entry;
+  if (same_position) {
+    // Keep a deeper result from this search, unless the new one is exact.
+    if (GetAge(victim_data) == age_ && entry.bound != kBoundExact &&
+        entry.depth < GetDepth(victim_data)) {
+      return;
+    }
+  } else if (!IsEmpty(victim_data) && GetAge(victim_data) == age_) {
+    counters->collisions++;
+  }
+
+  if (stored.move < 0 && same_position) {
+    // Keep the old best move rather than losing it.
+    Entry old_entry;
+    Unpack(victim_data, &old_entry);
+    stored.move = old_entry.move;
+  }
+
+  const uint64_t data = Pack(stored, age_);
+  victim->check.store(key ^ data, std::memory_order_relaxed);
+  victim->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::AddCounters(const Counters& counters) {
+  probes_.fetch_add(counters.probes, std::memory_order_relaxed);
+  hits_.fetch_add(counters.hits, std::memory_order_relaxed);
+  collisions_.fetch_add(counters.collisions, std::memory_order_relaxed);
+}
+
+TranspositionTable::Counters TranspositionTable::counters() const {
+  Counters counters;
+  counters.probes = probes_.load(std::memory_order_relaxed);
+  counters.hits = hits_.load(std::memory_order_relaxed);
+  counters.collisions = collisions_.load(std::memory_order_relaxed);
+  return counters;
+}
+
+// private:
+// static
+uint64_t TranspositionTable::Pack(const Entry& entry, uint8_t age) {
+  DCHECK_LE(entry.depth, kMaxDepth);
+  return static_cast<uint32_t>(entry.score) |
+         (static_cast<uint64_t>(entry.move + 1) & kMoveMask) << kMoveShift |
+         (static_cast<uint64_t>(entry.depth) & kDepthMask) << kDepthShift |
+         (static_cast<uint64_t>(entry.bound) & kBoundMask) << kBoundShift |
+         static_cast<uint64_t>(age) << kAgeShift;
+}
+
+// static
+void TranspositionTable::Unpack(uint64_t data, Entry* entry) {
+  entry->score = static_cast<int32_t>(static_cast<uint32_t>(data));
+  entry->move = static_cast<int>((data >> kMoveShift) & kMoveMask) - 1;
+  entry->depth = GetDepth(data);
+  entry->bound = static_cast<Bound>((data >> kBoundShift) & kBoundMask);
+}
+
+}  // namespace Tictactoe
@@ -0,0 +1,108 @@
+////
+// transposition_table.h
+////
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+// A fixed size table of search results keyed by Zobrist hash, which any
+// number of search threads may probe and store to at once without locks.
+//
+// Entries are grouped into buckets of four that fill one cache line.  Each
+// entry is two words: the packed result, and the key XORed with the result.
+// A probe only trusts an entry when the two words XOR back to its key, so a
+// store torn by another thread reads as a miss rather than a wrong result.
+class TranspositionTable {
+ public:
+  enum Bound : uint8_t {
+    kBoundNone,
+    kBoundExact,
+    kBoundLower,
+    kBoundUpper,
+  };
+
+  struct Entry {
+    Entry();
+
+    int32_t score;
+    // -1 for no move.
+    int16_t move;
+    int16_t depth;
+    Bound bound;
+  };
+
+  // Usage counts.  Each search thread keeps its own and adds them to the
+  // table's with AddCounters(), so the threads don't fight over them.
+  struct Counters {
+    Counters();
+
+    void Add(const Counters& other);
+
+    // The fraction of probes that found their position.
+    double HitRate() const;
+
+    int64_t probes;
+    int64_t hits;
+    // Stores that replaced a different position from the current search.
+    int64_t collisions;
+  };
+
+  static const int kBucketSize = 4;
+  static const int kMaxDepth = (1 << 10) - 1;
+
+  // The table holds 2^|table_bits| entries.
+  explicit TranspositionTable(int table_bits);
+  ~TranspositionTable();
+  DISALLOW_COPY_AND_ASSIGN(TranspositionTable);
+
+  // Start a new search.  Entries from earlier searches are replaced first.
+  // Must not be called while other threads use the table.
+  void NewSearch();
+
+  // Empty the table and reset the counters.  Must not be called while other
+  // threads use the table.
+  void Clear();
+
+  // Find the entry for |key|.  Returns false if there isn't one.
+  bool Probe(uint64_t key, Entry* entry, Counters* counters) const;
+
+  // Store |entry| for |key|, replacing an older or shallower entry in its
+  // bucket.
+  void Store(uint64_t key, const Entry& entry, Counters* counters);
+
+  void AddCounters(const Counters& counters);
+  Counters counters() const;
+
+  size_t size() const { return num_buckets_ * kBucketSize; }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+  };
+
+  struct alignas(64) Bucket {
+    Slot slots[kBucketSize];
+  };
+
+  static uint64_t Pack(const Entry& entry, uint8_t age);
+  static void Unpack(uint64_t data, Entry* entry);
+
+  std::unique_ptr<uint8_t[]> storage_;
+  Bucket* buckets_;
+  const size_t num_buckets_;
+  uint8_t age_;
+
+  std::atomic<int64_t> probes_;
+  std::atomic<int64_t> hits_;
+  std::atomic<int64_t> collisions_;
+};
+
+}  // namespace Tictactoe
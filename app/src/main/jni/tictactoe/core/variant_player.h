@@ -0,0 +1,171 @@
+////
+// variant_player.h
+////
+
+#pragma once
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/game_search.h"
+#include "tictactoe/core/game_state.h"
+#include "tictactoe/core/move_analysis.h"
+#include "tictactoe/core/tablebase.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Tictactoe {
+
+// Picks the computer's moves for one difficulty under any ruleset.  The
+// classic game has its own ComputerPlayer with a solved table and the MnkBoard
+// engines; the other rulesets share GameSearch for the stronger difficulties.
+// Rulesets with plain lines also play perfectly from a tablebase when one
+// for their board is in the data directory.  ChooseMove() may run on any one
+// thread at a time, and so may AnalyzeMoves(), but not both at once.
+template <typename Rules>
+class VariantPlayer : public base::RefCountedThreadSafe<VariantPlayer<Rules>> {
+ public:
+  typedef GameState<Rules> State;
+
+  VariantPlayer(Difficulty difficulty, uint32_t seed)
+      : difficulty_(difficulty), search_(kSearchTableBits), random_(seed) {
+    if (!Rules::kMisere && !Rules::kWrap &&
+        (difficulty_ == kDifficultyImpossible ||
+         difficulty_ == kDifficultyThreatSpace)) {
+      OpenTablebase();
+    }
+  }
+  ~VariantPlayer() {}
+  DISALLOW_COPY_AND_ASSIGN(VariantPlayer);
+
+  // Choose a move for the player to move in |state|.  The search stops early
+  // once |cancel| is set, in which case the move may be weaker.
+  int ChooseMove(const State& state, const std::atomic<bool>* cancel) {
+    DCHECK(!state.game_over());
+
+    switch (difficulty_) {
+      // Three in a row is too short for threat search to find anything the
+      // full search doesn't.
+      case kDifficultyThreatSpace:
+      case kDifficultyImpossible: {
+        const int space = FindTablebaseMove(state);
+        if (space != -1)
+          return space;
+        return FindSearchMove(state, kImpossibleSearchSeconds, cancel);
+      }
+
+      // There's no Monte Carlo engine for these rules, so it searches too.
+      case kDifficultyExpert:
+      case kDifficultyMonteCarlo:
+        return FindSearchMove(state, kExpertSearchSeconds, cancel);
+
+      case kDifficultyHard:
+        return FindHardMove(state);
+
+      case kDifficultyEasy:
+        break;
+    }
+    return FindRandomMove(state.empty_mask());
+  }
+
+  // Solve every empty space of |state| with the search, whatever the
+  // difficulty.  Returns true if every space was solved before the time ran
+  // out or |cancel| was set.
+  bool AnalyzeMoves(const State& state,
+                    const std::atomic<bool>* cancel,
+                    MoveAnalysis* analysis) {
+    search_.Analyze(state, TimeInterval::FromSeconds(kAnalysisSeconds), cancel,
+                    analysis);
+    DLOG(INFO) << "Analysis " << analysis->nodes << " nodes";
+    return analysis->complete;
+  }
+
+ private:
+  static const int kSearchTableBits = 16;
+  static constexpr double kExpertSearchSeconds = 0.25;
+  static constexpr double kImpossibleSearchSeconds = 1;
+  static constexpr double kAnalysisSeconds = 2;
+
+  void OpenTablebase() {
+    tablebase_ = Tablebase::Open(
+        Tablebase::GetFilename(Rules::kWidth, Rules::kHeight, Rules::kK));
+    if (tablebase_ && (tablebase_->width() != Rules::kWidth ||
+                       tablebase_->height() != Rules::kHeight ||
+                       tablebase_->k() != Rules::kK)) {
+      LOG(ERROR) << "Tablebase is for the wrong board";
+      tablebase_.reset();
+    }
+  }
+
+  // Choose a random move that keeps the best result, or return -1 if the
+  // position has too many empty spaces for the tablebase.
+  int FindTablebaseMove(const State& state) {
+    if (!tablebase_ || State::kNumSpaces - state.num_moves() >
+                           tablebase_->max_empty()) {
+      return -1;
+    }
+
+    // Any winning move keeps the win, but finish the game when possible.
+    const int space = state.FindWinningMove(state.turn());
+    if (space != -1)
+      return space;
+
+    Tablebase::Value value;
+    const uint64_t moves = tablebase_->FindBestMoves(
+        state.mask(kPlayerX), state.mask(kPlayerO), &value);
+    if (!moves)
+      return -1;
+    return FindRandomMove(static_cast<uint16_t>(moves));
+  }
+
+  int FindSearchMove(const State& state,
+                     double seconds,
+                     const std::atomic<bool>* cancel) {
+    GameSearchResult result =
+        search_.Search(state, TimeInterval::FromSeconds(seconds), cancel);
+    DLOG(INFO) << "Search depth " << result.depth << ", " << result.nodes
+               << " nodes";
+    return result.move;
+  }
+
+  // Win if possible, otherwise block.  In misère games completing a line
+  // loses, so avoid that instead.
+  int FindHardMove(const State& state) {
+    const Player player = state.turn();
+    const Player opponent = player == kPlayerX ? kPlayerO : kPlayerX;
+    const uint16_t empty = state.empty_mask();
+
+    if (State::kMisere) {
+      const uint16_t safe = empty & ~state.WinningMoves(player);
+      return FindRandomMove(safe ? safe : empty);
+    }
+
+    int space = state.FindWinningMove(player);
+    if (space != -1)
+      return space;
+    space = state.FindWinningMove(opponent);
+    if (space != -1)
+      return space;
+    return FindRandomMove(empty);
+  }
+
+  // Choose a random space from |spaces|.
+  int FindRandomMove(uint16_t spaces) {
+    DCHECK(spaces);
+    const int offset = random_.NextDouble() * bits::CountSetBits(spaces);
+    return bits::FindNthSet(spaces, offset);
+  }
+
+  const Difficulty difficulty_;
+  GameSearch<Rules> search_;
+  // Only for the strongest difficulties.  May be null.
+  std::unique_ptr<Tablebase> tablebase_;
+  Random random_;
+};
+
+}  // namespace Tictactoe
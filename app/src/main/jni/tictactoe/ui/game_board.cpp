@@ -6,14 +6,29 @@
 
 #include "base/logging.h"
 #include "base/thread/task.h"
-#include "base/util/random.h"
 #include "game/input/key_event.h"
 #include "game/input/keycodes.h"
 #include "game/ui/grid.h"
 #include "game/ui/label.h"
 #include "game/ui/root_view.h"
+#include "tictactoe/core/move_analysis.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
 
 namespace {
+// The computer's move shows up no sooner than this after the player's.
+const double kComputerTurnMinSeconds = 0.5;
+
+// The width and height of the board, which the spaces share.
+const int kBoardSize = 900;
+
+// Stacked boards are shown side by side, this many to a row, with a gap
+// between them.
+const int kLayerColumns = 2;
+const int kLayerGap = 40;
+
 const char kGameBoardImage[] = "assets/ui/game_board.pcx";
 const char kXImage[] = "assets/ui/x_image.pcx";
 const char kOImage[] = "assets/ui/o_image.pcx";
@@ -27,37 +42,188 @@ const char kOWinsLabel[] = "O wins!";
 const char kDrawLabel[] = "Draw";
 const char kXLabel[] = "X";
 const char kOLabel[] = "O";
+const char kUndoLabel[] = "Undo";
+const char kRedoLabel[] = "Redo";
+const char kHintLabel[] = "Hint";
+const char kBestSpaceText[] = "*";
+const char kBestSpaceLabel[] = "Best move";
+
+// Indexed by MoveGrade.
+const char kGradeLabel[][16] = {
+    "", "Best move", "Good move", "Mistake", "Blunder",
+};
 
 const char kPlacedAnnouncement[] = " placed in ";
+const char kRemovedAnnouncement[] = " removed from ";
 const char kPlayerName[][16] = {"None", "X", "O"};
+// Names for the spaces of a 3x3 board.  Other boards number their rows and
+// columns.
 const char kBoardSpaceName[][16] = {
     "top left",     "top center",  "top right",     "center left",  "center",
     "center right", "bottom left", "bottom center", "bottom right",
 };
+const char kSpaceNameFormat[] = "row %d column %d";
+const char kLayerSpaceNameFormat[] = "layer %d row %d column %d";
+const char kLayerNameFormat[] = "Layer %d";
 }
 
 namespace Tictactoe {
 
-class GameBoard::DelayedTurn : public Task {
+// A computer move in progress.  The move is chosen on the background thread,
+// then handed back to the board on the UI thread.  The board cancels the turn
+// if it goes away first.
+class GameBoard::ComputerTurn
+    : public base::RefCountedThreadSafe<ComputerTurn> {
+ public:
+  ComputerTurn(GameBoard* board, ui::RootView* root_view)
+      : board_(board),
+        root_view_(root_view),
+        game_(board->game_->Clone()),
+        start_(Timestamp::Now()),
+        cancelled_(false),
+        move_(-1) {}
+  DISALLOW_COPY_AND_ASSIGN(ComputerTurn);
+
+  // Called on the UI thread.
+  void Cancel() { cancelled_ = true; }
+
+  // Called on the background thread.
+  void Compute() {
+    if (cancelled_)
+      return;
+    move_ = game_->ChooseComputerMove(&cancelled_);
+
+    const TimeInterval elapsed = Timestamp::Now() - start_;
+    const TimeInterval delay = TimeInterval::FromSeconds(
+        std::max(0.0, kComputerTurnMinSeconds - elapsed.Seconds()));
+    root_view_->PostUiTaskDelayed(std::make_unique<FinishTask>(this), delay);
+  }
+
+  // Called on the UI thread.
+  void Finish() {
+    if (cancelled_)
+      return;
+    board_->OnComputerMove(move_);
+  }
+
+  class ComputeTask : public Task {
+   public:
+    ComputeTask(ComputerTurn* turn) : turn_(turn) {}
+    ~ComputeTask() override {}
+    DISALLOW_COPY_AND_ASSIGN(ComputeTask);
+
+    // Task:
+    void Execute() override { turn_->Compute(); }
+
+   private:
+    scoped_refptr<ComputerTurn> turn_;
+  };
+
+  class FinishTask : public Task {
+   public:
+    FinishTask(ComputerTurn* turn) : turn_(turn) {}
+    ~FinishTask() override {}
+    DISALLOW_COPY_AND_ASSIGN(FinishTask);
+
+    // Task:
+    void Execute() override { turn_->Finish(); }
+
+   private:
+    scoped_refptr<ComputerTurn> turn_;
+  };
+
+ private:
+  // Only read on the UI thread, and only while not cancelled.
+  GameBoard* board_;
+  ui::RootView* root_view_;
+
+  // A copy of the game, so the board can carry on if the turn is cancelled.
+  const std::unique_ptr<Game> game_;
+  const Timestamp start_;
+  std::atomic<bool> cancelled_;
+  int move_;
+};
+
+// An analysis of the player's moves in progress, run on the background thread
+// like a computer turn and cancelled the same way.
+class GameBoard::MoveAnalyzer
+    : public base::RefCountedThreadSafe<MoveAnalyzer> {
  public:
-  DelayedTurn(GameBoard* parent) : parent_(parent) {}
-  DISALLOW_COPY_AND_ASSIGN(DelayedTurn);
+  MoveAnalyzer(GameBoard* board, ui::RootView* root_view)
+      : board_(board),
+        root_view_(root_view),
+        game_(board->game_->Clone()),
+        analysis_(std::make_unique<MoveAnalysis>()),
+        cancelled_(false),
+        complete_(false) {}
+  DISALLOW_COPY_AND_ASSIGN(MoveAnalyzer);
+
+  // Called on the UI thread.
+  void Cancel() { cancelled_ = true; }
+
+  // Called on the background thread.
+  void Compute() {
+    if (cancelled_)
+      return;
+    complete_ = game_->AnalyzeMoves(&cancelled_, analysis_.get());
+    root_view_->PostUiTask(std::make_unique<FinishTask>(this));
+  }
 
-  void Cancel() { parent_ = nullptr; }
-  void Execute() override {
-    if (parent_)
-      parent_->TakeComputerTurn();
+  // Called on the UI thread.
+  void Finish() {
+    if (cancelled_)
+      return;
+    // Only a complete analysis can say which move is best.
+    board_->OnAnalysisDone(complete_ ? std::move(analysis_) : nullptr);
   }
 
+  class ComputeTask : public Task {
+   public:
+    ComputeTask(MoveAnalyzer* analyzer) : analyzer_(analyzer) {}
+    ~ComputeTask() override {}
+    DISALLOW_COPY_AND_ASSIGN(ComputeTask);
+
+    // Task:
+    void Execute() override { analyzer_->Compute(); }
+
+   private:
+    scoped_refptr<MoveAnalyzer> analyzer_;
+  };
+
+  class FinishTask : public Task {
+   public:
+    FinishTask(MoveAnalyzer* analyzer) : analyzer_(analyzer) {}
+    ~FinishTask() override {}
+    DISALLOW_COPY_AND_ASSIGN(FinishTask);
+
+    // Task:
+    void Execute() override { analyzer_->Finish(); }
+
+   private:
+    scoped_refptr<MoveAnalyzer> analyzer_;
+  };
+
  private:
-  GameBoard* parent_;
+  // Only read on the UI thread, and only while not cancelled.
+  GameBoard* board_;
+  ui::RootView* root_view_;
+
+  const std::unique_ptr<Game> game_;
+  std::unique_ptr<MoveAnalysis> analysis_;
+  std::atomic<bool> cancelled_;
+  bool complete_;
 };
 
-GameBoard::GameBoard(Listener* listener, Difficulty difficulty)
+GameBoard::GameBoard(Listener* listener,
+                     Variant variant,
+                     Difficulty difficulty)
     : listener_(listener),
       difficulty_(difficulty),
-      turn_(kPlayerX),
-      pending_turn_(nullptr) {
+      game_(Game::Create(variant, difficulty)),
+      hints_requested_(false),
+      board_buttons_(game_->num_spaces()),
+      board_x_labels_(game_->num_spaces()),
+      board_o_labels_(game_->num_spaces()) {
   // Set the title.
   SetTitle(kGameBoardTitle);
 
@@ -72,32 +238,72 @@ GameBoard::GameBoard(Listener* listener, Difficulty difficulty)
   status_label_ = status_label.get();
   AddView(std::move(status_label));
 
-  // Add the image of the game board.
-  auto board_image = std::make_unique<ui::Image>();
-  board_image->SetImage(kGameBoardImage);
-
-  auto grid = std::make_unique<ui::Grid>();
-  grid->SetColumns(3);
-  grid->SetCellWidth(300);
-  grid->SetCellHeight(300);
-
-  for (int i = 0; i < 9; ++i) {
-    AddBoardSpace(grid.get(), i);
-    board_[i] = kPlayerNone;
+  // Add the grade of the player's last move under it.
+  auto grade_label = std::make_unique<ui::Label>();
+  grade_label->SetLayoutY(100);
+  grade_label->SetLayoutHeight(60);
+  grade_label->SetLayoutHAlign(ui::View::kHAlignCenter);
+  grade_label->SetLayoutVAlign(ui::View::kVAlignTop);
+  grade_label->SetTextHAlign(ui::View::kHAlignCenter);
+  grade_label->SetFontSize(48);
+  grade_label->SetAccessibilityLive(ui::kAccessibilityLivePolite);
+  grade_label_ = grade_label.get();
+  AddView(std::move(grade_label));
+
+  // Add the spaces in a grid.
+  if (HasBoardImage()) {
+    // Draw the spaces over the image of the game board.
+    auto board_image = std::make_unique<ui::Image>();
+    board_image->SetImage(kGameBoardImage);
+    board_image->AddView(CreateLayer(0, kBoardSize));
+    AddView(std::move(board_image));
+  } else if (game_->layers() == 1) {
+    AddView(CreateLayer(0, kBoardSize));
+  } else {
+    auto layers = std::make_unique<ui::Grid>();
+    layers->SetColumns(kLayerColumns);
+    layers->SetCellWidth(kBoardSize / kLayerColumns);
+    layers->SetCellHeight(kBoardSize / kLayerColumns);
+    for (int layer = 0; layer < game_->layers(); ++layer) {
+      auto grid = CreateLayer(layer, kBoardSize / kLayerColumns - kLayerGap);
+      char name[32];
+      snprintf(name, sizeof(name), kLayerNameFormat, layer + 1);
+      grid->SetAccessibilityLabel(name);
+      layers->AddView(std::move(grid));
+    }
+    AddView(std::move(layers));
   }
 
-  board_image->AddView(std::move(grid));
-  AddView(std::move(board_image));
+  // Add the undo, redo and hint buttons below the board.
+  auto history_grid = std::make_unique<ui::Grid>();
+  history_grid->SetLayoutVAlign(ui::View::kVAlignBottom);
+  undo_button_ = AddHistoryButton(history_grid.get(), kUndoLabel);
+  redo_button_ = AddHistoryButton(history_grid.get(), kRedoLabel);
+  hint_button_ = AddHistoryButton(history_grid.get(), kHintLabel);
+  AddView(std::move(history_grid));
 
   UpdateTurnLabel();
+  UpdateHistoryButtons();
 }
 
 GameBoard::~GameBoard() {
-  if (pending_turn_)
-    pending_turn_->Cancel();
+  CancelComputerTurn();
+  CancelAnalysis();
 }
 
 // private:
+std::unique_ptr<ui::Grid> GameBoard::CreateLayer(int layer, int size) {
+  auto grid = std::make_unique<ui::Grid>();
+  grid->SetColumns(game_->width());
+  grid->SetCellWidth(size / game_->width());
+  grid->SetCellHeight(size / game_->height());
+
+  const int layer_spaces = game_->width() * game_->height();
+  for (int i = 0; i < layer_spaces; ++i)
+    AddBoardSpace(grid.get(), layer * layer_spaces + i);
+  return grid;
+}
+
 void GameBoard::AddBoardSpace(ui::View* board, int index) {
   auto view = std::make_unique<ui::View>();
 
@@ -107,6 +313,8 @@ void GameBoard::AddBoardSpace(ui::View* board, int index) {
   button->SetAccessibilityLabel(kBoardSpaceLabel);
   button->SetButtonListener(this);
   button->SetLayoutFill(true);
+  if (!HasBoardImage())
+    button->SetImage(kButtonImage);
   view->AddView(std::move(button));
 
   auto x_label = std::make_unique<ui::Image>();
@@ -126,139 +334,210 @@ void GameBoard::AddBoardSpace(ui::View* board, int index) {
   board->AddView(std::move(view));
 }
 
+bool GameBoard::HasBoardImage() const {
+  return game_->width() == 3 && game_->height() == 3;
+}
+
+std::string GameBoard::GetSpaceName(int space) const {
+  if (HasBoardImage())
+    return kBoardSpaceName[space];
+
+  const int layer_spaces = game_->width() * game_->height();
+  const int layer = space / layer_spaces;
+  const int row = space % layer_spaces / game_->width();
+  const int column = space % game_->width();
+  char name[32];
+  if (game_->layers() == 1) {
+    snprintf(name, sizeof(name), kSpaceNameFormat, row + 1, column + 1);
+  } else {
+    snprintf(name, sizeof(name), kLayerSpaceNameFormat, layer + 1, row + 1,
+             column + 1);
+  }
+  return name;
+}
+
+ui::Button* GameBoard::AddHistoryButton(ui::View* parent, const char* label) {
+  auto button = std::make_unique<ui::Button>();
+  ui::Button* button_ptr = button.get();
+  button->SetImage(kButtonImage);
+  button->SetText(label);
+  button->SetButtonListener(this);
+  parent->AddView(std::move(button));
+
+  return button_ptr;
+}
+
 void GameBoard::PlaceMark(int space) {
-  DCHECK_NE(turn_, kPlayerNone);
-  DCHECK_LT(space, 9);
-  DCHECK_EQ(board_[space], kPlayerNone);
+  const Player player = game_->turn();
+  DCHECK_NE(player, kPlayerNone);
+  DCHECK_LT(space, game_->num_spaces());
+  DCHECK(game_->IsEmpty(space));
 
   // Update the board.
-  board_[space] = turn_;
+  game_->PlaceMark(space);
 
   // Send accessibility announcement for the placed item.
-  std::string text = kPlayerName[turn_];
+  std::string text = kPlayerName[player];
   text += kPlacedAnnouncement;
-  text += kBoardSpaceName[space];
+  text += GetSpaceName(space);
   root_view()->AccessibilityAnnounce(text);
 
   // Update the UI.
   board_buttons_[space]->SetVisible(false);
-  if (turn_ == kPlayerX) {
+  if (player == kPlayerX) {
     board_x_labels_[space]->SetVisible(true);
   } else {
     board_o_labels_[space]->SetVisible(true);
   }
 
-  if (!CheckForWinner()) {
-    turn_ = turn_ == kPlayerX ? kPlayerO : kPlayerX;
+  if (game_->game_over()) {
+    SetWinner(game_->winner());
+  } else {
     UpdateTurnLabel();
   }
+  UpdateHistoryButtons();
 }
 
-void GameBoard::TakeComputerTurn() {
-  DCHECK_EQ(turn_, kPlayerO);
-  pending_turn_ = nullptr;
+void GameBoard::ClearSpace(int space) {
+  const Player player = game_->turn();
+  DCHECK_NE(player, kPlayerNone);
+  DCHECK(game_->IsEmpty(space));
 
-  if (difficulty_ != kDifficultyEasy) {
-    // Check if there is a winning move.
-    int space = FindWinningMove(kPlayerO);
-    if (space != -1) {
-      PlaceMark(space);
-      return;
-    }
+  std::string text = kPlayerName[player];
+  text += kRemovedAnnouncement;
+  text += GetSpaceName(space);
+  root_view()->AccessibilityAnnounce(text);
 
-    // Block any winning move.
-    space = FindWinningMove(kPlayerX);
-    if (space != -1) {
-      PlaceMark(space);
-      return;
-    }
-  }
+  // The space's views are only hidden while it's taken, so showing the
+  // button again restores it.
+  board_buttons_[space]->SetVisible(true);
+  board_x_labels_[space]->SetVisible(false);
+  board_o_labels_[space]->SetVisible(false);
+}
 
-  // On impossible, find the best remaining move.
-  if (difficulty_ == kDifficultyImpossible) {
-    int space = FindBestMove(kPlayerO);
-    if (space != -1) {
-      PlaceMark(space);
-      return;
-    }
-  }
+void GameBoard::StartComputerTurn() {
+  DCHECK_EQ(game_->turn(), kPlayerO);
+  DCHECK(!pending_turn_);
 
-  // Place in a random space.
-  // Count the empty spaces.
-  int empty_count = 0;
-  for (int i = 0; i < 9; ++i) {
-    if (board_[i] == kPlayerNone)
-      empty_count++;
-  }
-  // Chose a random space from the ones available.
-  int space_offset = Random::get()->NextDouble() * empty_count;
-  DCHECK_LT(space_offset, 9);
-
-  // Find the empty space and place the mark.
-  for (int i = 0; i < 9; ++i) {
-    if (board_[i] == kPlayerNone) {
-      if (space_offset) {
-        space_offset--;
-      } else {
-        PlaceMark(i);
-        return;
-      }
-    }
-  }
+  pending_turn_ = new ComputerTurn(this, root_view());
+  root_view()->PostBackgroundTask(
+      std::make_unique<ComputerTurn::ComputeTask>(pending_turn_.get()));
 }
 
-bool GameBoard::CheckForWinner() {
-  DCHECK_NE(turn_, kPlayerNone);
-  // Check rows and columns.
-  for (int i = 0; i < 3; ++i) {
-    // Check column.
-    if (board_[i] != kPlayerNone) {
-      if (board_[i + 3] == board_[i] && board_[i + 6] == board_[i]) {
-        SetWinner(board_[i]);
-        return true;
-      }
-    }
+void GameBoard::CancelComputerTurn() {
+  if (!pending_turn_)
+    return;
+  pending_turn_->Cancel();
+  pending_turn_.reset();
+}
 
-    // Check row.
-    if (board_[3 * i] != kPlayerNone) {
-      if (board_[3 * i + 1] == board_[3 * i] &&
-          board_[3 * i + 2] == board_[3 * i]) {
-        SetWinner(board_[3 * i]);
-        return true;
-      }
-    }
-  }
+void GameBoard::OnComputerMove(int space) {
+  DCHECK_EQ(game_->turn(), kPlayerO);
+  pending_turn_.reset();
+  PlaceMark(space);
+  StartAnalysis();
+}
 
-  // Diagonals
-  if (board_[4] != kPlayerNone) {
-    // Top left to bottom right.
-    if (board_[0] == board_[4] && board_[8] == board_[4]) {
-      SetWinner(board_[4]);
-      return true;
-    }
+void GameBoard::StartAnalysis() {
+  CancelAnalysis();
+  if (game_->turn() != kPlayerX)
+    return;
 
-    // Top right to bottom left.
-    if (board_[2] == board_[4] && board_[6] == board_[4]) {
-      SetWinner(board_[4]);
-      return true;
-    }
+  pending_analysis_ = new MoveAnalyzer(this, root_view());
+  root_view()->PostBackgroundTask(
+      std::make_unique<MoveAnalyzer::ComputeTask>(pending_analysis_.get()));
+}
+
+void GameBoard::CancelAnalysis() {
+  ClearHints();
+  analysis_.reset();
+  if (!pending_analysis_)
+    return;
+  pending_analysis_->Cancel();
+  pending_analysis_.reset();
+}
+
+void GameBoard::OnAnalysisDone(std::unique_ptr<MoveAnalysis> analysis) {
+  DCHECK_EQ(game_->turn(), kPlayerX);
+  pending_analysis_.reset();
+  analysis_ = std::move(analysis);
+  if (hints_requested_)
+    ShowHints();
+}
+
+void GameBoard::ShowHints() {
+  hints_requested_ = true;
+  if (!analysis_)
+    return;
+
+  for (int space = 0; space < game_->num_spaces(); ++space) {
+    if (!analysis_->IsBest(space))
+      continue;
+    board_buttons_[space]->SetText(kBestSpaceText);
+    board_buttons_[space]->SetAccessibilityLabel(kBestSpaceLabel);
   }
+}
 
-  // Check for available spaces.
-  for (int i = 0; i < 9; ++i) {
-    if (board_[i] == kPlayerNone)
-      return false;
+void GameBoard::ClearHints() {
+  if (!hints_requested_)
+    return;
+  hints_requested_ = false;
+  for (ui::Button* button : board_buttons_) {
+    button->SetText("");
+    button->SetAccessibilityLabel(kBoardSpaceLabel);
   }
+}
 
-  // No spaces remain, it's a draw.
-  SetWinner(kPlayerNone);
-  return true;
+void GameBoard::SetGrade(MoveGrade grade) {
+  grade_label_->SetText(kGradeLabel[grade]);
 }
 
-void GameBoard::SetWinner(Player player) {
-  DCHECK_NE(turn_, kPlayerNone);
+void GameBoard::Undo() {
+  if (!game_->num_moves())
+    return;
 
-  turn_ = kPlayerNone;
+  // The computer's move is no longer wanted if it's still thinking.
+  CancelComputerTurn();
+  CancelAnalysis();
+  do {
+    const int space = game_->RemoveLastMark();
+    redo_moves_.push_back(space);
+    ClearSpace(space);
+  } while (game_->turn() != kPlayerX && game_->num_moves());
+
+  SetGrade(kMoveGradeUnknown);
+  UpdateTurnLabel();
+  UpdateHistoryButtons();
+  StartAnalysis();
+}
+
+void GameBoard::Redo() {
+  if (redo_moves_.empty() || game_->turn() != kPlayerX)
+    return;
+
+  CancelAnalysis();
+  do {
+    const int space = redo_moves_.back();
+    redo_moves_.pop_back();
+    PlaceMark(space);
+  } while (!redo_moves_.empty() && game_->turn() == kPlayerO);
+
+  SetGrade(kMoveGradeUnknown);
+  // The computer moves as usual if its move wasn't recorded.
+  if (game_->turn() == kPlayerO)
+    StartComputerTurn();
+  else
+    StartAnalysis();
+}
+
+void GameBoard::UpdateHistoryButtons() {
+  undo_button_->SetEnabled(game_->num_moves() > 0);
+  redo_button_->SetEnabled(!redo_moves_.empty() && game_->turn() == kPlayerX);
+  hint_button_->SetEnabled(game_->turn() == kPlayerX);
+}
+
+void GameBoard::SetWinner(Player player) {
+  DCHECK(game_->game_over());
 
   switch (player) {
     case kPlayerNone:
@@ -274,160 +553,15 @@ void GameBoard::SetWinner(Player player) {
 }
 
 void GameBoard::UpdateTurnLabel() {
-  DCHECK_NE(turn_, kPlayerNone);
+  DCHECK_NE(game_->turn(), kPlayerNone);
 
-  if (turn_ == kPlayerX) {
+  if (game_->turn() == kPlayerX) {
     status_label_->SetText(kXTurnLabel);
   } else {
     status_label_->SetText(kOTurnLabel);
   }
 }
 
-int GameBoard::FindWinningMove(Player player) {
-  // Top left space
-  if (board_[0] == kPlayerNone) {
-    if ((board_[1] == player && board_[2] == player) ||  // Row
-        (board_[3] == player && board_[6] == player) ||  // Column
-        (board_[4] == player && board_[8] == player)) {  // Diagonal
-      return 0;
-    }
-  }
-
-  // Top middle space
-  if (board_[1] == kPlayerNone) {
-    if ((board_[0] == player && board_[2] == player) ||  // Row
-        (board_[4] == player && board_[7] == player)) {  // Column
-      return 1;
-    }
-  }
-
-  // Top right space
-  if (board_[2] == kPlayerNone) {
-    if ((board_[0] == player && board_[1] == player) ||  // Row
-        (board_[5] == player && board_[8] == player) ||  // Column
-        (board_[6] == player && board_[4] == player)) {  // Diagonal
-      return 2;
-    }
-  }
-
-  // Center left space
-  if (board_[3] == kPlayerNone) {
-    if ((board_[4] == player && board_[5] == player) ||  // Row
-        (board_[0] == player && board_[6] == player)) {  // Column
-      return 3;
-    }
-  }
-
-  // Center space
-  if (board_[4] == kPlayerNone) {
-    if ((board_[3] == player && board_[5] == player) ||  // Row
-        (board_[1] == player && board_[7] == player) ||  // Column
-        (board_[0] == player && board_[8] == player) ||  // Diagonal
-        (board_[2] == player && board_[6] == player)) {  // Diagonal
-      return 4;
-    }
-  }
-
-  // Center right space
-  if (board_[5] == kPlayerNone) {
-    if ((board_[3] == player && board_[4] == player) ||  // Row
-        (board_[2] == player && board_[8] == player)) {  // Column
-      return 5;
-    }
-  }
-
-  // Bottom left space
-  if (board_[6] == kPlayerNone) {
-    if ((board_[7] == player && board_[8] == player) ||  // Row
-        (board_[0] == player && board_[3] == player) ||  // Column
-        (board_[4] == player && board_[2] == player)) {  // Diagonal
-      return 6;
-    }
-  }
-
-  // Bottom middle space
-  if (board_[7] == kPlayerNone) {
-    if ((board_[6] == player && board_[8] == player) ||  // Row
-        (board_[1] == player && board_[4] == player)) {  // Column
-      return 7;
-    }
-  }
-
-  // Bottom right space
-  if (board_[8] == kPlayerNone) {
-    if ((board_[6] == player && board_[7] == player) ||  // Row
-        (board_[2] == player && board_[5] == player) ||  // Column
-        (board_[0] == player && board_[4] == player)) {  // Diagonal
-      return 8;
-    }
-  }
-
-  // No winning move.
-  return -1;
-}
-
-int GameBoard::FindBestMove(Player player) {
-  DCHECK_NE(player, kPlayerNone);
-  const Player opponent = (player == kPlayerX) ? kPlayerO : kPlayerX;
-
-  // Try the center.
-  if (board_[4] == kPlayerNone) {
-    return 4;
-  }
-
-  // If the opponent has two opposite corners and no side, grab a side.
-  if ((board_[0] == opponent && board_[2] == kPlayerNone &&
-       board_[6] == kPlayerNone && board_[8] == opponent) ||
-      (board_[0] == kPlayerNone && board_[2] == opponent &&
-       board_[6] == opponent && board_[8] == kPlayerNone)) {
-    if (board_[1] == kPlayerNone && board_[3] == kPlayerNone &&
-        board_[5] == kPlayerNone && board_[7] == kPlayerNone) {
-      return 1;
-    }
-  }
-
-  // Grab a corner.
-  if (board_[0] != player && board_[2] != player && board_[6] != player &&
-      board_[8] != player) {
-    if (board_[0] == kPlayerNone && board_[8] == kPlayerNone)
-      return 0;
-    if (board_[2] == kPlayerNone && board_[6] == kPlayerNone)
-      return 2;
-  }
-
-  // If we have a corner, grab the matching side.
-  // Top left corner.
-  if (board_[0] == player) {
-    // Try the middle right.
-    if (board_[1] == kPlayerNone && board_[2] == kPlayerNone &&
-        board_[5] == kPlayerNone) {
-      return 5;
-    }
-    // Try the middle bottom.
-    if (board_[3] == kPlayerNone && board_[6] == kPlayerNone &&
-        board_[7] == kPlayerNone) {
-      return 7;
-    }
-  }
-
-  // Top right corner.
-  if (board_[2] == player) {
-    // Try the middle left.
-    if (board_[0] == kPlayerNone && board_[1] == kPlayerNone &&
-        board_[3] == kPlayerNone) {
-      return 3;
-    }
-    // Try the middle bottom.
-    if (board_[5] == kPlayerNone && board_[8] == kPlayerNone &&
-        board_[7] == kPlayerNone) {
-      return 7;
-    }
-  }
-
-  // Nothing to be done.
-  return -1;
-}
-
 // InputListener:
 bool GameBoard::OnKeyEvent(const KeyEvent& event) {
   if (event.key_code() == VKEY_BACK) {
@@ -441,15 +575,38 @@ bool GameBoard::OnKeyEvent(const KeyEvent& event) {
 
 // ui::Button::Listener:
 void GameBoard::OnClick(ui::Button* button) {
-  if (turn_ != kPlayerX || board_[button->tag()] != kPlayerNone)
+  if (button == undo_button_) {
+    Undo();
     return;
+  }
+  if (button == redo_button_) {
+    Redo();
+    return;
+  }
+  if (button == hint_button_) {
+    // The first position isn't analyzed until asked for.
+    if (!analysis_ && !pending_analysis_)
+      StartAnalysis();
+    ShowHints();
+    return;
+  }
 
-  PlaceMark(button->tag());
+  if (game_->turn() != kPlayerX || !game_->IsEmpty(button->tag()))
+    return;
 
-  if (turn_ == kPlayerO) {
-    root_view()->PostUiTaskDelayed(std::make_unique<DelayedTurn>(this),
-                                   TimeInterval::FromSeconds(0.5));
-  }
+  // Grade the move against the analysis of the position it was made in.
+  const int space = button->tag();
+  const MoveGrade grade =
+      analysis_ ? analysis_->Grade(space) : kMoveGradeUnknown;
+  CancelAnalysis();
+  SetGrade(grade);
+
+  // A new move replaces the moves that were taken back.
+  redo_moves_.clear();
+  PlaceMark(space);
+
+  if (game_->turn() == kPlayerO)
+    StartComputerTurn();
 }
 
 }  // namespace Tictactoe
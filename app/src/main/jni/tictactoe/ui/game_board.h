@@ -5,11 +5,19 @@
 #pragma once
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "game/ui/button.h"
 #include "game/ui/view.h"
 #include "tictactoe/constants.h"
+#include "tictactoe/core/game.h"
+#include "tictactoe/core/move_analysis.h"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace ui {
+class Grid;
 class Label;
 }
 
@@ -23,22 +31,46 @@ class GameBoard : public ui::View, public ui::Button::Listener {
     virtual void OnCloseBoard() = 0;
   };
 
-  GameBoard(Listener* listener, Difficulty difficulty);
+  GameBoard(Listener* listener, Variant variant, Difficulty difficulty);
   ~GameBoard() override;
   DISALLOW_COPY_AND_ASSIGN(GameBoard);
 
  private:
-  class DelayedTurn;
-  friend class DelayedTurn;
+  class ComputerTurn;
+  friend class ComputerTurn;
+  class MoveAnalyzer;
+  friend class MoveAnalyzer;
 
+  // Return a grid of the spaces in |layer|, |size| wide and high.
+  std::unique_ptr<ui::Grid> CreateLayer(int layer, int size);
   void AddBoardSpace(ui::View* board, int index);
+  // Only the 3x3 board has an image, which the spaces are drawn over.
+  bool HasBoardImage() const;
+  std::string GetSpaceName(int space) const;
+  ui::Button* AddHistoryButton(ui::View* parent, const char* label);
   void PlaceMark(int space);
-  void TakeComputerTurn();
-  bool CheckForWinner();
+  void ClearSpace(int space);
+  void StartComputerTurn();
+  void CancelComputerTurn();
+  void OnComputerMove(int space);
+
+  // Solve the player's moves on the background thread, for the hints and to
+  // grade the move the player makes.
+  void StartAnalysis();
+  void CancelAnalysis();
+  void OnAnalysisDone(std::unique_ptr<MoveAnalysis> analysis);
+  // Mark the best spaces, once the analysis has finished.
+  void ShowHints();
+  void ClearHints();
+  void SetGrade(MoveGrade grade);
+
+  // Take back moves until it's the player's turn again.
+  void Undo();
+  // Replay the moves taken back by Undo(), up to the player's next turn.
+  void Redo();
+  void UpdateHistoryButtons();
   void SetWinner(Player player);
   void UpdateTurnLabel();
-  int FindWinningMove(Player player);
-  int FindBestMove(Player player);
 
   // InputListener:
   bool OnKeyEvent(const KeyEvent& event) override;
@@ -49,15 +81,27 @@ class GameBoard : public ui::View, public ui::Button::Listener {
   Listener* listener_;
   Difficulty difficulty_;
 
-  Player turn_;
-  Player board_[9];
+  std::unique_ptr<Game> game_;
+
+  scoped_refptr<ComputerTurn> pending_turn_;
+
+  scoped_refptr<MoveAnalyzer> pending_analysis_;
+  // The finished analysis of the position, or null.
+  std::unique_ptr<MoveAnalysis> analysis_;
+  // Show the hints as soon as the analysis finishes.
+  bool hints_requested_;
 
-  DelayedTurn* pending_turn_;
+  // Moves taken back by Undo(), most recent last.  Cleared by a new move.
+  std::vector<int> redo_moves_;
 
   ui::Label* status_label_;
-  ui::View* board_buttons_[9];
-  ui::View* board_x_labels_[9];
-  ui::View* board_o_labels_[9];
+  ui::Label* grade_label_;
+  ui::Button* undo_button_;
+  ui::Button* redo_button_;
+  ui::Button* hint_button_;
+  std::vector<ui::Button*> board_buttons_;
+  std::vector<ui::View*> board_x_labels_;
+  std::vector<ui::View*> board_o_labels_;
 };
 
 }  // namespace Tictactoe
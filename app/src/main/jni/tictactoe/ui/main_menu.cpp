@@ -12,12 +12,20 @@ const char kTicTacToeLabel[] = "Tic Tac Toe";
 const char kNewGameLabel[] = "New Game";
 const char kEasyLabel[] = "Easy";
 const char kHardLabel[] = "Hard";
+const char kExpertLabel[] = "Expert";
+const char kMonteCarloLabel[] = "Monte Carlo";
 const char kImpossibleLabel[] = "Impossible";
+const char kThreatSpaceLabel[] = "Threat Space";
+const char kVariantLabel[][32] = {
+    "Rules: Classic",  "Rules: Misere", "Rules: 4x4",   "Rules: 4x4 Wrap",
+    "Rules: 5x5",      "Rules: Qubic",  "Rules: Gomoku",
+};
 }
 
 namespace Tictactoe {
 
-MainMenu::MainMenu(Listener* listener) : listener_(listener) {
+MainMenu::MainMenu(Listener* listener, Variant variant)
+    : listener_(listener), variant_(variant) {
   // Set the title.
   SetTitle(kMainMenuTitle);
 
@@ -35,9 +43,13 @@ MainMenu::MainMenu(Listener* listener) : listener_(listener) {
   auto grid = std::make_unique<ui::Grid>();
   grid->SetAccessibilityLabel(kNewGameLabel);
   grid->SetColumns(1);
-  easy_button_ = AddDifficultyButton(grid.get(), kEasyLabel);
-  hard_button_ = AddDifficultyButton(grid.get(), kHardLabel);
-  impossible_button_ = AddDifficultyButton(grid.get(), kImpossibleLabel);
+  variant_button_ = AddMenuButton(grid.get(), kVariantLabel[variant_]);
+  easy_button_ = AddMenuButton(grid.get(), kEasyLabel);
+  hard_button_ = AddMenuButton(grid.get(), kHardLabel);
+  expert_button_ = AddMenuButton(grid.get(), kExpertLabel);
+  monte_carlo_button_ = AddMenuButton(grid.get(), kMonteCarloLabel);
+  impossible_button_ = AddMenuButton(grid.get(), kImpossibleLabel);
+  threat_space_button_ = AddMenuButton(grid.get(), kThreatSpaceLabel);
 
   // Add the grid to this view.
   AddView(std::move(grid));
@@ -46,7 +58,7 @@ MainMenu::MainMenu(Listener* listener) : listener_(listener) {
 MainMenu::~MainMenu() {}
 
 // private:
-ui::Button* MainMenu::AddDifficultyButton(ui::View* parent, const char* label) {
+ui::Button* MainMenu::AddMenuButton(ui::View* parent, const char* label) {
   auto button = std::make_unique<ui::Button>();
   ui::Button* button_ptr = button.get();
   button->SetImage(kButtonImage);
@@ -57,14 +69,28 @@ ui::Button* MainMenu::AddDifficultyButton(ui::View* parent, const char* label) {
   return button_ptr;
 }
 
+void MainMenu::UpdateVariantButton() {
+  variant_button_->SetText(kVariantLabel[variant_]);
+}
+
 // ui::Button::Listener:
 void MainMenu::OnClick(ui::Button* button) {
-  if (button == easy_button_) {
-    listener_->OnStartGame(kDifficultyEasy);
+  if (button == variant_button_) {
+    // Cycle through the rules.
+    variant_ = static_cast<Variant>((variant_ + 1) % kNumVariants);
+    UpdateVariantButton();
+  } else if (button == easy_button_) {
+    listener_->OnStartGame(variant_, kDifficultyEasy);
   } else if (button == hard_button_) {
-    listener_->OnStartGame(kDifficultyHard);
+    listener_->OnStartGame(variant_, kDifficultyHard);
+  } else if (button == expert_button_) {
+    listener_->OnStartGame(variant_, kDifficultyExpert);
+  } else if (button == monte_carlo_button_) {
+    listener_->OnStartGame(variant_, kDifficultyMonteCarlo);
   } else if (button == impossible_button_) {
-    listener_->OnStartGame(kDifficultyImpossible);
+    listener_->OnStartGame(variant_, kDifficultyImpossible);
+  } else if (button == threat_space_button_) {
+    listener_->OnStartGame(variant_, kDifficultyThreatSpace);
   }
 }
 
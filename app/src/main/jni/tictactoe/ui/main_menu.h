@@ -16,24 +16,31 @@ class MainMenu : public ui::View, public ui::Button::Listener {
   class Listener {
    public:
     virtual ~Listener() {}
-    virtual void OnStartGame(Difficulty difficulty) = 0;
+    virtual void OnStartGame(Variant variant, Difficulty difficulty) = 0;
   };
 
-  MainMenu(Listener* listener);
+  // The menu starts with |variant| selected.
+  MainMenu(Listener* listener, Variant variant);
   ~MainMenu() override;
   DISALLOW_COPY_AND_ASSIGN(MainMenu);
 
  private:
-  ui::Button* AddDifficultyButton(ui::View* parent, const char* label);
+  ui::Button* AddMenuButton(ui::View* parent, const char* label);
+  void UpdateVariantButton();
 
   // ui::Button::Listener:
   void OnClick(ui::Button* button) override;
 
   Listener* listener_;
+  Variant variant_;
 
+  ui::Button* variant_button_;
   ui::Button* easy_button_;
   ui::Button* hard_button_;
+  ui::Button* expert_button_;
+  ui::Button* monte_carlo_button_;
   ui::Button* impossible_button_;
+  ui::Button* threat_space_button_;
 };
 
 }  // namespace Tictactoe
@@ -0,0 +1,248 @@
+////
+// ai_service_benchmark.cpp
+////
+
+// Sizes the AiService worker pool.  Runs many sessions at once, each playing
+// random X moves and asking the service for O's, with 1, 2, 4 and 8 workers,
+// and reports throughput and the percentiles of the time from each request
+// to its answer.
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread/condition_variable.h"
+#include "base/thread/mutex.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/ai_service.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+struct Strategy {
+  const char* name;
+  Difficulty difficulty;
+};
+
+const Strategy kStrategies[] = {
+    {"easy", kDifficultyEasy},
+    {"hard", kDifficultyHard},
+    {"expert", kDifficultyExpert},
+    {"montecarlo", kDifficultyMonteCarlo},
+    {"impossible", kDifficultyImpossible},
+};
+
+const int kDefaultSessions = 256;
+const int kDefaultRequests = 200;
+const int kDefaultMaxWorkers = 8;
+
+const char kUsage[] =
+    "Usage: ai_service_benchmark [options]\n"
+    "\n"
+    "Options:\n"
+    "  --sessions=N     Games played at once (default 256)\n"
+    "  --requests=N     Moves each session asks for (default 200)\n"
+    "  --strategy=S     Computer player: easy, hard, expert, montecarlo or\n"
+    "                   impossible (default expert)\n"
+    "  --max-workers=N  Double the workers from 1 up to N (default 8)\n"
+    "  --seed=N         Seed for the X moves (default 0)\n";
+
+struct Options {
+  Options()
+      : sessions(kDefaultSessions),
+        requests(kDefaultRequests),
+        difficulty(kDifficultyExpert),
+        max_workers(kDefaultMaxWorkers),
+        seed(0) {}
+
+  int sessions;
+  int requests;
+  Difficulty difficulty;
+  int max_workers;
+  uint32_t seed;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  std::string strategy_name;
+  tools::OptionParser parser;
+  parser.Add("sessions", &options->sessions);
+  parser.Add("requests", &options->requests);
+  parser.Add("strategy", &strategy_name);
+  parser.Add("max-workers", &options->max_workers);
+  parser.Add("seed", &options->seed);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (!strategy_name.empty()) {
+    const Strategy* strategy = nullptr;
+    for (const Strategy& candidate : kStrategies) {
+      if (strategy_name == candidate.name)
+        strategy = &candidate;
+    }
+    if (!strategy) {
+      fprintf(stderr, "Unknown strategy: %s\n", strategy_name.c_str());
+      return false;
+    }
+    options->difficulty = strategy->difficulty;
+  }
+
+  if (options->sessions <= 0 || options->requests <= 0 ||
+      options->max_workers <= 0) {
+    return false;
+  }
+  options->max_workers = tools::ClampWorkers(options->max_workers);
+  return true;
+}
+
+// Counts down the sessions still playing, so the main thread can wait for
+// them.
+class Finish {
+ public:
+  explicit Finish(int count) : wake_(&lock_), count_(count) {}
+  DISALLOW_COPY_AND_ASSIGN(Finish);
+
+  void Done() {
+    AutoLock lock(&lock_);
+    if (!--count_)
+      wake_.Signal();
+  }
+
+  void Wait() {
+    AutoLock lock(&lock_);
+    while (count_)
+      wake_.Wait();
+  }
+
+ private:
+  Mutex lock_;
+  ConditionVariable wake_;
+  int count_;
+};
+
+// One game after another against the service, with one request in flight.
+// Only touched by one thread at a time: the main thread to start it, then
+// whichever worker answers its request.
+class Session : public AiService::Listener {
+ public:
+  Session(AiService* service,
+          const Options& options,
+          Finish* finish,
+          uint32_t seed)
+      : service_(service),
+        options_(options),
+        finish_(finish),
+        random_(seed),
+        remaining_(options.requests) {
+    latencies_.reserve(options.requests);
+  }
+  ~Session() override {}
+  DISALLOW_COPY_AND_ASSIGN(Session);
+
+  const std::vector<double>& latencies() const { return latencies_; }
+
+  void Start() { PlayAndRequest(); }
+
+  // AiService::Listener:
+  void OnMoveChosen(int tag, int move) override {
+    latencies_.push_back((Timestamp::Now() - request_time_).Seconds());
+    if (move != -1)
+      state_.PlaceMark(move);
+    if (!--remaining_) {
+      finish_->Done();
+      return;
+    }
+    PlayAndRequest();
+  }
+
+ private:
+  // Play a random X move, starting a new game whenever one ends, and ask for
+  // O's reply.
+  void PlayAndRequest() {
+    do {
+      if (state_.game_over())
+        state_ = TictactoeState();
+      const int offset = random_.NextDouble() * state_.EmptyCount();
+      state_.PlaceMark(bits::FindNthSet(state_.empty_mask(), offset));
+    } while (state_.game_over());
+
+    request_time_ = Timestamp::Now();
+    service_->RequestMove(state_, options_.difficulty, this, 0);
+  }
+
+  AiService* service_;
+  const Options& options_;
+  Finish* finish_;
+  Random random_;
+  TictactoeState state_;
+  int remaining_;
+  Timestamp request_time_;
+  // Seconds from each request to its answer.
+  std::vector<double> latencies_;
+};
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+  const size_t index = fraction * (sorted.size() - 1);
+  return sorted[index];
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  printf("%d sessions, %d requests each, %d cores\n", options.sessions,
+         options.requests, thread::GetProcessorCount());
+  printf("%7s %12s %9s %9s %9s %9s %7s %7s\n", "workers", "requests/sec",
+         "p50 ms", "p90 ms", "p99 ms", "max ms", "batch", "cached");
+
+  for (int workers = 1; workers <= options.max_workers; workers *= 2) {
+    AiService service(workers, options.seed);
+    service.Start();
+
+    Finish finish(options.sessions);
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (int i = 0; i < options.sessions; ++i) {
+      sessions.push_back(std::make_unique<Session>(&service, options, &finish,
+                                                   options.seed + i));
+    }
+    const Timestamp start = Timestamp::Now();
+    for (auto& session : sessions)
+      session->Start();
+    finish.Wait();
+    const double seconds = (Timestamp::Now() - start).Seconds();
+    service.Stop();
+
+    std::vector<double> latencies;
+    for (const auto& session : sessions) {
+      latencies.insert(latencies.end(), session->latencies().begin(),
+                       session->latencies().end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const AiService::Counters counters = service.counters();
+    printf("%7d %12.0f %9.3f %9.3f %9.3f %9.3f %7.1f %6.1f%%\n", workers,
+           counters.requests / seconds, Percentile(latencies, 0.5) * 1000,
+           Percentile(latencies, 0.9) * 1000,
+           Percentile(latencies, 0.99) * 1000, latencies.back() * 1000,
+           static_cast<double>(counters.requests) / counters.batches,
+           100.0 * counters.cache_hits / counters.requests);
+  }
+  return 0;
+}
@@ -0,0 +1,278 @@
+////
+// book_build.cpp
+////
+
+// Builds the gomoku opening book from self play.  Each game plays the first
+// few moves, some by the chosen computer player and the rest at random next
+// to the marks already played, so the book covers the positions a person is
+// likely to reach rather than one line.  Every computer move is counted
+// against its position, up to symmetry, and the counts become the moves'
+// weights in the book.
+
+#include "base/file/file_manager_posix.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/gomoku_board.h"
+#include "tictactoe/core/gomoku_player.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/opening_book.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+struct Strategy {
+  const char* name;
+  Difficulty difficulty;
+};
+
+const Strategy kStrategies[] = {
+    {"expert", kDifficultyExpert},
+    {"montecarlo", kDifficultyMonteCarlo},
+    {"impossible", kDifficultyImpossible},
+    {"threatspace", kDifficultyThreatSpace},
+};
+
+const int kDefaultGames = 200;
+const int kDefaultPlies = 6;
+const double kDefaultMoveSeconds = 1;
+const double kDefaultExplore = 0.5;
+
+// Random moves stay next to the marks already played.
+const int kRandomMoveDistance = 1;
+
+const char kUsage[] =
+    "Usage: book_build [options]\n"
+    "\n"
+    "Options:\n"
+    "  --games=N      Number of games to play (default 200)\n"
+    "  --plies=N      Moves into each game to cover (default 6)\n"
+    "  --seconds=S    Search time per computer move (default 1)\n"
+    "  --explore=P    Chance of a random move instead of the computer's\n"
+    "                 (default 0.5)\n"
+    "  --strategy=S   Computer player: expert, montecarlo, impossible or\n"
+    "                 threatspace (default threatspace)\n"
+    "  --threads=N    Number of games to play at once (default: all cores)\n"
+    "  --seed=N       Seed for the random moves (default 0)\n"
+    "  --output=F     File to write (default: mnk_15_15_5.book)\n";
+
+struct Options {
+  Options()
+      : games(kDefaultGames),
+        plies(kDefaultPlies),
+        move_seconds(kDefaultMoveSeconds),
+        explore(kDefaultExplore),
+        difficulty(kDifficultyThreatSpace),
+        threads(thread::GetProcessorCount()),
+        seed(0) {}
+
+  int games;
+  int plies;
+  double move_seconds;
+  double explore;
+  Difficulty difficulty;
+  int threads;
+  uint32_t seed;
+  std::string output;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  std::string strategy_name;
+  tools::OptionParser parser;
+  parser.Add("games", &options->games);
+  parser.Add("plies", &options->plies);
+  parser.Add("seconds", &options->move_seconds);
+  parser.Add("explore", &options->explore);
+  parser.Add("strategy", &strategy_name);
+  parser.Add("threads", &options->threads);
+  parser.Add("seed", &options->seed);
+  parser.Add("output", &options->output);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (!strategy_name.empty()) {
+    const Strategy* strategy = nullptr;
+    for (const Strategy& candidate : kStrategies) {
+      if (strategy_name == candidate.name)
+        strategy = &candidate;
+    }
+    if (!strategy) {
+      fprintf(stderr, "Unknown strategy: %s\n", strategy_name.c_str());
+      return false;
+    }
+    options->difficulty = strategy->difficulty;
+  }
+
+  if (options->games <= 0 || options->plies <= 0 ||
+      options->plies > GomokuBoard::kNumSpaces || options->move_seconds <= 0 ||
+      options->explore < 0 || options->explore > 1 || options->threads <= 0) {
+    return false;
+  }
+
+  if (options->output.empty()) {
+    // The asset name without its directory.
+    const std::string asset = OpeningBook::GetAssetName(
+        GomokuBoard::kWidth, GomokuBoard::kHeight, GomokuBoard::kK);
+    options->output = asset.substr(asset.rfind('/') + 1);
+  }
+  options->threads = tools::ClampWorkers(options->threads);
+  return true;
+}
+
+// How often the computer chose each move, keyed by canonical hash and move.
+typedef std::map<std::pair<uint64_t, int>, int> MoveCounts;
+
+class BookBuilder {
+ public:
+  explicit BookBuilder(const Options& options)
+      : options_(options), next_game_(0) {}
+  ~BookBuilder() {}
+  DISALLOW_COPY_AND_ASSIGN(BookBuilder);
+
+  // Play every game and return the counts from all of them.
+  MoveCounts Run();
+
+  // Play games until there are none left, counting into |counts|.
+  void RunWorker(int worker, MoveCounts* counts);
+
+ private:
+  // Choose a random space next to a mark, or the center of an empty board.
+  static int FindRandomMove(const GomokuBoard& board, Random* random);
+
+  const Options& options_;
+  std::atomic<int> next_game_;
+};
+
+class WorkerTask : public Task {
+ public:
+  WorkerTask(BookBuilder* builder, int worker, MoveCounts* counts)
+      : builder_(builder), worker_(worker), counts_(counts) {}
+  ~WorkerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerTask);
+
+  // Task:
+  void Execute() override { builder_->RunWorker(worker_, counts_); }
+
+ private:
+  BookBuilder* builder_;
+  int worker_;
+  MoveCounts* counts_;
+};
+
+MoveCounts BookBuilder::Run() {
+  std::unique_ptr<MoveCounts[]> counts(new MoveCounts[options_.threads]);
+  std::unique_ptr<Thread[]> threads(new Thread[options_.threads]);
+  for (int i = 1; i < options_.threads; ++i)
+    threads[i].Start(std::make_unique<WorkerTask>(this, i, &counts[i]));
+  RunWorker(0, &counts[0]);
+  for (int i = 1; i < options_.threads; ++i)
+    threads[i].Join();
+
+  for (int i = 1; i < options_.threads; ++i) {
+    for (const auto& count : counts[i])
+      counts[0][count.first] += count.second;
+  }
+  return std::move(counts[0]);
+}
+
+void BookBuilder::RunWorker(int worker, MoveCounts* counts) {
+  // The player's search keeps nothing between moves that depends on the
+  // side it plays, so one player makes the moves for both.
+  scoped_refptr<GomokuPlayer> player(
+      new GomokuPlayer(options_.difficulty, options_.seed + worker));
+  player->set_use_opening_book(false);
+  player->set_max_search_time(TimeInterval::FromSeconds(options_.move_seconds));
+  Random random(options_.seed + tools::kMaxWorkers + worker);
+
+  while (next_game_++ < options_.games) {
+    GomokuBoard board;
+    MnkBoard search_board(GomokuBoard::kWidth, GomokuBoard::kHeight,
+                          GomokuBoard::kK);
+    for (int ply = 0; ply < options_.plies && !board.game_over(); ++ply) {
+      int space;
+      if (random.NextDouble() < options_.explore) {
+        space = FindRandomMove(board, &random);
+      } else {
+        space = player->ChooseMove(board, nullptr);
+        int symmetry = 0;
+        const uint64_t hash = search_board.CanonicalHash(&symmetry);
+        (*counts)[std::make_pair(
+            hash, search_board.TransformSpace(space, symmetry))]++;
+      }
+      board.PlaceMark(space);
+      search_board.PlaceMark(space);
+    }
+  }
+}
+
+// private:
+// static
+int BookBuilder::FindRandomMove(const GomokuBoard& board, Random* random) {
+  if (!board.num_moves())
+    return GomokuBoard::kNumSpaces / 2;
+
+  int spaces[GomokuBoard::kNumSpaces];
+  int count = 0;
+  for (int space = 0; space < GomokuBoard::kNumSpaces; ++space) {
+    if (board.IsEmpty(space) && board.HasNeighbor(space, kRandomMoveDistance))
+      spaces[count++] = space;
+  }
+  return spaces[static_cast<int>(random->NextDouble() * count)];
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  // The book is written to the working directory.
+  FileManagerPosix file_manager("", "");
+
+  const Timestamp start = Timestamp::Now();
+  BookBuilder builder(options);
+  const MoveCounts counts = builder.Run();
+
+  std::vector<OpeningBook::Entry> entries;
+  int64_t moves = 0;
+  for (const auto& count : counts) {
+    OpeningBook::Entry entry = {};
+    entry.hash = count.first.first;
+    entry.move = count.first.second;
+    entry.weight = std::min(count.second, 0xffff);
+    entries.push_back(entry);
+    moves += count.second;
+  }
+  printf("%d games, %lld computer moves, %zu book entries in %.1fs\n",
+         options.games, static_cast<long long>(moves), entries.size(),
+         (Timestamp::Now() - start).Seconds());
+
+  if (!OpeningBook::Write(options.output, GomokuBoard::kWidth,
+                          GomokuBoard::kHeight, GomokuBoard::kK, options.plies,
+                          entries)) {
+    return 1;
+  }
+  printf("Wrote %s\n", options.output.c_str());
+  return 0;
+}
@@ -0,0 +1,198 @@
+////
+// dfpn_solve.cpp
+////
+
+// Solves an m,n,k game from the empty board with DfpnSolver: first whether X
+// can force a win, then, if not, whether O can.  Progress is printed as it
+// goes, and each solve checkpoints its table so an interrupted run resumes
+// where it stopped when started again with the same options.  Ctrl-C stops
+// cleanly after saving a checkpoint.
+
+#include "base/file/file_manager_posix.h"
+#include "base/logging.h"
+#include "base/time.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/dfpn_solver.h"
+#include "tictactoe/core/mnk_board.h"
+
+#include "tool_options.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+using namespace Tictactoe;
+
+namespace {
+const int kDefaultTableBits = 22;
+const int64_t kDefaultProgressNodes = 1000000;
+const int64_t kDefaultCheckpointNodes = 50000000;
+
+const char kUsage[] =
+    "Usage: dfpn_solve [options]\n"
+    "\n"
+    "Options:\n"
+    "  --width=N            Board width (default 4)\n"
+    "  --height=N           Board height (default: the width)\n"
+    "  --k=N                Marks in a row to win (default: the width)\n"
+    "  --table-bits=N       Table of 2^N entries, 24 bytes each (default 22)\n"
+    "  --nodes=N            Node budget for each player's solve, per run\n"
+    "                       (default: none)\n"
+    "  --seconds=S          Time budget for each player's solve, per run\n"
+    "                       (default: none)\n"
+    "  --progress-nodes=N   Print progress every N nodes (default 1000000)\n"
+    "  --checkpoint=F       Checkpoint to F_x and F_o, and resume from them\n"
+    "                       (default: mnk_W_H_K)\n"
+    "  --checkpoint-nodes=N Checkpoint every N nodes (default 50000000)\n"
+    "  --no-checkpoint      Neither save nor resume\n";
+
+const char* const kResultName[] = {"unknown", "proven", "disproven"};
+
+std::atomic<bool> g_cancel(false);
+
+void OnInterrupt(int signal) {
+  g_cancel.store(true);
+}
+
+struct Options {
+  Options()
+      : width(4),
+        height(0),
+        k(0),
+        table_bits(kDefaultTableBits),
+        seconds(0),
+        checkpoint_enabled(true) {
+    limits.progress_interval = kDefaultProgressNodes;
+    limits.checkpoint_interval = kDefaultCheckpointNodes;
+  }
+
+  int width;
+  int height;
+  int k;
+  int table_bits;
+  double seconds;
+  std::string checkpoint;
+  bool checkpoint_enabled;
+  DfpnLimits limits;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("width", &options->width);
+  parser.Add("height", &options->height);
+  parser.Add("k", &options->k);
+  parser.Add("table-bits", &options->table_bits);
+  parser.Add("nodes", &options->limits.max_nodes);
+  parser.Add("seconds", &options->seconds);
+  parser.Add("progress-nodes", &options->limits.progress_interval);
+  parser.Add("checkpoint", &options->checkpoint);
+  parser.Add("checkpoint-nodes", &options->limits.checkpoint_interval);
+  parser.AddFlag("no-checkpoint", &options->checkpoint_enabled, false);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (!options->height)
+    options->height = options->width;
+  if (!options->k)
+    options->k = options->width;
+  if (options->width < 1 || options->width > MnkBoard::kMaxSize ||
+      options->height < 1 || options->height > MnkBoard::kMaxSize ||
+      options->k < 1 ||
+      options->k > std::max(options->width, options->height) ||
+      options->table_bits < 2 || options->table_bits > 32 ||
+      options->seconds < 0) {
+    return false;
+  }
+
+  if (options->checkpoint.empty()) {
+    char name[32];
+    snprintf(name, sizeof(name), "mnk_%d_%d_%d", options->width,
+             options->height, options->k);
+    options->checkpoint = name;
+  }
+  options->limits.max_time = TimeInterval::FromSeconds(options->seconds);
+  if (!options->checkpoint_enabled)
+    options->limits.checkpoint_interval = 0;
+  options->limits.cancel = &g_cancel;
+  return true;
+}
+
+void PrintProgress(const char* label, const DfpnProgress& progress) {
+  printf("%s: pn %u dn %u, %lld nodes in %.1fs, %.0f nodes/sec\n", label,
+         progress.proof_number, progress.disproof_number,
+         static_cast<long long>(progress.nodes), progress.elapsed.Seconds(),
+         progress.NodesPerSecond());
+  fflush(stdout);
+}
+
+class ProgressPrinter : public DfpnSolver::Listener {
+ public:
+  explicit ProgressPrinter(const char* label) : label_(label) {}
+
+  // DfpnSolver::Listener:
+  void OnProgress(const DfpnProgress& progress) override {
+    PrintProgress(label_, progress);
+  }
+
+ private:
+  const char* label_;
+};
+
+// Solve whether |attacker| can force a win from the empty board.
+DfpnProgress SolveFor(DfpnSolver* solver,
+                      const Options& options,
+                      Player attacker) {
+  const char* label = attacker == kPlayerX ? "X wins?" : "O wins?";
+  ProgressPrinter printer(label);
+  solver->set_listener(&printer);
+
+  if (options.checkpoint_enabled) {
+    solver->set_checkpoint_file(options.checkpoint +
+                                (attacker == kPlayerX ? "_x" : "_o"));
+    if (solver->LoadCheckpoint())
+      printf("%s: resuming from checkpoint\n", label);
+  } else {
+    solver->Clear();
+  }
+
+  MnkBoard board(options.width, options.height, options.k);
+  const DfpnProgress progress = solver->Solve(&board, attacker, options.limits);
+  PrintProgress(label, progress);
+  printf("%s: %s", label, kResultName[progress.result]);
+  if (progress.result == DfpnProgress::kResultProven && attacker == kPlayerX)
+    printf(", first move %d", progress.move);
+  printf("\n");
+  solver->set_listener(nullptr);
+  return progress;
+}
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+  signal(SIGINT, OnInterrupt);
+
+  // Checkpoints are relative to the working directory.
+  FileManagerPosix file_manager("", "");
+  DfpnSolver solver(options.table_bits);
+
+  const char* value = "unknown";
+  DfpnProgress x_wins = SolveFor(&solver, options, kPlayerX);
+  if (x_wins.result == DfpnProgress::kResultProven) {
+    value = "X wins";
+  } else if (x_wins.result == DfpnProgress::kResultDisproven) {
+    DfpnProgress o_wins = SolveFor(&solver, options, kPlayerO);
+    if (o_wins.result == DfpnProgress::kResultProven)
+      value = "O wins";
+    else if (o_wins.result == DfpnProgress::kResultDisproven)
+      value = "draw";
+  }
+
+  printf("%dx%d k=%d: %s\n", options.width, options.height, options.k, value);
+  return 0;
+}
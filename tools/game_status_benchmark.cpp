@@ -0,0 +1,91 @@
+////
+// game_status_benchmark.cpp
+////
+
+// Times GetGameStatuses() against checking one position at a time, on the
+// same random positions, and checks that both agree.
+
+#include "base/logging.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/core/game_status.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+const int kDefaultPositions = 1 << 20;
+const int kRepeats = 50;
+
+// Fill the masks with positions reached by random play, stopping after a
+// random number of moves.
+void GeneratePositions(Random* random,
+                       std::vector<uint16_t>* x_masks,
+                       std::vector<uint16_t>* o_masks) {
+  for (size_t i = 0; i < x_masks->size(); ++i) {
+    TictactoeState state;
+    const int num_moves = random->Next() % (TictactoeState::kNumSpaces + 1);
+    for (int move = 0; move < num_moves && !state.game_over(); ++move) {
+      const int space = random->Next() % TictactoeState::kNumSpaces;
+      if (state.IsEmpty(space))
+        state.PlaceMark(space);
+    }
+    (*x_masks)[i] = state.mask(kPlayerX);
+    (*o_masks)[i] = state.mask(kPlayerO);
+  }
+}
+
+typedef void (*StatusFunction)(const uint16_t*,
+                               const uint16_t*,
+                               int,
+                               GameStatus*);
+
+// Return the positions checked per second.
+double Time(StatusFunction function,
+            const std::vector<uint16_t>& x_masks,
+            const std::vector<uint16_t>& o_masks,
+            std::vector<GameStatus>* statuses) {
+  const int count = x_masks.size();
+  const Timestamp start = Timestamp::Now();
+  for (int i = 0; i < kRepeats; ++i)
+    function(x_masks.data(), o_masks.data(), count, statuses->data());
+  const TimeInterval elapsed = Timestamp::Now() - start;
+  return static_cast<double>(count) * kRepeats / elapsed.Seconds();
+}
+}
+
+int main(int argc, char** argv) {
+  const int count = argc > 1 ? atoi(argv[1]) : kDefaultPositions;
+  if (count <= 0) {
+    fprintf(stderr, "Usage: game_status_benchmark [positions]\n");
+    return 1;
+  }
+
+  Random random(1);
+  std::vector<uint16_t> x_masks(count);
+  std::vector<uint16_t> o_masks(count);
+  GeneratePositions(&random, &x_masks, &o_masks);
+
+  std::vector<GameStatus> scalar_statuses(count);
+  std::vector<GameStatus> batch_statuses(count);
+  const double scalar_rate =
+      Time(&GetGameStatusesScalar, x_masks, o_masks, &scalar_statuses);
+  const double batch_rate =
+      Time(&GetGameStatuses, x_masks, o_masks, &batch_statuses);
+
+  if (scalar_statuses != batch_statuses) {
+    fprintf(stderr, "Batch statuses don't match the scalar ones\n");
+    return 1;
+  }
+
+  printf("%d positions, %d passes\n", count, kRepeats);
+  printf("scalar: %8.1f M positions/sec\n", scalar_rate / 1e6);
+  printf("%-6s  %8.1f M positions/sec (%.1fx)\n",
+         GetGameStatusesImplementation(), batch_rate / 1e6,
+         batch_rate / scalar_rate);
+  return 0;
+}
@@ -0,0 +1,488 @@
+////
+// message_loop_test.cpp
+////
+
+// Drives MessageLoop on its own, the way it runs off Android, and checks
+// that immediate tasks run in the order they were posted ahead of delayed
+// ones, that delayed tasks run in the order they come due and never early,
+// that the timer is re-armed when an earlier task is posted, that Quit()
+// stops Run() from a task or another thread and Run() can be called again,
+// that fd() is readable exactly when there's work, and that tasks posted
+// from many threads each run once, with each thread's in order.
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread/message_loop.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+
+#include "tool_options.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace {
+const int kDefaultTasks = 100000;
+const int kDefaultThreads = 8;
+
+// How late the timer may fire a delayed task before the check fails.
+const double kMaxLateMilliseconds = 200;
+
+// Every this many tasks posted from the threads is delayed.
+const int kDelayedTaskInterval = 16;
+
+const char kUsage[] =
+    "Usage: message_loop_test [options]\n"
+    "\n"
+    "Options:\n"
+    "  --tasks=N     Tasks each thread posts (default 100000)\n"
+    "  --threads=N   Threads posting at once (default 8)\n";
+
+struct Options {
+  Options() : tasks(kDefaultTasks), threads(kDefaultThreads) {}
+
+  int tasks;
+  int threads;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("tasks", &options->tasks);
+  parser.Add("threads", &options->threads);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (options->tasks <= 0 || options->threads <= 0)
+    return false;
+  options->threads = tools::ClampWorkers(options->threads);
+  return true;
+}
+
+// The tasks that ran, in the order they ran.
+struct Log {
+  Log() : early(0) {}
+
+  std::vector<int> ids;
+  // Tasks that ran before they were due.
+  int early;
+};
+
+// Adds |id| to the log, and notes whether it ran before |run_time|.
+class RecordTask : public Task {
+ public:
+  RecordTask(Log* log, int id, Timestamp run_time)
+      : log_(log), id_(id), run_time_(run_time) {}
+  ~RecordTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(RecordTask);
+
+  // Task:
+  void Execute() override {
+    if (Timestamp::Now() < run_time_)
+      log_->early++;
+    log_->ids.push_back(id_);
+  }
+
+ private:
+  Log* log_;
+  const int id_;
+  const Timestamp run_time_;
+};
+
+void PostRecord(MessageLoop* loop, Log* log, int id) {
+  loop->PostTask(std::make_unique<RecordTask>(log, id, Timestamp()));
+}
+
+void PostDelayedRecord(MessageLoop* loop,
+                       Log* log,
+                       int id,
+                       double milliseconds) {
+  const TimeInterval delay = TimeInterval::FromMilliseconds(milliseconds);
+  loop->PostDelayedTask(
+      std::make_unique<RecordTask>(log, id, Timestamp::Now() + delay), delay);
+}
+
+class QuitTask : public Task {
+ public:
+  explicit QuitTask(MessageLoop* loop) : loop_(loop) {}
+  ~QuitTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(QuitTask);
+
+  // Task:
+  void Execute() override { loop_->Quit(); }
+
+ private:
+  MessageLoop* loop_;
+};
+
+void PostDelayedQuit(MessageLoop* loop, double milliseconds) {
+  loop->PostDelayedTask(std::make_unique<QuitTask>(loop),
+                        TimeInterval::FromMilliseconds(milliseconds));
+}
+
+bool CheckLog(const char* label,
+              const Log& log,
+              const std::vector<int>& expected) {
+  if (log.ids == expected && !log.early)
+    return true;
+
+  fprintf(stderr, "%s: expected", label);
+  for (int id : expected)
+    fprintf(stderr, " %d", id);
+  fprintf(stderr, ", ran");
+  for (int id : log.ids)
+    fprintf(stderr, " %d", id);
+  fprintf(stderr, ", %d early\n", log.early);
+  return false;
+}
+
+bool CheckElapsed(const char* label,
+                  TimeInterval elapsed,
+                  double expected_milliseconds) {
+  if (elapsed.Milliseconds() < expected_milliseconds + kMaxLateMilliseconds)
+    return true;
+  fprintf(stderr, "%s: took %.1f ms, expected %.1f ms\n", label,
+          elapsed.Milliseconds(), expected_milliseconds);
+  return false;
+}
+
+// Immediate tasks run first in the order they were posted, then delayed
+// ones in the order they come due, the same due time in the order they
+// were posted.
+bool CheckOrder() {
+  MessageLoop loop;
+  Log log;
+  const Timestamp start = Timestamp::Now();
+  PostDelayedRecord(&loop, &log, 5, 40);
+  PostDelayedRecord(&loop, &log, 3, 20);
+  PostRecord(&loop, &log, 1);
+  PostDelayedRecord(&loop, &log, 4, 20);
+  PostRecord(&loop, &log, 2);
+  PostDelayedQuit(&loop, 60);
+  loop.Run();
+  return CheckLog("order", log, {1, 2, 3, 4, 5}) &&
+         CheckElapsed("order", Timestamp::Now() - start, 60);
+}
+
+// Posts a delayed task due sooner than the one the timer is armed for.
+class PostEarlierTask : public Task {
+ public:
+  PostEarlierTask(MessageLoop* loop, Log* log) : loop_(loop), log_(log) {}
+  ~PostEarlierTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(PostEarlierTask);
+
+  // Task:
+  void Execute() override {
+    PostDelayedRecord(loop_, log_, 1, 20);
+    PostDelayedQuit(loop_, 40);
+  }
+
+ private:
+  MessageLoop* loop_;
+  Log* log_;
+};
+
+// The timer is armed for a task a second away when one due in 20 ms is
+// posted, which has to re-arm it for the sooner one.  The later task is
+// still waiting when the loop is run again.
+bool CheckTimerRearm() {
+  MessageLoop loop;
+  Log log;
+  Timestamp start = Timestamp::Now();
+  PostDelayedRecord(&loop, &log, 2, 1000);
+  loop.PostTask(std::make_unique<PostEarlierTask>(&loop, &log));
+  loop.Run();
+  if (!CheckLog("timer re-arm", log, {1}) ||
+      !CheckElapsed("timer re-arm", Timestamp::Now() - start, 40)) {
+    return false;
+  }
+
+  PostDelayedQuit(&loop, 1100);
+  loop.Run();
+  return CheckLog("timer re-arm", log, {1, 2}) &&
+         CheckElapsed("timer re-arm", Timestamp::Now() - start, 1100);
+}
+
+// Quits the loop, and posts a task that has to wait for the next Run().
+class QuitAndPostTask : public Task {
+ public:
+  QuitAndPostTask(MessageLoop* loop, Log* log) : loop_(loop), log_(log) {}
+  ~QuitAndPostTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(QuitAndPostTask);
+
+  // Task:
+  void Execute() override {
+    loop_->Quit();
+    PostRecord(loop_, log_, 3);
+  }
+
+ private:
+  MessageLoop* loop_;
+  Log* log_;
+};
+
+// Waits for the loop to start running, then quits it from this thread.
+class QuitFromThreadTask : public Task {
+ public:
+  QuitFromThreadTask(MessageLoop* loop, const std::atomic<bool>* running)
+      : loop_(loop), running_(running) {}
+  ~QuitFromThreadTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(QuitFromThreadTask);
+
+  // Task:
+  void Execute() override {
+    while (!running_->load(std::memory_order_acquire)) {
+    }
+    loop_->Quit();
+  }
+
+ private:
+  MessageLoop* loop_;
+  const std::atomic<bool>* running_;
+};
+
+class SetFlagTask : public Task {
+ public:
+  explicit SetFlagTask(std::atomic<bool>* flag) : flag_(flag) {}
+  ~SetFlagTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(SetFlagTask);
+
+  // Task:
+  void Execute() override { flag_->store(true, std::memory_order_release); }
+
+ private:
+  std::atomic<bool>* flag_;
+};
+
+// Quit() from a task lets the rest of the tasks that are due run, and Run()
+// returns before the ones they post.  Quit() from another thread wakes the
+// loop while it waits with nothing to do.
+bool CheckQuit() {
+  MessageLoop loop;
+  Log log;
+  PostRecord(&loop, &log, 1);
+  loop.PostTask(std::make_unique<QuitAndPostTask>(&loop, &log));
+  PostRecord(&loop, &log, 2);
+  loop.Run();
+  if (!CheckLog("quit", log, {1, 2}))
+    return false;
+
+  loop.PostTask(std::make_unique<QuitTask>(&loop));
+  loop.Run();
+  if (!CheckLog("quit", log, {1, 2, 3}))
+    return false;
+
+  std::atomic<bool> running(false);
+  Thread thread;
+  thread.Start(std::make_unique<QuitFromThreadTask>(&loop, &running));
+  loop.PostTask(std::make_unique<SetFlagTask>(&running));
+  loop.Run();
+  thread.Join();
+  return true;
+}
+
+// Whether |fd| is readable within |milliseconds|.
+bool WaitReadable(int fd, int milliseconds) {
+  pollfd poll_fd = {};
+  poll_fd.fd = fd;
+  poll_fd.events = POLLIN;
+  return poll(&poll_fd, 1, milliseconds) > 0;
+}
+
+// Another event loop waits on fd() and calls RunPendingTasks(), the way
+// Android's looper does.  fd() is readable while there's work, and not
+// once it's done.
+bool CheckFd() {
+  MessageLoop loop;
+  Log log;
+  if (WaitReadable(loop.fd(), 0)) {
+    fprintf(stderr, "fd: readable with no tasks\n");
+    return false;
+  }
+
+  PostDelayedRecord(&loop, &log, 2, 20);
+  PostRecord(&loop, &log, 1);
+  while (log.ids.size() < 2) {
+    if (!WaitReadable(loop.fd(), 1000)) {
+      fprintf(stderr, "fd: not readable with tasks waiting\n");
+      return false;
+    }
+    loop.RunPendingTasks();
+  }
+  if (!CheckLog("fd", log, {1, 2}))
+    return false;
+  if (WaitReadable(loop.fd(), 0)) {
+    fprintf(stderr, "fd: readable after the tasks ran\n");
+    return false;
+  }
+  return true;
+}
+
+// What the tasks posted from the threads saw, only touched on the loop's
+// thread.
+struct PostedCounts {
+  PostedCounts(int num_threads, int num_tasks)
+      : runs(num_threads * num_tasks, 0),
+        last_immediate(num_threads, -1),
+        total(0),
+        out_of_order(0) {}
+
+  // How many times each thread's tasks ran.
+  std::vector<int> runs;
+  // The last immediate task of each thread that ran.
+  std::vector<int> last_immediate;
+  int total;
+  int out_of_order;
+};
+
+class PostedTask : public Task {
+ public:
+  PostedTask(MessageLoop* loop,
+             PostedCounts* counts,
+             int num_tasks,
+             int thread_index,
+             int task_index,
+             bool delayed)
+      : loop_(loop),
+        counts_(counts),
+        num_tasks_(num_tasks),
+        thread_index_(thread_index),
+        task_index_(task_index),
+        delayed_(delayed) {}
+  ~PostedTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(PostedTask);
+
+  // Task:
+  void Execute() override {
+    counts_->runs[thread_index_ * num_tasks_ + task_index_]++;
+    if (!delayed_) {
+      int* last = &counts_->last_immediate[thread_index_];
+      if (task_index_ <= *last)
+        counts_->out_of_order++;
+      *last = task_index_;
+    }
+    if (++counts_->total == static_cast<int>(counts_->runs.size()))
+      loop_->Quit();
+  }
+
+ private:
+  MessageLoop* loop_;
+  PostedCounts* counts_;
+  const int num_tasks_;
+  const int thread_index_;
+  const int task_index_;
+  const bool delayed_;
+};
+
+// Posts its tasks as fast as it can once told to go, some of them with a
+// short delay.
+class PosterTask : public Task {
+ public:
+  PosterTask(MessageLoop* loop,
+             PostedCounts* counts,
+             int num_tasks,
+             int thread_index,
+             const std::atomic<bool>* go)
+      : loop_(loop),
+        counts_(counts),
+        num_tasks_(num_tasks),
+        thread_index_(thread_index),
+        go_(go) {}
+  ~PosterTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(PosterTask);
+
+  // Task:
+  void Execute() override {
+    while (!go_->load(std::memory_order_acquire)) {
+    }
+    for (int i = 0; i < num_tasks_; ++i) {
+      const bool delayed = i % kDelayedTaskInterval == 0;
+      auto task = std::make_unique<PostedTask>(loop_, counts_, num_tasks_,
+                                               thread_index_, i, delayed);
+      if (delayed) {
+        loop_->PostDelayedTask(std::move(task),
+                               TimeInterval::FromMilliseconds(i % 3));
+      } else {
+        loop_->PostTask(std::move(task));
+      }
+    }
+  }
+
+ private:
+  MessageLoop* loop_;
+  PostedCounts* counts_;
+  const int num_tasks_;
+  const int thread_index_;
+  const std::atomic<bool>* go_;
+};
+
+// Many threads post at once, enough to back up past the loop's lock-free
+// queue.  Every task runs once, and each thread's immediate tasks run in
+// the order it posted them.
+bool CheckManyThreads(const Options& options) {
+  MessageLoop loop;
+  PostedCounts counts(options.threads, options.tasks);
+  std::atomic<bool> go(false);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < options.threads; ++i) {
+    threads.push_back(std::make_unique<Thread>());
+    threads.back()->Start(std::make_unique<PosterTask>(
+        &loop, &counts, options.tasks, i, &go));
+  }
+
+  const Timestamp start = Timestamp::Now();
+  go.store(true, std::memory_order_release);
+  loop.Run();
+  const TimeInterval elapsed = Timestamp::Now() - start;
+  for (auto& thread : threads)
+    thread->Join();
+
+  int wrong_runs = 0;
+  for (int runs : counts.runs) {
+    if (runs != 1)
+      wrong_runs++;
+  }
+  if (wrong_runs || counts.out_of_order) {
+    fprintf(stderr,
+            "many threads: %d tasks didn't run exactly once, %d ran out of "
+            "order\n",
+            wrong_runs, counts.out_of_order);
+    return false;
+  }
+  printf("many threads: %d threads posted %d tasks in %.1f ms, %.2f M "
+         "tasks/sec\n",
+         options.threads, counts.total, elapsed.Milliseconds(),
+         counts.total / elapsed.Seconds() / 1e6);
+  return true;
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  if (!CheckOrder())
+    return 1;
+  printf("order: ok\n");
+  if (!CheckTimerRearm())
+    return 1;
+  printf("timer re-arm: ok\n");
+  if (!CheckQuit())
+    return 1;
+  printf("quit: ok\n");
+  if (!CheckFd())
+    return 1;
+  printf("fd: ok\n");
+  if (!CheckManyThreads(options))
+    return 1;
+  return 0;
+}
@@ -0,0 +1,149 @@
+////
+// perfect_play_check.cpp
+////
+
+// Walks every position reachable in a classic game and checks the compile
+// time perfect play table against a plain recursive minimax: the score
+// LookupPerfectPlay() gives each position has to match the minimax score,
+// and the move it gives has to be an empty space that reaches that score,
+// or -1 once the game is over.
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/perfect_play.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include <stdio.h>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+// Positions reachable from the empty board, counting it, with symmetric
+// positions counted separately.
+const int kExpectedPositions = 5478;
+
+// The most errors printed before the rest are only counted.
+const int kMaxPrintedErrors = 20;
+
+// The score of |state| for the player to move, the same way the table
+// scores it: positive for a win, negative for a loss and 0 for a draw, with
+// faster wins and slower losses further from 0.  |state| is restored before
+// returning.
+int Minimax(TictactoeState* state) {
+  if (state->game_over()) {
+    if (state->winner() == kPlayerNone)
+      return 0;
+    // The player who just moved won.
+    return -(TictactoeState::kNumSpaces + 1 - state->num_moves());
+  }
+
+  int best_score = -TictactoeState::kNumSpaces - 1;
+  for (uint16_t empty = state->empty_mask(); empty; empty &= empty - 1) {
+    state->PlaceMark(bits::FindFirstSet(empty));
+    const int score = -Minimax(state);
+    state->RemoveLastMark();
+    if (score > best_score)
+      best_score = score;
+  }
+  return best_score;
+}
+
+struct Results {
+  Results() : positions(0), wrong_scores(0), wrong_moves(0) {}
+
+  int positions;
+  int wrong_scores;
+  int wrong_moves;
+
+  int errors() const { return wrong_scores + wrong_moves; }
+};
+
+void PrintPosition(const TictactoeState& state) {
+  for (int space = 0; space < TictactoeState::kNumSpaces; ++space) {
+    const Player player = state.Get(space);
+    fputc(player == kPlayerX ? 'X' : player == kPlayerO ? 'O' : '.', stderr);
+  }
+}
+
+// Check |state| against minimax.
+void CheckPosition(TictactoeState* state, Results* results) {
+  results->positions++;
+  const PerfectPlayEntry entry = LookupPerfectPlay(*state);
+  const int score = Minimax(state);
+
+  bool move_ok;
+  int move_score = 0;
+  if (state->game_over()) {
+    move_ok = entry.move == -1;
+  } else {
+    move_ok = entry.move >= 0 && entry.move < TictactoeState::kNumSpaces &&
+              state->IsEmpty(entry.move);
+    if (move_ok) {
+      state->PlaceMark(entry.move);
+      move_score = -Minimax(state);
+      state->RemoveLastMark();
+      move_ok = move_score == score;
+    }
+  }
+
+  if (entry.score != score)
+    results->wrong_scores++;
+  if (!move_ok)
+    results->wrong_moves++;
+  if ((entry.score != score || !move_ok) &&
+      results->errors() <= kMaxPrintedErrors) {
+    PrintPosition(*state);
+    fprintf(stderr, ": table score %d move %d, minimax score %d", entry.score,
+            entry.move, score);
+    if (!state->game_over() && entry.move >= 0)
+      fprintf(stderr, ", the move scores %d", move_score);
+    fputc('\n', stderr);
+  }
+}
+
+// Check |state| and every position below it that hasn't been checked yet.
+// |state| is restored before returning.
+void Walk(TictactoeState* state,
+          std::vector<bool>* checked,
+          Results* results) {
+  if ((*checked)[state->index()])
+    return;
+  (*checked)[state->index()] = true;
+  CheckPosition(state, results);
+  if (state->game_over())
+    return;
+
+  for (uint16_t empty = state->empty_mask(); empty; empty &= empty - 1) {
+    state->PlaceMark(bits::FindFirstSet(empty));
+    Walk(state, checked, results);
+    state->RemoveLastMark();
+  }
+}
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    fputs("Usage: perfect_play_check\n", stderr);
+    return 1;
+  }
+
+  const Timestamp start = Timestamp::Now();
+  std::vector<bool> checked(TictactoeState::kNumIndices, false);
+  Results results;
+  TictactoeState state;
+  Walk(&state, &checked, &results);
+  const TimeInterval elapsed = Timestamp::Now() - start;
+
+  printf("%d positions checked in %.2fs, %d wrong scores, %d wrong moves\n",
+         results.positions, elapsed.Seconds(), results.wrong_scores,
+         results.wrong_moves);
+  if (results.positions != kExpectedPositions) {
+    fprintf(stderr, "Expected %d positions\n", kExpectedPositions);
+    return 1;
+  }
+  return results.errors() ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+////
+// perft.cpp
+////
+
+// Walks the complete tic tac toe game tree with TictactoeState::PlaceMark()
+// and RemoveLastMark(), checks the node and game counts against the known
+// ones, and reports how fast it went on one thread and with the root moves
+// split across threads.
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+
+using namespace Tictactoe;
+
+namespace {
+const int kDefaultRepeats = 100;
+
+const char kUsage[] =
+    "Usage: perft [options]\n"
+    "\n"
+    "Options:\n"
+    "  --repeats=N   Walk the tree N times for each timing (default 100)\n"
+    "  --threads=N   Threads for the parallel walk (default: all cores)\n";
+
+struct Counts {
+  Counts() : nodes(0), games(0), x_wins(0), o_wins(0), draws(0) {}
+
+  void Add(const Counts& other) {
+    nodes += other.nodes;
+    games += other.games;
+    x_wins += other.x_wins;
+    o_wins += other.o_wins;
+    draws += other.draws;
+  }
+
+  bool operator==(const Counts& other) const {
+    return nodes == other.nodes && games == other.games &&
+           x_wins == other.x_wins && o_wins == other.o_wins &&
+           draws == other.draws;
+  }
+  bool operator!=(const Counts& other) const { return !(*this == other); }
+
+  // Every position reached, counting the empty board.
+  int64_t nodes;
+  // Positions where the game ended.
+  int64_t games;
+  int64_t x_wins;
+  int64_t o_wins;
+  int64_t draws;
+};
+
+// The counts for one walk of the whole tree.
+Counts ExpectedCounts() {
+  Counts counts;
+  counts.nodes = 549946;
+  counts.games = 255168;
+  counts.x_wins = 131184;
+  counts.o_wins = 77904;
+  counts.draws = 46080;
+  return counts;
+}
+
+// Count |state| and every position below it.  |state| is restored before
+// returning.
+void Perft(TictactoeState* state, Counts* counts) {
+  counts->nodes++;
+  if (state->game_over()) {
+    counts->games++;
+    switch (state->winner()) {
+      case kPlayerX:
+        counts->x_wins++;
+        break;
+      case kPlayerO:
+        counts->o_wins++;
+        break;
+      case kPlayerNone:
+        counts->draws++;
+        break;
+    }
+    return;
+  }
+
+  for (uint16_t empty = state->empty_mask(); empty; empty &= empty - 1) {
+    const int space = bits::FindFirstSet(empty);
+    state->PlaceMark(space);
+    Perft(state, counts);
+    state->RemoveLastMark();
+  }
+}
+
+struct Options {
+  Options() : repeats(kDefaultRepeats), threads(thread::GetProcessorCount()) {}
+
+  int repeats;
+  int threads;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("repeats", &options->repeats);
+  parser.Add("threads", &options->threads);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (options->repeats <= 0 || options->threads <= 0)
+    return false;
+  options->threads = tools::ClampWorkers(options->threads);
+  return true;
+}
+
+////
+// ParallelPerft
+////
+
+// Walks the tree |repeats| times, handing out the subtrees under each root
+// move to whichever thread is free.
+class ParallelPerft {
+ public:
+  ParallelPerft(int repeats, int threads)
+      : repeats_(repeats), threads_(threads), next_subtree_(0) {}
+  DISALLOW_COPY_AND_ASSIGN(ParallelPerft);
+
+  Counts Run();
+
+ private:
+  class WorkerTask;
+
+  void RunWorker(Counts* counts);
+
+  const int repeats_;
+  const int threads_;
+  std::atomic<int> next_subtree_;
+};
+
+class ParallelPerft::WorkerTask : public Task {
+ public:
+  WorkerTask(ParallelPerft* perft, Counts* counts)
+      : perft_(perft), counts_(counts) {}
+  ~WorkerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerTask);
+
+  // Task:
+  void Execute() override { perft_->RunWorker(counts_); }
+
+ private:
+  ParallelPerft* perft_;
+  Counts* counts_;
+};
+
+Counts ParallelPerft::Run() {
+  // Each worker keeps its own counts, which are added up at the end.
+  std::unique_ptr<Counts[]> worker_counts(new Counts[threads_]);
+  std::unique_ptr<Thread[]> threads(new Thread[threads_]);
+  for (int i = 1; i < threads_; ++i)
+    threads[i].Start(std::make_unique<WorkerTask>(this, &worker_counts[i]));
+  RunWorker(&worker_counts[0]);
+  for (int i = 1; i < threads_; ++i)
+    threads[i].Join();
+
+  // The subtrees don't include the empty board itself.
+  Counts counts;
+  counts.nodes = repeats_;
+  for (int i = 0; i < threads_; ++i)
+    counts.Add(worker_counts[i]);
+  return counts;
+}
+
+// private:
+void ParallelPerft::RunWorker(Counts* counts) {
+  const int num_subtrees = repeats_ * TictactoeState::kNumSpaces;
+  while (true) {
+    const int subtree = next_subtree_++;
+    if (subtree >= num_subtrees)
+      break;
+
+    TictactoeState state;
+    state.PlaceMark(subtree % TictactoeState::kNumSpaces);
+    Perft(&state, counts);
+  }
+}
+
+bool CheckCounts(const char* label, const Counts& counts, int repeats) {
+  const Counts expected = ExpectedCounts();
+  Counts expected_total;
+  for (int i = 0; i < repeats; ++i)
+    expected_total.Add(expected);
+  if (counts == expected_total)
+    return true;
+
+  fprintf(stderr,
+          "%s: expected %lld nodes and %lld games, got %lld nodes, %lld games "
+          "(%lld X wins, %lld O wins, %lld draws)\n",
+          label, static_cast<long long>(expected_total.nodes),
+          static_cast<long long>(expected_total.games),
+          static_cast<long long>(counts.nodes),
+          static_cast<long long>(counts.games),
+          static_cast<long long>(counts.x_wins),
+          static_cast<long long>(counts.o_wins),
+          static_cast<long long>(counts.draws));
+  return false;
+}
+
+void PrintRate(const char* label, const Counts& counts, TimeInterval elapsed) {
+  printf("%-20s %8.2fs  %8.1f M nodes/sec\n", label, elapsed.Seconds(),
+         counts.nodes / elapsed.Seconds() / 1e6);
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  const Counts expected = ExpectedCounts();
+  printf("%lld nodes, %lld games (%lld X wins, %lld O wins, %lld draws) per "
+         "walk, %d walks\n",
+         static_cast<long long>(expected.nodes),
+         static_cast<long long>(expected.games),
+         static_cast<long long>(expected.x_wins),
+         static_cast<long long>(expected.o_wins),
+         static_cast<long long>(expected.draws), options.repeats);
+
+  Timestamp start = Timestamp::Now();
+  Counts single_counts;
+  for (int i = 0; i < options.repeats; ++i) {
+    TictactoeState state;
+    Perft(&state, &single_counts);
+  }
+  const TimeInterval single_elapsed = Timestamp::Now() - start;
+  if (!CheckCounts("1 thread", single_counts, options.repeats))
+    return 1;
+  PrintRate("1 thread", single_counts, single_elapsed);
+
+  start = Timestamp::Now();
+  ParallelPerft parallel(options.repeats, options.threads);
+  const Counts parallel_counts = parallel.Run();
+  const TimeInterval parallel_elapsed = Timestamp::Now() - start;
+  char label[32];
+  snprintf(label, sizeof(label), "%d thread%s split", options.threads,
+           options.threads == 1 ? "" : "s");
+  if (!CheckCounts(label, parallel_counts, options.repeats))
+    return 1;
+  PrintRate(label, parallel_counts, parallel_elapsed);
+  printf("Speedup: %.2fx\n",
+         single_elapsed.Seconds() / parallel_elapsed.Seconds());
+  return 0;
+}
@@ -0,0 +1,248 @@
+////
+// rules_benchmark.cpp
+////
+
+// Compares GameState<ClassicRules> against a 3x3 state written out by hand,
+// walking the complete game tree with each, then times the other rulesets.
+// The template should be no slower than the hand-written state.
+
+#include "base/basic_types.h"
+#include "base/logging.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/game_rules.h"
+#include "tictactoe/core/game_state.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+
+using namespace Tictactoe;
+
+namespace {
+const int kDefaultRepeats = 20;
+const int kDefaultDepth = 7;
+
+// Each timing is the best of this many runs.
+const int kRounds = 3;
+
+const char kUsage[] =
+    "Usage: rules_benchmark [options]\n"
+    "\n"
+    "Options:\n"
+    "  --repeats=N   Walk the 3x3 trees N times for each timing (default 20)\n"
+    "  --depth=N     Walk the 4x4 trees N moves deep (default 7)\n";
+
+// The classic 3x3 state with its lines, masks and tables spelled out, as it
+// was before the rules became a template.
+const int kNumSpaces = 9;
+const int kNumLines = 8;
+const uint16_t kFullMask = 0x1ff;
+
+constexpr uint16_t kLineMasks[kNumLines] = {
+    0x007, 0x038, 0x1c0,  // Rows
+    0x049, 0x092, 0x124,  // Columns
+    0x111, 0x054,         // Diagonals
+};
+
+constexpr int kPowersOf3[kNumSpaces] = {
+    1, 3, 9, 27, 81, 243, 729, 2187, 6561,
+};
+
+// One bit per 9 bit mask, set if the mask contains a complete line.
+struct LineTable {
+  uint8_t bits[(kFullMask + 1) / 8];
+};
+
+constexpr LineTable GenerateLineTable() {
+  LineTable table{};
+  for (int mask = 0; mask <= kFullMask; ++mask) {
+    for (int i = 0; i < kNumLines; ++i) {
+      if ((mask & kLineMasks[i]) == kLineMasks[i])
+        table.bits[mask / 8] |= 1 << (mask % 8);
+    }
+  }
+  return table;
+}
+
+constexpr LineTable kLineTable = GenerateLineTable();
+
+class HandWrittenState {
+ public:
+  HandWrittenState()
+      : x_mask_(0),
+        o_mask_(0),
+        index_(0),
+        turn_(kPlayerX),
+        winner_(kPlayerNone),
+        num_moves_(0) {}
+
+  Player winner() const { return winner_; }
+  bool game_over() const { return turn_ == kPlayerNone; }
+  int index() const { return index_; }
+  uint16_t empty_mask() const { return ~(x_mask_ | o_mask_) & kFullMask; }
+
+  void PlaceMark(int space) {
+    uint16_t* marks = turn_ == kPlayerX ? &x_mask_ : &o_mask_;
+    *marks |= 1 << space;
+    index_ += turn_ * kPowersOf3[space];
+    moves_[num_moves_++] = space;
+
+    if ((kLineTable.bits[*marks / 8] >> (*marks % 8)) & 1) {
+      winner_ = turn_;
+      turn_ = kPlayerNone;
+    } else if (!empty_mask()) {
+      turn_ = kPlayerNone;
+    } else {
+      turn_ = turn_ == kPlayerX ? kPlayerO : kPlayerX;
+    }
+  }
+
+  int RemoveLastMark() {
+    const int space = moves_[--num_moves_];
+    const Player player = (x_mask_ >> space) & 1 ? kPlayerX : kPlayerO;
+    uint16_t* marks = player == kPlayerX ? &x_mask_ : &o_mask_;
+    *marks &= ~(1 << space);
+    index_ -= player * kPowersOf3[space];
+    turn_ = player;
+    winner_ = kPlayerNone;
+    return space;
+  }
+
+ private:
+  uint16_t x_mask_;
+  uint16_t o_mask_;
+  int index_;
+  Player turn_;
+  Player winner_;
+  int8_t num_moves_;
+  int8_t moves_[kNumSpaces];
+};
+
+struct Counts {
+  Counts() : nodes(0), x_wins(0), o_wins(0), draws(0), index_sum(0) {}
+
+  bool operator==(const Counts& other) const {
+    return nodes == other.nodes && x_wins == other.x_wins &&
+           o_wins == other.o_wins && draws == other.draws &&
+           index_sum == other.index_sum;
+  }
+
+  int64_t nodes;
+  int64_t x_wins;
+  int64_t o_wins;
+  int64_t draws;
+  // Keeps the index updates from being optimized away.
+  int64_t index_sum;
+};
+
+// Count |state| and every position below it, up to |depth| more moves.
+template <typename State>
+void Perft(State* state, int depth, Counts* counts) {
+  counts->nodes++;
+  counts->index_sum += state->index();
+  if (state->game_over()) {
+    switch (state->winner()) {
+      case kPlayerX:
+        counts->x_wins++;
+        break;
+      case kPlayerO:
+        counts->o_wins++;
+        break;
+      case kPlayerNone:
+        counts->draws++;
+        break;
+    }
+    return;
+  }
+  if (!depth)
+    return;
+
+  for (uint16_t empty = state->empty_mask(); empty; empty &= empty - 1) {
+    state->PlaceMark(bits::FindFirstSet(empty));
+    Perft(state, depth - 1, counts);
+    state->RemoveLastMark();
+  }
+}
+
+// Walk the tree from the empty board |repeats| times, and return the best
+// time of kRounds runs.
+template <typename State>
+TimeInterval TimePerft(int repeats, int depth, Counts* counts) {
+  TimeInterval best;
+  for (int round = 0; round < kRounds; ++round) {
+    *counts = Counts();
+    const Timestamp start = Timestamp::Now();
+    for (int i = 0; i < repeats; ++i) {
+      State state;
+      Perft(&state, depth, counts);
+    }
+    const TimeInterval elapsed = Timestamp::Now() - start;
+    if (!round || elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+void PrintRate(const char* label, const Counts& counts, TimeInterval elapsed) {
+  printf("%-16s %12lld nodes %8.3fs  %8.1f M nodes/sec\n", label,
+         static_cast<long long>(counts.nodes), elapsed.Seconds(),
+         counts.nodes / elapsed.Seconds() / 1e6);
+}
+
+template <typename Rules>
+void RunVariant(const char* label, int repeats, int depth) {
+  Counts counts;
+  const TimeInterval elapsed =
+      TimePerft<GameState<Rules>>(repeats, depth, &counts);
+  PrintRate(label, counts, elapsed);
+}
+
+struct Options {
+  Options() : repeats(kDefaultRepeats), depth(kDefaultDepth) {}
+
+  int repeats;
+  int depth;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("repeats", &options->repeats);
+  parser.Add("depth", &options->depth);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+  return options->repeats > 0 && options->depth > 0;
+}
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  // The whole 3x3 tree is at most 9 moves deep.
+  const int full_depth = 9;
+  Counts hand_counts;
+  const TimeInterval hand_elapsed =
+      TimePerft<HandWrittenState>(options.repeats, full_depth, &hand_counts);
+  Counts template_counts;
+  const TimeInterval template_elapsed = TimePerft<GameState<ClassicRules>>(
+      options.repeats, full_depth, &template_counts);
+  if (!(hand_counts == template_counts)) {
+    fprintf(stderr, "The template and hand-written states disagree\n");
+    return 1;
+  }
+
+  PrintRate("Hand-written 3x3", hand_counts, hand_elapsed);
+  PrintRate("Classic", template_counts, template_elapsed);
+  printf("Template / hand-written time: %.3f\n",
+         template_elapsed.Seconds() / hand_elapsed.Seconds());
+
+  RunVariant<MisereRules>("Misere", options.repeats, full_depth);
+  RunVariant<FourByFourRules>("4x4", 1, options.depth);
+  RunVariant<WrapRules>("4x4 wrap", 1, options.depth);
+  return 0;
+}
@@ -0,0 +1,191 @@
+////
+// search_benchmark.cpp
+////
+
+// Measures how MnkSearch's Lazy SMP scales.  Searches a set of random
+// opening positions to a fixed depth with 1, 2, 4 and 8 threads, each time
+// with an empty table, and reports the time to reach the depth, nodes/sec
+// and the speedup over one thread.
+
+#include "base/logging.h"
+#include "base/math/math.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/core/mnk_board.h"
+#include "tictactoe/core/mnk_search.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+const int kDefaultWidth = 15;
+const int kDefaultK = 5;
+const int kDefaultDepth = 5;
+const int kDefaultPositions = 8;
+const int kDefaultMoves = 6;
+const int kDefaultMaxThreads = 8;
+const int kDefaultTableBits = 20;
+
+// Random moves stay next to the marks already played.
+const int kRandomMoveDistance = 1;
+
+const char kUsage[] =
+    "Usage: search_benchmark [options]\n"
+    "\n"
+    "Options:\n"
+    "  --width=N        Board width (default 15)\n"
+    "  --height=N       Board height (default: the width)\n"
+    "  --k=N            Marks in a row to win (default 5)\n"
+    "  --depth=N        Depth to search each position to (default 5)\n"
+    "  --positions=N    Number of positions to search (default 8)\n"
+    "  --moves=N        Random moves played into each position (default 6)\n"
+    "  --max-threads=N  Double the threads from 1 up to N (default 8)\n"
+    "  --table-bits=N   Transposition table size, log2 (default 20)\n"
+    "  --seed=N         Seed for the positions (default 0)\n";
+
+struct Options {
+  Options()
+      : width(kDefaultWidth),
+        height(0),
+        k(kDefaultK),
+        depth(kDefaultDepth),
+        positions(kDefaultPositions),
+        moves(kDefaultMoves),
+        max_threads(kDefaultMaxThreads),
+        table_bits(kDefaultTableBits),
+        seed(0) {}
+
+  int width;
+  int height;
+  int k;
+  int depth;
+  int positions;
+  int moves;
+  int max_threads;
+  int table_bits;
+  uint32_t seed;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("width", &options->width);
+  parser.Add("height", &options->height);
+  parser.Add("k", &options->k);
+  parser.Add("depth", &options->depth);
+  parser.Add("positions", &options->positions);
+  parser.Add("moves", &options->moves);
+  parser.Add("max-threads", &options->max_threads);
+  parser.Add("table-bits", &options->table_bits);
+  parser.Add("seed", &options->seed);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (!options->height)
+    options->height = options->width;
+  if (options->width < 1 || options->width > MnkBoard::kMaxSize ||
+      options->height < 1 || options->height > MnkBoard::kMaxSize ||
+      options->k < 1 ||
+      options->k > std::max(options->width, options->height) ||
+      options->depth < 1 || options->positions < 1 || options->moves < 0 ||
+      options->moves >= options->width * options->height ||
+      options->max_threads < 1 || options->table_bits < 10 ||
+      options->table_bits > 30) {
+    return false;
+  }
+  options->max_threads =
+      math::Clamp<int>(options->max_threads, 1, MnkSearch::kMaxThreads);
+  return true;
+}
+
+// Play |moves| random moves next to the marks already played, starting in the
+// center, stopping short of a finished game.
+MnkBoard CreatePosition(const Options& options, Random* random) {
+  MnkBoard board(options.width, options.height, options.k);
+  const int center =
+      options.height / 2 * options.width + options.width / 2;
+  std::vector<int> spaces;
+  for (int i = 0; i < options.moves; ++i) {
+    spaces.clear();
+    for (int space = 0; space < board.num_spaces(); ++space) {
+      if (board.IsEmpty(space) &&
+          (!i ? space == center
+              : board.HasNeighbor(space, kRandomMoveDistance))) {
+        spaces.push_back(space);
+      }
+    }
+    const int space = spaces[static_cast<int>(random->NextDouble() *
+                                              spaces.size())];
+    board.PlaceMark(space);
+    if (board.game_over()) {
+      board.RemoveMark(space);
+      break;
+    }
+  }
+  return board;
+}
+
+struct Timing {
+  Timing() : seconds(0), nodes(0) {}
+
+  double seconds;
+  int64_t nodes;
+};
+
+Timing SearchPositions(const Options& options,
+                       const std::vector<MnkBoard>& positions,
+                       int num_threads) {
+  Timing timing;
+  for (const MnkBoard& position : positions) {
+    // A fresh table each time, so no search starts ahead of another.
+    MnkSearch search(options.table_bits);
+    MnkBoard board = position;
+    MnkSearchLimits limits;
+    limits.max_depth = options.depth;
+    limits.num_threads = num_threads;
+    const MnkSearchResult result = search.Search(&board, limits);
+    timing.seconds += result.elapsed.Seconds();
+    timing.nodes += result.nodes;
+  }
+  return timing;
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  Random random(options.seed);
+  std::vector<MnkBoard> positions;
+  for (int i = 0; i < options.positions; ++i)
+    positions.push_back(CreatePosition(options, &random));
+
+  printf("%d positions on %dx%d k=%d, searched to depth %d, %d cores\n",
+         options.positions, options.width, options.height, options.k,
+         options.depth, thread::GetProcessorCount());
+  printf("%7s %12s %10s %14s %8s\n", "threads", "nodes", "time",
+         "nodes/sec", "speedup");
+
+  double base_seconds = 0;
+  for (int threads = 1; threads <= options.max_threads; threads *= 2) {
+    const Timing timing = SearchPositions(options, positions, threads);
+    const double seconds = timing.seconds;
+    if (threads == 1)
+      base_seconds = seconds;
+    printf("%7d %12lld %9.3fs %14.0f %7.2fx\n", threads,
+           static_cast<long long>(timing.nodes), seconds,
+           seconds > 0 ? timing.nodes / seconds : 0,
+           seconds > 0 ? base_seconds / seconds : 0);
+  }
+  return 0;
+}
@@ -0,0 +1,328 @@
+////
+// self_play.cpp
+////
+
+// Plays two computer strategies against each other without any UI, with the
+// games spread across every processor.  Each finished game is written to the
+// output file as one line:
+//
+//   <x strategy> <o strategy> <winner: x, o or d for a draw> <moves>
+//
+// where <moves> lists the spaces played in order, 0 to 8.
+
+#include "base/file/file_posix.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/thread/mutex.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+#include "base/util/random.h"
+#include "tictactoe/constants.h"
+#include "tictactoe/core/computer_player.h"
+#include "tictactoe/core/tictactoe_state.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+struct Strategy {
+  const char* name;
+  Difficulty difficulty;
+};
+
+// Add new engines here to make them available to self play.
+const Strategy kStrategies[] = {
+    {"easy", kDifficultyEasy},
+    {"hard", kDifficultyHard},
+    {"expert", kDifficultyExpert},
+    {"montecarlo", kDifficultyMonteCarlo},
+    {"impossible", kDifficultyImpossible},
+    {"threatspace", kDifficultyThreatSpace},
+};
+
+const int kDefaultGames = 10000;
+const double kDefaultMoveSeconds = 0.01;
+
+// Each worker writes its games out in batches of this many.
+const int kFlushGames = 256;
+
+const char kWinnerName[] = {'d', 'x', 'o'};
+
+const char kUsage[] =
+    "Usage: self_play [options] <strategy> <strategy>\n"
+    "\n"
+    "Strategies: easy, hard, expert, montecarlo, impossible, threatspace.\n"
+    "The first strategy plays X in even games and O in odd ones.\n"
+    "\n"
+    "Options:\n"
+    "  --games=N     Number of games to play (default 10000)\n"
+    "  --threads=N   Number of games to play at once (default: all cores)\n"
+    "  --seconds=S   Search time per move for the search engines\n"
+    "                (default 0.01)\n"
+    "  --seed=N      Seed for the random moves\n"
+    "  --no-swap     The first strategy always plays X\n"
+    "  --output=F    Write each game to F\n";
+
+struct Record {
+  Record() : wins(0), draws(0), losses(0) {}
+
+  void Add(const Record& other) {
+    wins += other.wins;
+    draws += other.draws;
+    losses += other.losses;
+  }
+
+  int64_t games() const { return wins + draws + losses; }
+
+  int64_t wins;
+  int64_t draws;
+  int64_t losses;
+};
+
+struct Options {
+  Options()
+      : games(kDefaultGames),
+        threads(thread::GetProcessorCount()),
+        move_seconds(kDefaultMoveSeconds),
+        seed(0),
+        swap(true) {}
+
+  const Strategy* strategies[2];
+  int64_t games;
+  int threads;
+  double move_seconds;
+  uint32_t seed;
+  bool swap;
+  std::string output;
+};
+
+const Strategy* FindStrategy(const char* name) {
+  for (const Strategy& strategy : kStrategies) {
+    if (!strcmp(strategy.name, name))
+      return &strategy;
+  }
+  return nullptr;
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  options->seed = Random::get()->Next();
+
+  std::vector<const char*> strategy_names;
+  tools::OptionParser parser;
+  parser.Add("games", &options->games);
+  parser.Add("threads", &options->threads);
+  parser.Add("seconds", &options->move_seconds);
+  parser.Add("seed", &options->seed);
+  parser.Add("output", &options->output);
+  parser.AddFlag("no-swap", &options->swap, false);
+  if (!parser.Parse(argc, argv, &strategy_names))
+    return false;
+
+  if (strategy_names.size() != 2)
+    return false;
+  for (int i = 0; i < 2; ++i) {
+    options->strategies[i] = FindStrategy(strategy_names[i]);
+    if (!options->strategies[i]) {
+      fprintf(stderr, "Unknown strategy: %s\n", strategy_names[i]);
+      return false;
+    }
+  }
+
+  if (options->games <= 0 || options->threads <= 0 ||
+      options->move_seconds <= 0) {
+    return false;
+  }
+  options->threads = tools::ClampWorkers(options->threads);
+  return true;
+}
+
+////
+// SelfPlay
+////
+class SelfPlay {
+ public:
+  SelfPlay(const Options& options, File* output)
+      : options_(options), output_(output), next_game_(0) {}
+  DISALLOW_COPY_AND_ASSIGN(SelfPlay);
+
+  // Play every game and return the records of each strategy.
+  void Run(Record records[2]);
+
+ private:
+  class WorkerTask;
+
+  void RunWorker(scoped_refptr<ComputerPlayer> players[2], Record records[2]);
+  void Flush(std::string* buffer);
+
+  const Options& options_;
+  File* output_;
+
+  std::atomic<int64_t> next_game_;
+  Mutex output_lock_;
+};
+
+class SelfPlay::WorkerTask : public Task {
+ public:
+  WorkerTask(SelfPlay* self_play,
+             scoped_refptr<ComputerPlayer>* players,
+             Record* records)
+      : self_play_(self_play), players_(players), records_(records) {}
+  ~WorkerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerTask);
+
+  // Task:
+  void Execute() override { self_play_->RunWorker(players_, records_); }
+
+ private:
+  SelfPlay* self_play_;
+  scoped_refptr<ComputerPlayer>* players_;
+  Record* records_;
+};
+
+void SelfPlay::Run(Record records[2]) {
+  // Players can't be shared between threads, so each worker gets its own
+  // pair.  They're created here because the searches seed themselves from
+  // the global generator.
+  const int num_players = options_.threads * 2;
+  std::unique_ptr<scoped_refptr<ComputerPlayer>[]> players(
+      new scoped_refptr<ComputerPlayer>[num_players]);
+  for (int i = 0; i < num_players; ++i) {
+    players[i] = new ComputerPlayer(options_.strategies[i % 2]->difficulty,
+                                    options_.seed + i);
+    players[i]->set_max_search_time(
+        TimeInterval::FromSeconds(options_.move_seconds));
+  }
+
+  // Each worker keeps its own records, which are added up at the end.
+  std::unique_ptr<Record[]> worker_records(new Record[num_players]);
+  std::unique_ptr<Thread[]> threads(new Thread[options_.threads]);
+  for (int i = 1; i < options_.threads; ++i) {
+    threads[i].Start(std::make_unique<WorkerTask>(this, &players[i * 2],
+                                                  &worker_records[i * 2]));
+  }
+  RunWorker(&players[0], &worker_records[0]);
+  for (int i = 1; i < options_.threads; ++i)
+    threads[i].Join();
+
+  for (int i = 0; i < options_.threads; ++i) {
+    records[0].Add(worker_records[i * 2]);
+    records[1].Add(worker_records[i * 2 + 1]);
+  }
+}
+
+// private:
+void SelfPlay::RunWorker(scoped_refptr<ComputerPlayer> players[2],
+                         Record records[2]) {
+  std::string buffer;
+  int buffered_games = 0;
+  while (true) {
+    const int64_t game = next_game_++;
+    if (game >= options_.games)
+      break;
+
+    // |first| is the index of the strategy playing X.
+    const int first = options_.swap ? game % 2 : 0;
+    TictactoeState state;
+    char moves[TictactoeState::kNumSpaces + 1];
+    int num_moves = 0;
+    while (!state.game_over()) {
+      const int player = state.turn() == kPlayerX ? first : 1 - first;
+      const int space = players[player]->ChooseMove(state, nullptr);
+      DCHECK(state.IsEmpty(space));
+      state.PlaceMark(space);
+      moves[num_moves++] = '0' + space;
+    }
+    moves[num_moves] = '\0';
+
+    const Player winner = state.winner();
+    if (winner == kPlayerNone) {
+      records[0].draws++;
+      records[1].draws++;
+    } else {
+      const int winning_strategy = winner == kPlayerX ? first : 1 - first;
+      records[winning_strategy].wins++;
+      records[1 - winning_strategy].losses++;
+    }
+
+    if (output_) {
+      buffer += options_.strategies[first]->name;
+      buffer += ' ';
+      buffer += options_.strategies[1 - first]->name;
+      buffer += ' ';
+      buffer += kWinnerName[winner];
+      buffer += ' ';
+      buffer += moves;
+      buffer += '\n';
+      if (++buffered_games == kFlushGames) {
+        Flush(&buffer);
+        buffered_games = 0;
+      }
+    }
+  }
+
+  if (output_)
+    Flush(&buffer);
+}
+
+void SelfPlay::Flush(std::string* buffer) {
+  AutoLock lock(&output_lock_);
+  output_->WriteString(*buffer);
+  buffer->clear();
+}
+
+void PrintRecord(const char* label, const Record& record) {
+  const double games = record.games();
+  printf("%-18s win %6.2f%%  draw %6.2f%%  loss %6.2f%%\n", label,
+         100 * record.wins / games, 100 * record.draws / games,
+         100 * record.losses / games);
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  std::unique_ptr<FilePosix> output;
+  if (!options.output.empty()) {
+    output = std::make_unique<FilePosix>();
+    if (!output->Open(options.output, FilePosix::kModeWrite)) {
+      fprintf(stderr, "Can't open %s\n", options.output.c_str());
+      return 1;
+    }
+  }
+
+  const Timestamp start = Timestamp::Now();
+  Record records[2];
+  SelfPlay self_play(options, output.get());
+  self_play.Run(records);
+  const TimeInterval elapsed = Timestamp::Now() - start;
+
+  if (output)
+    output->Close();
+
+  printf("%lld games on %d threads in %.2fs: %.0f games/sec\n",
+         static_cast<long long>(options.games), options.threads,
+         elapsed.Seconds(), options.games / elapsed.Seconds());
+  for (int i = 0; i < 2; ++i) {
+    std::string label = options.strategies[i]->name;
+    if (options.strategies[0] == options.strategies[1])
+      label += i ? " (second)" : " (first)";
+    PrintRecord(label.c_str(), records[i]);
+  }
+  return 0;
+}
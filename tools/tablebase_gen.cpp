@@ -0,0 +1,341 @@
+////
+// tablebase_gen.cpp
+////
+
+// Builds the tablebase for an m,n,k board, every position with up to a
+// given number of empty spaces, and writes it where Tablebase::Open() finds
+// it.  Positions are solved a group at a time from the full board back,
+// since each move fills a space and so only leads into the group before.
+// Each group is split across threads, which each fill whole bytes.
+
+#include "base/file/file_manager_posix.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread/task.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+#include "base/util/bits.h"
+#include "tictactoe/core/tablebase.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Tictactoe;
+
+namespace {
+// Workers claim positions this many at a time, a multiple of four so they
+// never share a byte.
+const uint64_t kChunkPositions = 1 << 16;
+
+// Tables bigger than this many positions, 16 GB, aren't attempted.
+const double kMaxPositions = 64e9;
+
+const char kUsage[] =
+    "Usage: tablebase_gen [options]\n"
+    "\n"
+    "Options:\n"
+    "  --width=N       Board width (default 4)\n"
+    "  --height=N      Board height (default: the width)\n"
+    "  --k=N           Marks in a row to win (default: the width)\n"
+    "  --max-empty=N   Solve positions with up to N empty spaces (default:\n"
+    "                  all of them)\n"
+    "  --threads=N     Number of threads (default: all cores)\n"
+    "  --output=F      File to write (default: mnk_W_H_K.tb)\n";
+
+const char* const kValueName[] = {"unknown", "loss", "draw", "win"};
+
+struct Options {
+  Options()
+      : width(4),
+        height(0),
+        k(0),
+        max_empty(-1),
+        threads(thread::GetProcessorCount()) {}
+
+  int width;
+  int height;
+  int k;
+  int max_empty;
+  int threads;
+  std::string output;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("width", &options->width);
+  parser.Add("height", &options->height);
+  parser.Add("k", &options->k);
+  parser.Add("max-empty", &options->max_empty);
+  parser.Add("threads", &options->threads);
+  parser.Add("output", &options->output);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (!options->height)
+    options->height = options->width;
+  if (!options->k)
+    options->k = options->width;
+  const int num_spaces = options->width * options->height;
+  if (options->max_empty < 0)
+    options->max_empty = num_spaces;
+  if (options->width < 1 || options->height < 1 ||
+      num_spaces > TablebaseIndex::kMaxSpaces || options->k < 1 ||
+      options->k > std::max(options->width, options->height) ||
+      options->max_empty > num_spaces || options->threads <= 0) {
+    return false;
+  }
+
+  if (options->output.empty()) {
+    options->output =
+        Tablebase::GetFilename(options->width, options->height, options->k);
+  }
+  options->threads = tools::ClampWorkers(options->threads);
+  return true;
+}
+
+// Return the masks of every line on the board.
+std::vector<uint64_t> ListLines(int width, int height, int k) {
+  static const int kDirections[4][2] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}};
+  std::vector<uint64_t> lines;
+  for (const auto& direction : kDirections) {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const int end_x = x + direction[0] * (k - 1);
+        const int end_y = y + direction[1] * (k - 1);
+        if (end_x < 0 || end_x >= width || end_y >= height)
+          continue;
+        uint64_t mask = 0;
+        for (int i = 0; i < k; ++i) {
+          const int space =
+              (y + direction[1] * i) * width + x + direction[0] * i;
+          mask |= uint64_t(1) << space;
+        }
+        lines.push_back(mask);
+      }
+    }
+  }
+  return lines;
+}
+
+class Generator {
+ public:
+  explicit Generator(const Options& options);
+  ~Generator() {}
+  DISALLOW_COPY_AND_ASSIGN(Generator);
+
+  const TablebaseIndex& index() const { return index_; }
+  const std::vector<uint8_t>& values() const { return values_; }
+
+  // Solve every group in turn.
+  void Run();
+
+  // Solve chunks of the current group until there are none left.
+  void RunWorker();
+
+ private:
+  bool HasLine(uint64_t mask) const;
+
+  // Return the value of the position for the player to move.  Positions it
+  // leads to must already be solved.
+  Tablebase::Value Solve(uint64_t x_mask, uint64_t o_mask, int empty) const;
+
+  Tablebase::Value Get(uint64_t index) const {
+    return static_cast<Tablebase::Value>(
+        (values_[index / 4] >> (index % 4 * 2)) & 3);
+  }
+
+  const Options& options_;
+  const TablebaseIndex index_;
+  const std::vector<uint64_t> lines_;
+  const uint64_t full_mask_;
+  std::vector<uint8_t> values_;
+
+  // The group being solved, and the next offset into it to claim.
+  int empty_;
+  std::atomic<uint64_t> next_offset_;
+  // Positions of each value in the group being solved.
+  std::atomic<uint64_t> counts_[4];
+};
+
+class WorkerTask : public Task {
+ public:
+  explicit WorkerTask(Generator* generator) : generator_(generator) {}
+  ~WorkerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(WorkerTask);
+
+  // Task:
+  void Execute() override { generator_->RunWorker(); }
+
+ private:
+  Generator* generator_;
+};
+
+Generator::Generator(const Options& options)
+    : options_(options),
+      index_(options.width * options.height, options.max_empty),
+      lines_(ListLines(options.width, options.height, options.k)),
+      full_mask_(~uint64_t(0) >> (64 - index_.num_spaces())),
+      values_(index_.size() / 4),
+      empty_(0),
+      next_offset_(0) {}
+
+void Generator::Run() {
+  std::unique_ptr<Thread[]> threads(new Thread[options_.threads]);
+  for (empty_ = 0; empty_ <= options_.max_empty; ++empty_) {
+    const Timestamp start = Timestamp::Now();
+    next_offset_ = 0;
+    for (auto& count : counts_)
+      count = 0;
+
+    for (int i = 1; i < options_.threads; ++i)
+      threads[i].Start(std::make_unique<WorkerTask>(this));
+    RunWorker();
+    for (int i = 1; i < options_.threads; ++i)
+      threads[i].Join();
+
+    printf("%2d empty: %12llu positions, %llu wins, %llu draws, %llu losses "
+           "in %.1fs\n",
+           empty_, static_cast<unsigned long long>(index_.group_size(empty_)),
+           static_cast<unsigned long long>(counts_[Tablebase::kValueWin]),
+           static_cast<unsigned long long>(counts_[Tablebase::kValueDraw]),
+           static_cast<unsigned long long>(counts_[Tablebase::kValueLoss]),
+           (Timestamp::Now() - start).Seconds());
+    fflush(stdout);
+  }
+}
+
+void Generator::RunWorker() {
+  const uint64_t size = index_.group_size(empty_);
+  const uint64_t start = index_.group_start(empty_);
+  uint64_t counts[4] = {};
+  while (true) {
+    const uint64_t begin = next_offset_.fetch_add(kChunkPositions);
+    if (begin >= size)
+      break;
+    const uint64_t end = std::min(begin + kChunkPositions, size);
+    for (uint64_t offset = begin; offset < end; offset += 4) {
+      uint8_t byte = 0;
+      for (uint64_t i = offset; i < std::min(offset + 4, end); ++i) {
+        uint64_t x_mask;
+        uint64_t o_mask;
+        index_.Unrank(empty_, i, &x_mask, &o_mask);
+        const Tablebase::Value value = Solve(x_mask, o_mask, empty_);
+        counts[value]++;
+        byte |= value << (i % 4 * 2);
+      }
+      values_[(start + offset) / 4] = byte;
+    }
+  }
+  for (int i = 0; i < 4; ++i)
+    counts_[i] += counts[i];
+}
+
+// private:
+bool Generator::HasLine(uint64_t mask) const {
+  for (uint64_t line : lines_) {
+    if ((mask & line) == line)
+      return true;
+  }
+  return false;
+}
+
+Tablebase::Value Generator::Solve(uint64_t x_mask,
+                                  uint64_t o_mask,
+                                  int empty) const {
+  const bool x_to_move =
+      bits::CountSetBits64(x_mask) == bits::CountSetBits64(o_mask);
+  const uint64_t mover_mask = x_to_move ? x_mask : o_mask;
+  const uint64_t opponent_mask = x_to_move ? o_mask : x_mask;
+
+  // The game would have ended before the mover's line was finished.
+  if (HasLine(mover_mask))
+    return Tablebase::kValueUnknown;
+  if (HasLine(opponent_mask))
+    return Tablebase::kValueLoss;
+  if (!empty)
+    return Tablebase::kValueDraw;
+
+  Tablebase::Value value = Tablebase::kValueLoss;
+  uint64_t moves = ~(x_mask | o_mask) & full_mask_;
+  while (moves) {
+    const uint64_t move = moves & -moves;
+    moves &= moves - 1;
+    const Tablebase::Value child =
+        Get(x_to_move ? index_.Rank(x_mask | move, o_mask)
+                      : index_.Rank(x_mask, o_mask | move));
+    if (child == Tablebase::kValueLoss)
+      return Tablebase::kValueWin;
+    if (child == Tablebase::kValueDraw)
+      value = Tablebase::kValueDraw;
+  }
+  return value;
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  // Count in floating point first, since the sizes of big tables overflow.
+  const int num_spaces = options.width * options.height;
+  double positions = 0;
+  for (int empty = 0; empty <= options.max_empty; ++empty) {
+    double size = 1;
+    for (int i = 0; i < empty; ++i)
+      size = size * (num_spaces - i) / (i + 1);
+    const int marks = num_spaces - empty;
+    for (int i = 0; i < marks / 2; ++i)
+      size = size * (marks - i) / (i + 1);
+    positions += size;
+  }
+  if (positions > kMaxPositions) {
+    fprintf(stderr, "%.3g positions is too many; lower --max-empty\n",
+            positions);
+    return 1;
+  }
+
+  // The table is written relative to the working directory.
+  FileManagerPosix file_manager("", "");
+  const Timestamp start = Timestamp::Now();
+  Generator generator(options);
+  printf("%dx%d k=%d, up to %d empty: %llu positions, %llu bytes\n",
+         options.width, options.height, options.k, options.max_empty,
+         static_cast<unsigned long long>(generator.index().size()),
+         static_cast<unsigned long long>(generator.values().size()));
+  generator.Run();
+  printf("Solved in %.1fs\n", (Timestamp::Now() - start).Seconds());
+
+  if (!Tablebase::Write(options.output, options.width, options.height,
+                        options.k, options.max_empty, generator.values())) {
+    return 1;
+  }
+
+  // Read it back the way the app does.
+  std::unique_ptr<Tablebase> tablebase = Tablebase::Open(options.output);
+  if (!tablebase) {
+    fprintf(stderr, "Can't open %s\n", options.output.c_str());
+    return 1;
+  }
+  if (options.max_empty == num_spaces) {
+    Tablebase::Value value;
+    const uint64_t moves = tablebase->FindBestMoves(0, 0, &value);
+    printf("Empty board: %s for X, best first moves", kValueName[value]);
+    for (uint64_t rest = moves; rest; rest &= rest - 1)
+      printf(" %d", bits::FindFirstSet64(rest));
+    printf("\n");
+  }
+  printf("Wrote %s\n", options.output.c_str());
+  return 0;
+}
@@ -0,0 +1,231 @@
+////
+// task_queue_benchmark.cpp
+////
+
+// Measures the lock-free TaskQueue against a queue guarded by a Mutex, the
+// way WorkerThread queues its tasks.  1, 2, 4 and 8 producer threads push
+// tasks as fast as they can while the main thread pops and runs them, and
+// the throughput and time per task of each queue is reported.
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread/mutex.h"
+#include "base/thread/task.h"
+#include "base/thread/task_queue.h"
+#include "base/thread/thread.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+
+#include "tool_options.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace {
+const int kDefaultTasks = 200000;
+const int kDefaultMaxProducers = 8;
+const int kDefaultCapacity = 1024;
+
+const char kUsage[] =
+    "Usage: task_queue_benchmark [options]\n"
+    "\n"
+    "Options:\n"
+    "  --tasks=N          Tasks each producer posts (default 200000)\n"
+    "  --max-producers=N  Double the producers from 1 up to N (default 8)\n"
+    "  --capacity=N       Tasks either queue holds (default 1024)\n";
+
+struct Options {
+  Options()
+      : tasks(kDefaultTasks),
+        max_producers(kDefaultMaxProducers),
+        capacity(kDefaultCapacity) {}
+
+  int tasks;
+  int max_producers;
+  int capacity;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("tasks", &options->tasks);
+  parser.Add("max-producers", &options->max_producers);
+  parser.Add("capacity", &options->capacity);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (options->tasks <= 0 || options->max_producers <= 0 ||
+      options->capacity <= 0) {
+    return false;
+  }
+  options->max_producers = tools::ClampWorkers(options->max_producers);
+  return true;
+}
+
+// The same bounded queue as TaskQueue, with every push and pop taking a
+// lock.
+class MutexTaskQueue {
+ public:
+  explicit MutexTaskQueue(int capacity) : capacity_(capacity) {}
+  DISALLOW_COPY_AND_ASSIGN(MutexTaskQueue);
+
+  bool Push(std::unique_ptr<Task>* task) {
+    AutoLock lock(&lock_);
+    if (static_cast<int>(tasks_.size()) >= capacity_)
+      return false;
+    tasks_.push_back(std::move(*task));
+    return true;
+  }
+
+  std::unique_ptr<Task> Pop() {
+    AutoLock lock(&lock_);
+    if (tasks_.empty())
+      return nullptr;
+    std::unique_ptr<Task> task = std::move(tasks_.front());
+    tasks_.pop_front();
+    return task;
+  }
+
+ private:
+  const int capacity_;
+  Mutex lock_;
+  std::deque<std::unique_ptr<Task>> tasks_;
+};
+
+class CountTask : public Task {
+ public:
+  explicit CountTask(int* count) : count_(count) {}
+  ~CountTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(CountTask);
+
+  // Task:
+  void Execute() override { ++*count_; }
+
+ private:
+  int* count_;
+};
+
+// Pushes its tasks onto the queue once told to go, yielding whenever the
+// queue is full.
+template <typename Queue>
+class ProducerTask : public Task {
+ public:
+  ProducerTask(Queue* queue,
+               std::vector<std::unique_ptr<Task>> tasks,
+               const std::atomic<bool>* go)
+      : queue_(queue), tasks_(std::move(tasks)), go_(go), full_(0) {}
+  ~ProducerTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(ProducerTask);
+
+  // Times the queue was found full.
+  int64_t full() const { return full_; }
+
+  // Task:
+  void Execute() override {
+    while (!go_->load(std::memory_order_acquire)) {
+    }
+    for (auto& task : tasks_) {
+      while (!queue_->Push(&task)) {
+        full_++;
+        sched_yield();
+      }
+    }
+  }
+
+ private:
+  Queue* queue_;
+  std::vector<std::unique_ptr<Task>> tasks_;
+  const std::atomic<bool>* go_;
+  int64_t full_;
+};
+
+struct Timing {
+  Timing() : seconds(0), full(0) {}
+
+  double seconds;
+  int64_t full;
+};
+
+// Time |num_producers| threads pushing |options.tasks| tasks each through
+// |queue| to this thread.
+template <typename Queue>
+Timing RunProducers(const Options& options, Queue* queue, int num_producers) {
+  int count = 0;
+  std::atomic<bool> go(false);
+  std::vector<std::unique_ptr<Thread>> threads;
+  std::vector<ProducerTask<Queue>*> producers;
+  for (int i = 0; i < num_producers; ++i) {
+    // Create the tasks up front, so only the queue is timed.
+    std::vector<std::unique_ptr<Task>> tasks;
+    for (int j = 0; j < options.tasks; ++j)
+      tasks.push_back(std::make_unique<CountTask>(&count));
+    auto producer =
+        std::make_unique<ProducerTask<Queue>>(queue, std::move(tasks), &go);
+    producers.push_back(producer.get());
+    threads.push_back(std::make_unique<Thread>());
+    threads.back()->Start(std::move(producer));
+  }
+
+  const int total = num_producers * options.tasks;
+  const Timestamp start = Timestamp::Now();
+  go.store(true, std::memory_order_release);
+  while (count < total) {
+    std::unique_ptr<Task> task = queue->Pop();
+    if (task)
+      task->Execute();
+    else
+      sched_yield();
+  }
+  Timing timing;
+  timing.seconds = (Timestamp::Now() - start).Seconds();
+
+  for (int i = 0; i < num_producers; ++i)
+    timing.full += producers[i]->full();
+  for (auto& thread : threads)
+    thread->Join();
+  return timing;
+}
+
+void PrintTiming(const char* name,
+                 int num_producers,
+                 const Options& options,
+                 const Timing& timing) {
+  const double tasks = static_cast<double>(num_producers) * options.tasks;
+  printf("%9d %-9s %12.2f %10.1f %10lld\n", num_producers, name,
+         tasks / timing.seconds / 1000000, timing.seconds * 1e9 / tasks,
+         static_cast<long long>(timing.full));
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  printf("%d tasks per producer, capacity %d, %d cores\n", options.tasks,
+         options.capacity, thread::GetProcessorCount());
+  printf("%9s %-9s %12s %10s %10s\n", "producers", "queue", "Mtasks/sec",
+         "ns/task", "full");
+
+  for (int producers = 1; producers <= options.max_producers;
+       producers *= 2) {
+    {
+      TaskQueue queue(options.capacity);
+      PrintTiming("lock-free", producers, options,
+                  RunProducers(options, &queue, producers));
+    }
+    {
+      MutexTaskQueue queue(options.capacity);
+      PrintTiming("mutex", producers, options,
+                  RunProducers(options, &queue, producers));
+    }
+  }
+  return 0;
+}
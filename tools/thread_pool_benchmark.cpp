@@ -0,0 +1,305 @@
+////
+// thread_pool_benchmark.cpp
+////
+
+// Stress tests ThreadPool and its work-stealing deques, and times them with
+// 1, 2, 4 and 8 workers.  Tasks posted from this thread fan out into a tree
+// of tasks posted from the workers, wide enough at the top to fill a
+// worker's deque and spill into the shared queue, so pops, steals and the
+// overflow all compete; every task has to run exactly once.  Then a
+// ParallelFor sum, and one nested inside another, have to visit every index
+// once and match the sum on one thread.
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread/task.h"
+#include "base/thread/thread_pool.h"
+#include "base/thread/thread_util.h"
+#include "base/time.h"
+
+#include "tool_options.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+const int kDefaultTasks = 1000000;
+const int kDefaultIndexes = 1 << 22;
+const int kDefaultMaxWorkers = 8;
+
+// Tasks posted from this thread, each the root of a tree.
+const int kRootTasks = 16;
+// Children a root task posts, more than a worker's deque holds.
+const int kRootFanout = 2048;
+// Children every other task posts.
+const int kFanout = 2;
+
+const int kGrainSize = 1024;
+const int kNestedOuterIndexes = 64;
+const int kNestedInnerIndexes = 4096;
+const int kNestedGrainSize = 16;
+
+const char kUsage[] =
+    "Usage: thread_pool_benchmark [options]\n"
+    "\n"
+    "Options:\n"
+    "  --tasks=N         Tasks in the spawning tree (default 1000000)\n"
+    "  --indexes=N       Indexes the ParallelFor sums (default 4194304)\n"
+    "  --max-workers=N   Double the workers from 1 up to N (default 8)\n";
+
+struct Options {
+  Options()
+      : tasks(kDefaultTasks),
+        indexes(kDefaultIndexes),
+        max_workers(kDefaultMaxWorkers) {}
+
+  int tasks;
+  int indexes;
+  int max_workers;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  tools::OptionParser parser;
+  parser.Add("tasks", &options->tasks);
+  parser.Add("indexes", &options->indexes);
+  parser.Add("max-workers", &options->max_workers);
+  if (!parser.Parse(argc, argv, nullptr))
+    return false;
+
+  if (options->tasks <= 0 || options->indexes <= 0 ||
+      options->max_workers <= 0) {
+    return false;
+  }
+  options->max_workers = tools::ClampWorkers(options->max_workers);
+  return true;
+}
+
+// Counts, for each id, how many times it came up.  Any thread may count.
+class RunCounts {
+ public:
+  explicit RunCounts(int size)
+      : size_(size), counts_(new std::atomic<int>[size]) {
+    Clear();
+  }
+  DISALLOW_COPY_AND_ASSIGN(RunCounts);
+
+  void Add(int id) { counts_[id].fetch_add(1, std::memory_order_relaxed); }
+
+  void Clear() {
+    for (int i = 0; i < size_; ++i)
+      counts_[i].store(0, std::memory_order_relaxed);
+  }
+
+  // How many ids didn't come up |expected| times.
+  int CountWrong(int expected) const {
+    int wrong = 0;
+    for (int i = 0; i < size_; ++i) {
+      if (counts_[i].load(std::memory_order_relaxed) != expected)
+        wrong++;
+    }
+    return wrong;
+  }
+
+ private:
+  const int size_;
+  std::unique_ptr<std::atomic<int>[]> counts_;
+};
+
+// Runs task |begin|, and posts children that split up the ids in
+// (begin, end) between them.
+class SpawnTask : public Task {
+ public:
+  SpawnTask(ThreadPool* pool, RunCounts* runs, int begin, int end, int fanout)
+      : pool_(pool), runs_(runs), begin_(begin), end_(end), fanout_(fanout) {}
+  ~SpawnTask() override {}
+  DISALLOW_COPY_AND_ASSIGN(SpawnTask);
+
+  // Task:
+  void Execute() override {
+    runs_->Add(begin_);
+    const int first = begin_ + 1;
+    const int size = end_ - first;
+    const int children = std::min(fanout_, size);
+    for (int i = 0; i < children; ++i) {
+      pool_->PostTask(std::make_unique<SpawnTask>(
+          pool_, runs_, first + size * i / children,
+          first + size * (i + 1) / children, kFanout));
+    }
+  }
+
+ private:
+  ThreadPool* pool_;
+  RunCounts* runs_;
+  const int begin_;
+  const int end_;
+  const int fanout_;
+};
+
+// Post trees covering the ids in [0, num_tasks) and wait for them to finish.
+// Return how long it took, or a negative time if a task didn't run exactly
+// once.
+double RunSpawnTrees(ThreadPool* pool, int num_tasks) {
+  RunCounts runs(num_tasks);
+  const Timestamp start = Timestamp::Now();
+  pool->Start();
+  const int roots = std::min(kRootTasks, num_tasks);
+  for (int i = 0; i < roots; ++i) {
+    pool->PostTask(std::make_unique<SpawnTask>(
+        pool, &runs, num_tasks * static_cast<int64_t>(i) / roots,
+        num_tasks * static_cast<int64_t>(i + 1) / roots, kRootFanout));
+  }
+  pool->Stop();
+  const double seconds = (Timestamp::Now() - start).Seconds();
+
+  const int wrong = runs.CountWrong(1);
+  if (wrong) {
+    fprintf(stderr, "%d workers: %d of %d tasks didn't run exactly once\n",
+            pool->num_workers(), wrong, num_tasks);
+    return -1;
+  }
+  return seconds;
+}
+
+// Mixes the bits of |value|, as a stand-in for work on each index.
+uint64_t Mix(uint64_t value) {
+  value += 0x9e3779b97f4a7c15ull;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// Sums Mix() over its ranges, and counts the times each index comes up.
+class SumBody : public ThreadPool::Body {
+ public:
+  explicit SumBody(int size) : visits_(size), sum_(0) {}
+  ~SumBody() override {}
+  DISALLOW_COPY_AND_ASSIGN(SumBody);
+
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  const RunCounts& visits() const { return visits_; }
+
+  void Clear() {
+    visits_.Clear();
+    sum_.store(0, std::memory_order_relaxed);
+  }
+
+  // ThreadPool::Body:
+  void Run(int begin, int end) override {
+    uint64_t sum = 0;
+    for (int i = begin; i < end; ++i) {
+      sum += Mix(i);
+      visits_.Add(i);
+    }
+    sum_.fetch_add(sum, std::memory_order_relaxed);
+  }
+
+ private:
+  RunCounts visits_;
+  std::atomic<uint64_t> sum_;
+};
+
+// Runs an inner ParallelFor for each of its indexes, from whichever thread
+// it's on.
+class NestedBody : public ThreadPool::Body {
+ public:
+  NestedBody(ThreadPool* pool, SumBody* inner) : pool_(pool), inner_(inner) {}
+  ~NestedBody() override {}
+  DISALLOW_COPY_AND_ASSIGN(NestedBody);
+
+  // ThreadPool::Body:
+  void Run(int begin, int end) override {
+    for (int i = begin; i < end; ++i)
+      pool_->ParallelFor(0, kNestedInnerIndexes, kNestedGrainSize, inner_);
+  }
+
+ private:
+  ThreadPool* pool_;
+  SumBody* inner_;
+};
+
+bool CheckSum(const char* label,
+              int num_workers,
+              const SumBody& body,
+              int expected_visits,
+              uint64_t expected_sum) {
+  const int wrong = body.visits().CountWrong(expected_visits);
+  if (!wrong && body.sum() == expected_sum)
+    return true;
+  fprintf(stderr,
+          "%d workers: %s: %d indexes weren't visited %d times, sum %llu, "
+          "expected %llu\n",
+          num_workers, label, wrong, expected_visits,
+          static_cast<unsigned long long>(body.sum()),
+          static_cast<unsigned long long>(expected_sum));
+  return false;
+}
+
+// Sum over [0, num_indexes) with ParallelFor.  Return how long it took, or a
+// negative time if the sum was wrong.
+double RunParallelSum(ThreadPool* pool,
+                      int num_indexes,
+                      uint64_t expected_sum,
+                      SumBody* body) {
+  body->Clear();
+  pool->Start();
+  const Timestamp start = Timestamp::Now();
+  pool->ParallelFor(0, num_indexes, kGrainSize, body);
+  const double seconds = (Timestamp::Now() - start).Seconds();
+  if (!CheckSum("ParallelFor", pool->num_workers(), *body, 1, expected_sum))
+    return -1;
+
+  // Every inner index is visited once for each outer index.
+  SumBody inner(kNestedInnerIndexes);
+  inner.Run(0, kNestedInnerIndexes);
+  const uint64_t inner_sum = inner.sum() * kNestedOuterIndexes;
+  inner.Clear();
+  NestedBody nested(pool, &inner);
+  pool->ParallelFor(0, kNestedOuterIndexes, 1, &nested);
+  pool->Stop();
+  if (!CheckSum("nested ParallelFor", pool->num_workers(), inner,
+                kNestedOuterIndexes, inner_sum)) {
+    return -1;
+  }
+  return seconds;
+}
+}
+
+int main(int argc, char** argv) {
+  thread::InitThread(thread::Ui);
+
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    fputs(kUsage, stderr);
+    return 1;
+  }
+
+  SumBody body(options.indexes);
+  Timestamp start = Timestamp::Now();
+  body.Run(0, options.indexes);
+  const double serial_seconds = (Timestamp::Now() - start).Seconds();
+  const uint64_t expected_sum = body.sum();
+
+  printf("%d tasks, %d indexes, %d cores\n", options.tasks, options.indexes,
+         thread::GetProcessorCount());
+  printf("1 thread without the pool: sum in %.2f ms\n", serial_seconds * 1e3);
+  printf("%7s %12s %10s %12s %8s\n", "workers", "Mtasks/sec", "ns/task",
+         "sum ms", "speedup");
+
+  for (int workers = 1; workers <= options.max_workers; workers *= 2) {
+    ThreadPool pool(workers);
+    const double spawn_seconds = RunSpawnTrees(&pool, options.tasks);
+    if (spawn_seconds < 0)
+      return 1;
+    const double sum_seconds =
+        RunParallelSum(&pool, options.indexes, expected_sum, &body);
+    if (sum_seconds < 0)
+      return 1;
+    printf("%7d %12.2f %10.1f %12.2f %7.2fx\n", workers,
+           options.tasks / spawn_seconds / 1e6,
+           spawn_seconds * 1e9 / options.tasks, sum_seconds * 1e3,
+           serial_seconds / sum_seconds);
+  }
+  return 0;
+}
@@ -0,0 +1,148 @@
+////
+// tool_options.h
+////
+
+// Command line parsing shared by the tools.  Header only, so building a tool
+// is still one g++ line.
+
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/macros.h"
+#include "base/math/math.h"
+#include "base/thread/thread_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+// Threads besides the main thread can't take the named thread ids, so this
+// is the most threads a tool can start.
+const int kMaxWorkers = thread::kMaxThreads - thread::kNumNamedThreads;
+
+// Clamp a requested number of threads to what a tool can start.
+inline int ClampWorkers(int workers) {
+  return math::Clamp<int>(workers, 1, kMaxWorkers);
+}
+
+// Return the value of |arg| if it's --|name|=value, or null.
+inline const char* OptionValue(const char* arg, const char* name) {
+  if (strncmp(arg, "--", 2))
+    return nullptr;
+  const size_t length = strlen(name);
+  if (strncmp(arg + 2, name, length) || arg[length + 2] != '=')
+    return nullptr;
+  return arg + length + 3;
+}
+
+// Parses --name=value options into the variables they were added with, and
+// --name flags into bools.  Values are only checked for the type's syntax,
+// so the tool checks the ranges after Parse().
+class OptionParser {
+ public:
+  OptionParser() {}
+  DISALLOW_COPY_AND_ASSIGN(OptionParser);
+
+  void Add(const char* name, int* value) { AddOption(name, kInt, value); }
+  void Add(const char* name, int64_t* value) { AddOption(name, kInt64, value); }
+  void Add(const char* name, uint32_t* value) {
+    AddOption(name, kUint32, value);
+  }
+  void Add(const char* name, double* value) { AddOption(name, kDouble, value); }
+  void Add(const char* name, std::string* value) {
+    AddOption(name, kString, value);
+  }
+
+  // --|name| on its own sets |value| to |set_to|.
+  void AddFlag(const char* name, bool* value, bool set_to) {
+    AddOption(name, set_to ? kFlagTrue : kFlagFalse, value);
+  }
+
+  // Parse the arguments after the program name.  Arguments that don't start
+  // with "-" are added to |args|, or rejected if it's null.  Prints the first
+  // argument it can't parse and returns false.
+  bool Parse(int argc, char** argv, std::vector<const char*>* args) {
+    for (int i = 1; i < argc; ++i) {
+      const char* arg = argv[i];
+      if (arg[0] != '-' && args) {
+        args->push_back(arg);
+      } else if (!ParseOption(arg)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  enum Type {
+    kInt,
+    kInt64,
+    kUint32,
+    kDouble,
+    kString,
+    kFlagTrue,
+    kFlagFalse,
+  };
+
+  struct Option {
+    const char* name;
+    Type type;
+    void* value;
+  };
+
+  void AddOption(const char* name, Type type, void* value) {
+    options_.push_back(Option{name, type, value});
+  }
+
+  bool ParseOption(const char* arg) {
+    for (const Option& option : options_) {
+      if (option.type == kFlagTrue || option.type == kFlagFalse) {
+        if (strncmp(arg, "--", 2) || strcmp(arg + 2, option.name))
+          continue;
+        *static_cast<bool*>(option.value) = option.type == kFlagTrue;
+        return true;
+      }
+
+      const char* value = OptionValue(arg, option.name);
+      if (!value)
+        continue;
+      char* end = nullptr;
+      switch (option.type) {
+        case kInt:
+          *static_cast<int*>(option.value) = strtol(value, &end, 10);
+          break;
+        case kInt64:
+          *static_cast<int64_t*>(option.value) = strtoll(value, &end, 10);
+          break;
+        case kUint32:
+          *static_cast<uint32_t*>(option.value) = strtoul(value, &end, 10);
+          break;
+        case kDouble:
+          *static_cast<double*>(option.value) = strtod(value, &end);
+          break;
+        case kString:
+          *static_cast<std::string*>(option.value) = value;
+          return true;
+        case kFlagTrue:
+        case kFlagFalse:
+          break;
+      }
+      // Reject trailing junk, such as --threads=4x.
+      if (end == value || *end) {
+        fprintf(stderr, "Bad value: %s\n", arg);
+        return false;
+      }
+      return true;
+    }
+    fprintf(stderr, "Unknown argument: %s\n", arg);
+    return false;
+  }
+
+  std::vector<Option> options_;
+};
+
+}  // namespace tools